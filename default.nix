@@ -11,7 +11,6 @@ with import <nixpkgs> {}; {
                         valgrind
                         racket
                         inotifyTools
-                        python3
                       ];
         LD_LIBRARY_PATH="${mesa}/lib";
     };
@@ -0,0 +1,34 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ebisp/gc.h"
+#include "ebisp/parser.h"
+#include "system/error.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    /* The parser works on NUL-terminated strings */
+    char *source = malloc(size + 1);
+    if (source == NULL) {
+        abort();
+    }
+    memcpy(source, data, size);
+    source[size] = '\0';
+
+    Gc *gc = create_gc();
+    if (gc == NULL) {
+        abort();
+    }
+
+    read_all_exprs_from_string(gc, source);
+    gc_collect(gc);
+
+    destroy_gc(gc);
+    free(source);
+    reset_error();
+
+    return 0;
+}
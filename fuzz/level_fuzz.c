@@ -0,0 +1,48 @@
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "game/level.h"
+#include "system/error.h"
+
+/* The loaders only read files, so every input goes through the same
+ * temporary file. Text levels, compiled levels and garbage all take
+ * their own path through create_level_from_file depending on the
+ * first bytes of the input. */
+
+static char fuzz_file_name[] = "/tmp/nothing-level-fuzz-XXXXXX";
+static int fuzz_fd = -1;
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (fuzz_fd < 0) {
+        fuzz_fd = mkstemp(fuzz_file_name);
+        if (fuzz_fd < 0) {
+            perror("mkstemp");
+            abort();
+        }
+    }
+
+    if (ftruncate(fuzz_fd, 0) < 0
+        || pwrite(fuzz_fd, data, size, 0) != (ssize_t) size) {
+        perror("Could not write the input");
+        abort();
+    }
+
+    /* Without the script cache every input is parsed from scratch,
+     * so the runs do not depend on the dumps of the previous ones */
+    Level *level = create_level_from_file(fuzz_file_name, NULL);
+    if (level != NULL) {
+        /* Some of the loaded data is only looked at by the update */
+        level_update(level, 0.016f);
+        destroy_level(level);
+    }
+    reset_error();
+
+    return 0;
+}
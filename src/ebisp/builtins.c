@@ -1,10 +1,17 @@
 #include <assert.h>
+#include <limits.h>
 #include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "builtins.h"
+#include "gc.h"
+#include "interpreter.h"
+#include "system/error.h"
+
+#define EQUAL_STACK_INLINE_CAPACITY 64
 
 static bool equal_atoms(struct Atom *atom1, struct Atom *atom2)
 {
@@ -17,30 +24,23 @@ static bool equal_atoms(struct Atom *atom1, struct Atom *atom2)
 
     switch (atom1->type) {
     case ATOM_SYMBOL:
-        return strcmp(atom1->sym, atom2->sym) == 0;
-
-    case ATOM_NUMBER:
-        return atom1->num == atom2->num;
-
     case ATOM_STRING:
-        return strcmp(atom1->str, atom2->str) == 0;
+        return atom1->len == atom2->len
+            && memcmp(atom1->sym, atom2->sym, atom1->len) == 0;
 
     case ATOM_NATIVE:
         return atom1->native.fun == atom2->native.fun
             && atom1->native.param == atom2->native.param;
+
+    case ATOM_CLOSURE:
+        return atom1 == atom2;
     }
 
     return false;
 }
 
-static bool equal_cons(struct Cons *cons1, struct Cons *cons2)
-{
-    assert(cons1);
-    assert(cons2);
-    return equal(cons1->car, cons2->car) && equal(cons1->cdr, cons2->cdr);
-}
-
-bool equal(struct Expr obj1, struct Expr obj2)
+/* Compares everything but the conses */
+static bool equal_leaves(struct Expr obj1, struct Expr obj2)
 {
     if (obj1.type != obj2.type) {
         return false;
@@ -50,9 +50,13 @@ bool equal(struct Expr obj1, struct Expr obj2)
     case EXPR_ATOM:
         return equal_atoms(obj1.atom, obj2.atom);
 
-    case EXPR_CONS:
-        return equal_cons(obj1.cons, obj2.cons);
+    case EXPR_INTEGER:
+        return obj1.integer == obj2.integer;
 
+    case EXPR_REAL:
+        return obj1.real == obj2.real;
+
+    case EXPR_CONS:
     case EXPR_VOID:
         return true;
     }
@@ -60,10 +64,87 @@ bool equal(struct Expr obj1, struct Expr obj2)
     return true;
 }
 
+/* The pairs of cdrs that are still to be compared. Shallow
+ * expressions fit into the inline pairs and never touch the heap. */
+struct EqualStack
+{
+    struct Expr (*pairs)[2];
+    size_t size;
+    size_t capacity;
+    struct Expr inline_pairs[EQUAL_STACK_INLINE_CAPACITY][2];
+};
+
+static int equal_stack_push(struct EqualStack *stack, struct Expr obj1, struct Expr obj2)
+{
+    if (stack->size >= stack->capacity) {
+        const size_t new_capacity = stack->capacity * 2;
+        struct Expr (*new_pairs)[2] = NULL;
+
+        if (stack->pairs == stack->inline_pairs) {
+            new_pairs = malloc(sizeof(*new_pairs) * new_capacity);
+            if (new_pairs != NULL) {
+                memcpy(new_pairs, stack->inline_pairs, sizeof(stack->inline_pairs));
+            }
+        } else {
+            new_pairs = realloc(stack->pairs, sizeof(*new_pairs) * new_capacity);
+        }
+
+        if (new_pairs == NULL) {
+            throw_error(ERROR_TYPE_LIBC);
+            return -1;
+        }
+
+        stack->pairs = new_pairs;
+        stack->capacity = new_capacity;
+    }
+
+    stack->pairs[stack->size][0] = obj1;
+    stack->pairs[stack->size][1] = obj2;
+    stack->size++;
+
+    return 0;
+}
+
+bool equal(struct Expr obj1, struct Expr obj2)
+{
+    struct EqualStack stack;
+    stack.pairs = stack.inline_pairs;
+    stack.size = 0;
+    stack.capacity = EQUAL_STACK_INLINE_CAPACITY;
+
+    bool result = true;
+
+    /* The cars are compared right away while the cdrs wait on the
+     * stack, so only the nesting of the cars makes the stack grow and
+     * long lists are compared with a single pending pair */
+    for (;;) {
+        while (result && obj1.type == EXPR_CONS && obj2.type == EXPR_CONS) {
+            result = equal_stack_push(&stack, obj1.cons->cdr, obj2.cons->cdr) == 0;
+            obj1 = obj1.cons->car;
+            obj2 = obj2.cons->car;
+        }
+
+        result = result && equal_leaves(obj1, obj2);
+        if (!result || stack.size == 0) {
+            break;
+        }
+
+        stack.size--;
+        obj1 = stack.pairs[stack.size][0];
+        obj2 = stack.pairs[stack.size][1];
+    }
+
+    if (stack.pairs != stack.inline_pairs) {
+        free(stack.pairs);
+    }
+
+    return result;
+}
+
 bool nil_p(struct Expr obj)
 {
     return symbol_p(obj)
-        && strcmp(obj.atom->sym, "nil") == 0;
+        && atom_text_equal(obj.atom, "nil");
 }
 
 bool symbol_p(struct Expr obj)
@@ -72,6 +153,27 @@ bool symbol_p(struct Expr obj)
         && obj.atom->type == ATOM_SYMBOL;
 }
 
+bool integer_p(struct Expr obj)
+{
+    return obj.type == EXPR_INTEGER;
+}
+
+bool real_p(struct Expr obj)
+{
+    return obj.type == EXPR_REAL;
+}
+
+bool number_p(struct Expr obj)
+{
+    return integer_p(obj) || real_p(obj);
+}
+
+double number_as_real(struct Expr obj)
+{
+    assert(number_p(obj));
+    return obj.type == EXPR_INTEGER ? (double) obj.integer : obj.real;
+}
+
 bool cons_p(struct Expr obj)
 {
     return obj.type == EXPR_CONS;
@@ -79,28 +181,20 @@ bool cons_p(struct Expr obj)
 
 bool list_p(struct Expr obj)
 {
-    if (nil_p(obj)) {
-        return true;
-    }
-
-    if (obj.type == EXPR_CONS) {
-        return list_p(obj.cons->cdr);
+    while (obj.type == EXPR_CONS) {
+        obj = obj.cons->cdr;
     }
 
-    return false;
+    return nil_p(obj);
 }
 
 bool list_of_symbols_p(struct Expr obj)
 {
-    if (nil_p(obj)) {
-        return true;
-    }
-
-    if (obj.type == EXPR_CONS && symbol_p(obj.cons->car)) {
-        return list_of_symbols_p(obj.cons->cdr);
+    while (obj.type == EXPR_CONS && symbol_p(obj.cons->car)) {
+        obj = obj.cons->cdr;
     }
 
-    return false;
+    return nil_p(obj);
 }
 
 bool lambda_p(struct Expr obj)
@@ -117,7 +211,7 @@ bool lambda_p(struct Expr obj)
         return false;
     }
 
-    if (strcmp("lambda", obj.cons->car.atom->sym) != 0) {
+    if (!atom_text_equal(obj.cons->car.atom, "lambda")) {
         return false;
     }
 
@@ -171,3 +265,338 @@ struct Expr list(Gc *gc, size_t n, ...)
     va_end(args);
     return obj;
 }
+
+static struct EvalResult wrong_type_argument(Gc *gc, const char *predicate, struct Expr obj)
+{
+    return eval_failure(list(gc, 3,
+                             SYMBOL(gc, "wrong-type-argument"),
+                             SYMBOL(gc, predicate),
+                             obj));
+}
+
+/* Portable replacement for the __builtin_*_overflow family: checks
+ * the operands against LONG_MAX/LONG_MIN before doing the operation */
+static bool integer_op_overflows(enum BuiltinId op, long int a, long int b)
+{
+    switch (op) {
+    case BUILTIN_PLUS:
+        return (b > 0 && a > LONG_MAX - b) || (b < 0 && a < LONG_MIN - b);
+
+    case BUILTIN_MINUS:
+        return (b < 0 && a > LONG_MAX + b) || (b > 0 && a < LONG_MIN + b);
+
+    case BUILTIN_MUL:
+        if (a > 0) {
+            return b > 0 ? a > LONG_MAX / b : b < LONG_MIN / a;
+        }
+        if (b > 0) {
+            return a < LONG_MIN / b;
+        }
+        return a != 0 && b < LONG_MAX / a;
+
+    case BUILTIN_DIV:
+        return a == LONG_MIN && b == -1;
+
+    default:
+        assert(0 && "Not an arithmetic builtin");
+        return false;
+    }
+}
+
+static long int integer_op(enum BuiltinId op, long int a, long int b)
+{
+    switch (op) {
+    case BUILTIN_PLUS: return a + b;
+    case BUILTIN_MINUS: return a - b;
+    case BUILTIN_MUL: return a * b;
+    case BUILTIN_DIV: return a / b;
+    default:
+        assert(0 && "Not an arithmetic builtin");
+        return 0;
+    }
+}
+
+static struct EvalResult fold_numbers(Gc *gc,
+                                      enum BuiltinId op,
+                                      struct Expr acc,
+                                      struct Expr args)
+{
+    if (!number_p(acc)) {
+        return wrong_type_argument(gc, "numberp", acc);
+    }
+
+    while (cons_p(args)) {
+        struct Expr x = args.cons->car;
+
+        if (!number_p(x)) {
+            return wrong_type_argument(gc, "numberp", x);
+        }
+
+        if (integer_p(acc) && integer_p(x)) {
+            if (op == BUILTIN_DIV && x.integer == 0) {
+                return eval_failure(CONS(gc, SYMBOL(gc, "arith-error"), args));
+            }
+
+            if (!integer_op_overflows(op, acc.integer, x.integer)) {
+                acc.integer = integer_op(op, acc.integer, x.integer);
+                args = args.cons->cdr;
+                continue;
+            }
+        }
+
+        /* Reals, and the integers that overflowed carry on as reals */
+        const double a = number_as_real(acc);
+        const double b = number_as_real(x);
+
+        switch (op) {
+        case BUILTIN_PLUS: acc = REAL(gc, a + b); break;
+        case BUILTIN_MINUS: acc = REAL(gc, a - b); break;
+        case BUILTIN_MUL: acc = REAL(gc, a * b); break;
+        case BUILTIN_DIV: acc = REAL(gc, a / b); break;
+        default: assert(0 && "Not an arithmetic builtin");
+        }
+
+        args = args.cons->cdr;
+    }
+
+    return eval_success(acc);
+}
+
+static int compare_numbers(struct Expr a, struct Expr b)
+{
+    if (integer_p(a) && integer_p(b)) {
+        return (a.integer > b.integer) - (a.integer < b.integer);
+    }
+
+    const double x = number_as_real(a);
+    const double y = number_as_real(b);
+    return (x > y) - (x < y);
+}
+
+static struct EvalResult compare_op(Gc *gc, enum BuiltinId op, struct Expr args)
+{
+    bool holds = true;
+
+    while (cons_p(args)) {
+        struct Expr x = args.cons->car;
+        if (!number_p(x)) {
+            return wrong_type_argument(gc, "numberp", x);
+        }
+
+        if (cons_p(args.cons->cdr)) {
+            struct Expr y = args.cons->cdr.cons->car;
+            if (!number_p(y)) {
+                return wrong_type_argument(gc, "numberp", y);
+            }
+
+            const int c = compare_numbers(x, y);
+            switch (op) {
+            case BUILTIN_LESS: holds = holds && c < 0; break;
+            case BUILTIN_GREATER: holds = holds && c > 0; break;
+            case BUILTIN_EQUAL: holds = holds && c == 0; break;
+            default: assert(0 && "Not a comparison builtin");
+            }
+        }
+
+        args = args.cons->cdr;
+    }
+
+    return eval_success(holds ? T(gc) : NIL(gc));
+}
+
+static struct EvalResult plus_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+    return fold_numbers(gc, BUILTIN_PLUS, NUMBER(gc, 0), args);
+}
+
+static struct EvalResult minus_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+
+    if (cons_p(args) && cons_p(args.cons->cdr)) {
+        return fold_numbers(gc, BUILTIN_MINUS, args.cons->car, args.cons->cdr);
+    }
+
+    return fold_numbers(gc, BUILTIN_MINUS, NUMBER(gc, 0), args);
+}
+
+static struct EvalResult mul_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+    return fold_numbers(gc, BUILTIN_MUL, NUMBER(gc, 1), args);
+}
+
+static struct EvalResult div_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+
+    if (cons_p(args) && cons_p(args.cons->cdr)) {
+        return fold_numbers(gc, BUILTIN_DIV, args.cons->car, args.cons->cdr);
+    }
+
+    return fold_numbers(gc, BUILTIN_DIV, NUMBER(gc, 1), args);
+}
+
+static struct EvalResult less_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+    return compare_op(gc, BUILTIN_LESS, args);
+}
+
+static struct EvalResult greater_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+    return compare_op(gc, BUILTIN_GREATER, args);
+}
+
+static struct EvalResult equal_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+    return compare_op(gc, BUILTIN_EQUAL, args);
+}
+
+static struct EvalResult car_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+
+    struct Expr xs = args.cons->car;
+
+    if (nil_p(xs)) {
+        return eval_success(xs);
+    }
+
+    if (!cons_p(xs)) {
+        return wrong_type_argument(gc, "listp", xs);
+    }
+
+    return eval_success(xs.cons->car);
+}
+
+static struct EvalResult cdr_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+
+    struct Expr xs = args.cons->car;
+
+    if (nil_p(xs)) {
+        return eval_success(xs);
+    }
+
+    if (!cons_p(xs)) {
+        return wrong_type_argument(gc, "listp", xs);
+    }
+
+    return eval_success(xs.cons->cdr);
+}
+
+static struct EvalResult cons_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+    return eval_success(CONS(gc, args.cons->car, args.cons->cdr.cons->car));
+}
+
+static struct EvalResult list_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) gc;
+    (void) scope;
+    return eval_success(args);
+}
+
+static struct Expr stat_pair(Gc *gc, const char *name, size_t value)
+{
+    return CONS(gc, SYMBOL(gc, name), NUMBER(gc, (long int) value));
+}
+
+static struct EvalResult gc_stats_op(void *param, Gc *gc, struct Scope *scope, struct Expr args)
+{
+    (void) param;
+    (void) scope;
+    (void) args;
+
+    static const char *const pause_buckets[GC_PAUSE_BUCKETS] = {
+        "<10us", "<50us", "<100us", "<500us", "<1ms", "<5ms", "<10ms", ">=10ms"
+    };
+
+    struct GcStats stats;
+    gc_stats(gc, &stats);
+
+    struct Expr pauses = NIL(gc);
+    for (size_t i = GC_PAUSE_BUCKETS; i > 0; --i) {
+        pauses = CONS(gc, stat_pair(gc, pause_buckets[i - 1], stats.pauses[i - 1]), pauses);
+    }
+
+    return eval_success(
+        list(gc, 14,
+             stat_pair(gc, "conses", stats.conses),
+             stat_pair(gc, "symbols", stats.symbols),
+             stat_pair(gc, "strings", stats.strings),
+             stat_pair(gc, "natives", stats.natives),
+             stat_pair(gc, "closures", stats.closures),
+             stat_pair(gc, "bytes-live", stats.bytes_live),
+             stat_pair(gc, "bytes-allocated", stats.bytes_allocated),
+             stat_pair(gc, "objects-allocated", stats.objects_allocated),
+             stat_pair(gc, "collections", stats.collections),
+             stat_pair(gc, "steps", stats.steps),
+             CONS(gc, SYMBOL(gc, "pauses"), pauses),
+             CONS(gc, SYMBOL(gc, "max-pause-us"), NUMBER(gc, stats.max_pause_us)),
+             stat_pair(gc, "slots", stats.slots),
+             stat_pair(gc, "slots-capacity", stats.slots_capacity)));
+}
+
+static const struct Builtin builtins[BUILTIN_N] = {
+    [BUILTIN_QUOTE]   = { .name = "quote",  .fun = NULL,       .min_args = 1, .max_args = 1 },
+    [BUILTIN_LAMBDA]  = { .name = "lambda", .fun = NULL,       .min_args = 1, .max_args = -1 },
+    [BUILTIN_SET]     = { .name = "set",    .fun = NULL,       .min_args = 2, .max_args = 2 },
+    [BUILTIN_IF]      = { .name = "if",     .fun = NULL,       .min_args = 2, .max_args = -1 },
+    [BUILTIN_LET]     = { .name = "let",    .fun = NULL,       .min_args = 1, .max_args = -1 },
+    [BUILTIN_PROGN]   = { .name = "progn",  .fun = NULL,       .min_args = 0, .max_args = -1 },
+    [BUILTIN_PLUS]    = { .name = "+",      .fun = plus_op,    .min_args = 0, .max_args = -1 },
+    [BUILTIN_MINUS]   = { .name = "-",      .fun = minus_op,   .min_args = 0, .max_args = -1 },
+    [BUILTIN_MUL]     = { .name = "*",      .fun = mul_op,     .min_args = 0, .max_args = -1 },
+    [BUILTIN_DIV]     = { .name = "/",      .fun = div_op,     .min_args = 1, .max_args = -1 },
+    [BUILTIN_LESS]    = { .name = "<",      .fun = less_op,    .min_args = 1, .max_args = -1 },
+    [BUILTIN_GREATER] = { .name = ">",      .fun = greater_op, .min_args = 1, .max_args = -1 },
+    [BUILTIN_EQUAL]   = { .name = "=",      .fun = equal_op,   .min_args = 1, .max_args = -1 },
+    [BUILTIN_CAR]     = { .name = "car",    .fun = car_op,     .min_args = 1, .max_args = 1 },
+    [BUILTIN_CDR]     = { .name = "cdr",    .fun = cdr_op,     .min_args = 1, .max_args = 1 },
+    [BUILTIN_CONS]    = { .name = "cons",   .fun = cons_op,    .min_args = 2, .max_args = 2 },
+    [BUILTIN_LIST]    = { .name = "list",   .fun = list_op,    .min_args = 0, .max_args = -1 },
+    [BUILTIN_GC_STATS] = { .name = "gc-stats", .fun = gc_stats_op, .min_args = 0, .max_args = 0 },
+};
+
+enum BuiltinId symbol_builtin(struct Atom *symbol)
+{
+    assert(symbol);
+    assert(symbol->type == ATOM_SYMBOL);
+
+    if (symbol->builtin == BUILTIN_UNKNOWN) {
+        symbol->builtin = BUILTIN_NONE;
+
+        for (int i = 0; i < BUILTIN_N; ++i) {
+            if (atom_text_equal(symbol, builtins[i].name)) {
+                symbol->builtin = i;
+                break;
+            }
+        }
+    }
+
+    return (enum BuiltinId) symbol->builtin;
+}
+
+const struct Builtin *builtin_by_id(enum BuiltinId id)
+{
+    assert(0 <= id && id < BUILTIN_N);
+    return &builtins[id];
+}
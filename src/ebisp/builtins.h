@@ -3,19 +3,72 @@
 
 #include "expr.h"
 
+// Does not recurse, so arbitrarily nested expressions can be
+// compared. Returns false and throws the error if it runs out of
+// memory.
 bool equal(struct Expr obj1, struct Expr obj2);
 
 bool nil_p(struct Expr obj);
 bool symbol_p(struct Expr obj);
+bool integer_p(struct Expr obj);
+bool real_p(struct Expr obj);
+bool number_p(struct Expr obj);
 bool cons_p(struct Expr obj);
 bool list_p(struct Expr obj);
 bool list_of_symbols_p(struct Expr obj);
 bool lambda_p(struct Expr obj);
 
 long int length_of_list(struct Expr obj);
+double number_as_real(struct Expr obj);
 
 struct Expr assoc(struct Expr key, struct Expr alist);
 
 struct Expr list(Gc *gc, size_t n, ...);
 
+enum BuiltinId
+{
+    BUILTIN_UNKNOWN = -2,       // the symbol was not looked up yet
+    BUILTIN_NONE = -1,          // the symbol is not a builtin
+
+    // Special forms
+    BUILTIN_QUOTE = 0,
+    BUILTIN_LAMBDA,
+    BUILTIN_SET,
+    BUILTIN_IF,
+    BUILTIN_LET,
+    BUILTIN_PROGN,
+
+    // Functions
+    BUILTIN_PLUS,
+    BUILTIN_MINUS,
+    BUILTIN_MUL,
+    BUILTIN_DIV,
+    BUILTIN_LESS,
+    BUILTIN_GREATER,
+    BUILTIN_EQUAL,
+    BUILTIN_CAR,
+    BUILTIN_CDR,
+    BUILTIN_CONS,
+    BUILTIN_LIST,
+    BUILTIN_GC_STATS,
+
+    BUILTIN_N
+};
+
+struct Builtin
+{
+    const char *name;
+    NativeFunction fun;         // NULL for special forms
+    long int min_args;
+    long int max_args;          // -1 for any amount of arguments
+};
+
+/** \brief Finds the builtin named by the symbol.
+ *
+ * The result of the lookup is cached in the symbol, so only the
+ * first lookup compares strings.
+ */
+enum BuiltinId symbol_builtin(struct Atom *symbol);
+const struct Builtin *builtin_by_id(enum BuiltinId id);
+
 #endif  // BUILTINS_H_
@@ -0,0 +1,288 @@
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#include "ebisp/dump.h"
+#include "ebisp/gc.h"
+#include "ebisp/source.h"
+#include "system/error.h"
+
+#define DUMP_MAGIC "EBDUMP"
+#define DUMP_VERSION 2
+
+enum DumpTag
+{
+    DUMP_TAG_CONS = 'c',
+    DUMP_TAG_SYMBOL = 'y',
+    DUMP_TAG_STRING = 's',
+    DUMP_TAG_INTEGER = 'i',
+    DUMP_TAG_REAL = 'r'
+};
+
+static int dump_write(FILE *stream, const void *data, size_t size)
+{
+    if (fwrite(data, 1, size, stream) != size) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int dump_tag(FILE *stream, enum DumpTag tag)
+{
+    const unsigned char byte = (unsigned char) tag;
+    return dump_write(stream, &byte, 1);
+}
+
+static int dump_text(FILE *stream, enum DumpTag tag, const char *text, size_t len)
+{
+    if (len > UINT32_MAX) {
+        return -1;
+    }
+
+    const uint32_t len32 = (uint32_t) len;
+
+    if (dump_tag(stream, tag) < 0
+        || dump_write(stream, &len32, sizeof(len32)) < 0) {
+        return -1;
+    }
+
+    return dump_write(stream, text, len);
+}
+
+static int dump_expr_impl(FILE *stream, struct Expr expr, size_t depth)
+{
+    if (depth >= DUMP_MAX_DEPTH) {
+        return -1;
+    }
+
+    /* The cdrs are walked in a loop and only the cars are dumped
+     * recursively, so long lists do not eat the C stack */
+    while (expr.type == EXPR_CONS) {
+        if (dump_tag(stream, DUMP_TAG_CONS) < 0
+            || dump_expr_impl(stream, expr.cons->car, depth + 1) < 0) {
+            return -1;
+        }
+
+        expr = expr.cons->cdr;
+    }
+
+    switch (expr.type) {
+    case EXPR_ATOM:
+        switch (expr.atom->type) {
+        case ATOM_SYMBOL:
+            return dump_text(stream, DUMP_TAG_SYMBOL, expr.atom->sym, expr.atom->len);
+
+        case ATOM_STRING:
+            return dump_text(stream, DUMP_TAG_STRING, expr.atom->str, expr.atom->len);
+
+        case ATOM_NATIVE:
+        case ATOM_CLOSURE:
+            return -1;
+        }
+        break;
+
+    case EXPR_INTEGER: {
+        const int64_t integer = expr.integer;
+        if (dump_tag(stream, DUMP_TAG_INTEGER) < 0) {
+            return -1;
+        }
+        return dump_write(stream, &integer, sizeof(integer));
+    }
+
+    case EXPR_REAL: {
+        if (dump_tag(stream, DUMP_TAG_REAL) < 0) {
+            return -1;
+        }
+        return dump_write(stream, &expr.real, sizeof(expr.real));
+    }
+
+    case EXPR_CONS:
+    case EXPR_VOID:
+        break;
+    }
+
+    return -1;
+}
+
+int dump_expr(FILE *stream, const char *key, size_t key_size, struct Expr expr)
+{
+    assert(stream);
+    assert(key);
+
+    const unsigned char version = DUMP_VERSION;
+    const uint64_t key_size64 = (uint64_t) key_size;
+
+    if (dump_write(stream, DUMP_MAGIC, sizeof(DUMP_MAGIC)) < 0
+        || dump_write(stream, &version, sizeof(version)) < 0
+        || dump_write(stream, &key_size64, sizeof(key_size64)) < 0
+        || dump_write(stream, key, key_size) < 0) {
+        return -1;
+    }
+
+    return dump_expr_impl(stream, expr, 0);
+}
+
+struct DumpReader
+{
+    const char *begin;
+    const char *current;
+    const char *end;
+};
+
+static bool dump_read(struct DumpReader *reader, void *data, size_t size)
+{
+    if ((size_t) (reader->end - reader->current) < size) {
+        return false;
+    }
+
+    memcpy(data, reader->current, size);
+    reader->current += size;
+
+    return true;
+}
+
+static struct ParseResult load_text(Gc *gc, struct DumpReader *reader, enum DumpTag tag)
+{
+    uint32_t len = 0;
+    if (!dump_read(reader, &len, sizeof(len))
+        || (size_t) (reader->end - reader->current) < len) {
+        return parse_failure("Unexpected end of dump", reader->current);
+    }
+
+    const char *text = reader->current;
+    reader->current += len;
+
+    struct Atom *atom = tag == DUMP_TAG_SYMBOL
+        ? create_symbol_slice_atom(gc, text, text + len)
+        : create_string_slice_atom(gc, text, text + len);
+    if (atom == NULL) {
+        return parse_failure("Could not allocate an atom", text);
+    }
+
+    return parse_success(atom_as_expr(atom), reader->current);
+}
+
+static struct ParseResult load_expr(Gc *gc, struct DumpReader *reader, size_t depth)
+{
+    if (depth >= DUMP_MAX_DEPTH) {
+        return parse_failure("Dump is nested too deeply", reader->current);
+    }
+
+    struct Cons *head = NULL;
+    struct Cons *last = NULL;
+
+    while (true) {
+        unsigned char tag = 0;
+        if (!dump_read(reader, &tag, sizeof(tag))) {
+            return parse_failure("Unexpected end of dump", reader->current);
+        }
+
+        struct ParseResult result;
+
+        switch (tag) {
+        case DUMP_TAG_CONS: {
+            result = load_expr(gc, reader, depth + 1);
+            if (result.is_error) {
+                return result;
+            }
+
+            struct Cons *cons = create_cons(gc, result.expr, NIL(gc));
+            if (last == NULL) {
+                head = cons;
+            } else {
+                last->cdr = cons_as_expr(cons);
+                gc_write_barrier(gc, last->cdr);
+            }
+            last = cons;
+        } continue;
+
+        case DUMP_TAG_SYMBOL:
+        case DUMP_TAG_STRING: {
+            result = load_text(gc, reader, (enum DumpTag) tag);
+        } break;
+
+        case DUMP_TAG_INTEGER: {
+            int64_t integer = 0;
+            if (!dump_read(reader, &integer, sizeof(integer))) {
+                return parse_failure("Unexpected end of dump", reader->current);
+            }
+            result = parse_success(NUMBER(gc, (long int) integer), reader->current);
+        } break;
+
+        case DUMP_TAG_REAL: {
+            double real = 0.0;
+            if (!dump_read(reader, &real, sizeof(real))) {
+                return parse_failure("Unexpected end of dump", reader->current);
+            }
+            result = parse_success(REAL(gc, real), reader->current);
+        } break;
+
+        default:
+            return parse_failure("Unknown tag in dump", reader->current - 1);
+        }
+
+        if (result.is_error || last == NULL) {
+            return result;
+        }
+
+        /* The atom terminates the list */
+        last->cdr = result.expr;
+        gc_write_barrier(gc, last->cdr);
+
+        return parse_success(cons_as_expr(head), reader->current);
+    }
+}
+
+struct ParseResult load_expr_from_file(Gc *gc, const char *filename,
+                                       const char *key, size_t key_size)
+{
+    assert(gc);
+    assert(filename);
+    assert(key);
+
+    struct Source *source = create_source_from_file(filename);
+    if (source == NULL) {
+        return parse_failure(strerror(errno), NULL);
+    }
+
+    if (gc_add_source(gc, source) < 0) {
+        destroy_source(source);
+        return parse_failure(strerror(errno), NULL);
+    }
+
+    struct DumpReader reader = {
+        .begin = source_text(source),
+        .current = source_text(source),
+        .end = source_text(source) + source_size(source)
+    };
+
+    char magic[sizeof(DUMP_MAGIC)];
+    unsigned char version = 0;
+    uint64_t dump_key_size = 0;
+
+    if (!dump_read(&reader, magic, sizeof(magic))
+        || memcmp(magic, DUMP_MAGIC, sizeof(magic)) != 0
+        || !dump_read(&reader, &version, sizeof(version))
+        || version != DUMP_VERSION) {
+        return parse_failure("Not a dump", reader.begin);
+    }
+
+    /* The whole key is compared, so two keys that only share a hash
+     * can never pick up each other's dumps */
+    if (!dump_read(&reader, &dump_key_size, sizeof(dump_key_size))
+        || dump_key_size != (uint64_t) key_size
+        || (size_t) (reader.end - reader.current) < key_size
+        || memcmp(reader.current, key, key_size) != 0) {
+        return parse_failure("Stale dump", reader.begin);
+    }
+    reader.current += key_size;
+
+    struct ParseResult result = load_expr(gc, &reader, 0);
+    if (!result.is_error && reader.current != reader.end) {
+        return parse_failure("Garbage at the end of dump", reader.current);
+    }
+
+    return result;
+}
@@ -0,0 +1,30 @@
+#ifndef DUMP_H_
+#define DUMP_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ebisp/expr.h"
+#include "ebisp/parser.h"
+
+// Dump is a binary pre-parsed form of the expressions. Loading it
+// skips the tokenizer and the parser completely.
+//
+// The format is meant for local caches only: the numbers are stored
+// in the byte order of the machine that wrote them. The key is an
+// arbitrary chunk of bytes chosen by the caller (e.g. the source text
+// of the expressions) that is stored in the dump verbatim and
+// compared byte by byte on loading to detect stale dumps.
+//
+// Only symbols, strings, numbers and conses can be dumped.
+
+#define DUMP_MAX_DEPTH 1024
+
+int dump_expr(FILE *stream, const char *key, size_t key_size, struct Expr expr);
+
+// The file is memory mapped and the symbols and strings of the
+// result reference it directly. The mapping is owned by the Gc.
+struct ParseResult load_expr_from_file(Gc *gc, const char *filename,
+                                       const char *key, size_t key_size);
+
+#endif  // DUMP_H_
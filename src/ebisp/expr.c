@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "ebisp/builtins.h"
 #include "ebisp/expr.h"
 #include "ebisp/gc.h"
 #include "str.h"
@@ -29,76 +30,33 @@ struct Expr cons_as_expr(struct Cons *cons)
     return expr;
 }
 
-struct Expr void_expr(void)
+struct Expr integer_expr(long int integer)
 {
     struct Expr expr = {
-        .type = EXPR_VOID
+        .type = EXPR_INTEGER,
+        .integer = integer
     };
 
     return expr;
 }
 
-void print_atom_as_sexpr(FILE *stream, struct Atom *atom)
-{
-    assert(atom);
-
-    switch (atom->type) {
-    case ATOM_SYMBOL:
-        fprintf(stream, "%s", atom->sym);
-        break;
-
-    case ATOM_NUMBER:
-        fprintf(stream, "%ld", atom->num);
-        break;
-
-    case ATOM_STRING:
-        fprintf(stream, "\"%s\"", atom->str);
-        break;
-
-    case ATOM_NATIVE:
-        fprintf(stream, "<native>");
-        break;
-    }
-}
-
-void print_cons_as_sexpr(FILE *stream, struct Cons *head)
+struct Expr real_expr(double real)
 {
-    assert(head);
-
-    struct Cons *cons = head;
-
-    fprintf(stream, "(");
-    print_expr_as_sexpr(stream, cons->car);
-
-    while (cons->cdr.type == EXPR_CONS) {
-        cons = cons->cdr.cons;
-        fprintf(stream, " ");
-        print_expr_as_sexpr(stream, cons->car);
-    }
-
-    if (cons->cdr.atom->type != ATOM_SYMBOL ||
-        strcmp("nil", cons->cdr.atom->sym) != 0) {
-        fprintf(stream, " . ");
-        print_expr_as_sexpr(stream, cons->cdr);
-    }
+    struct Expr expr = {
+        .type = EXPR_REAL,
+        .real = real
+    };
 
-    fprintf(stream, ")");
+    return expr;
 }
 
-void print_expr_as_sexpr(FILE *stream, struct Expr expr)
+struct Expr void_expr(void)
 {
-    switch (expr.type) {
-    case EXPR_ATOM:
-        print_atom_as_sexpr(stream, expr.atom);
-        break;
-
-    case EXPR_CONS:
-        print_cons_as_sexpr(stream, expr.cons);
-        break;
+    struct Expr expr = {
+        .type = EXPR_VOID
+    };
 
-    case EXPR_VOID:
-        break;
-    }
+    return expr;
 }
 
 void destroy_expr(struct Expr expr)
@@ -112,6 +70,8 @@ void destroy_expr(struct Expr expr)
         destroy_cons(expr.cons);
         break;
 
+    case EXPR_INTEGER:
+    case EXPR_REAL:
     case EXPR_VOID:
         break;
     }
@@ -140,36 +100,35 @@ void destroy_cons(struct Cons *cons)
     free(cons);
 }
 
-struct Atom *create_number_atom(Gc *gc, long int num)
+static struct Atom *create_text_atom(Gc *gc,
+                                     enum AtomType type,
+                                     const char *begin,
+                                     const char *end,
+                                     bool borrow)
 {
-    struct Atom *atom = malloc(sizeof(struct Atom));
-    if (atom == NULL) {
-        return NULL;
-    }
-    atom->type = ATOM_NUMBER;
-    atom->num = num;
-
-    if (gc_add_expr(gc, atom_as_expr(atom)) < 0) {
-        free(atom);
-        return NULL;
-    }
-
-    return atom;
-}
+    assert(begin);
 
-struct Atom *create_string_atom(Gc *gc, const char *str, const char *str_end)
-{
     struct Atom *atom = malloc(sizeof(struct Atom));
 
     if (atom == NULL) {
         goto error;
     }
 
-    atom->type = ATOM_STRING;
-    atom->str = string_duplicate(str, str_end);
-
-    if (atom->str == NULL) {
-        goto error;
+    atom->type = type;
+    atom->owned = NULL;
+    atom->builtin = BUILTIN_UNKNOWN;
+
+    if (borrow) {
+        assert(end);
+        atom->sym = begin;
+        atom->len = (size_t) (end - begin);
+    } else {
+        atom->owned = string_duplicate(begin, end);
+        if (atom->owned == NULL) {
+            goto error;
+        }
+        atom->sym = atom->owned;
+        atom->len = strlen(atom->owned);
     }
 
     if (gc_add_expr(gc, atom_as_expr(atom)) < 0) {
@@ -180,16 +139,43 @@ struct Atom *create_string_atom(Gc *gc, const char *str, const char *str_end)
 
 error:
     if (atom != NULL) {
-        if (atom->str != NULL) {
-            free(atom->str);
-        }
+        free(atom->owned);
         free(atom);
     }
 
     return NULL;
 }
 
+struct Atom *create_string_atom(Gc *gc, const char *str, const char *str_end)
+{
+    return create_text_atom(gc, ATOM_STRING, str, str_end, false);
+}
+
 struct Atom *create_symbol_atom(Gc *gc, const char *sym, const char *sym_end)
+{
+    return create_text_atom(gc, ATOM_SYMBOL, sym, sym_end, false);
+}
+
+struct Atom *create_string_slice_atom(Gc *gc, const char *begin, const char *end)
+{
+    return create_text_atom(gc, ATOM_STRING, begin, end, true);
+}
+
+struct Atom *create_symbol_slice_atom(Gc *gc, const char *begin, const char *end)
+{
+    return create_text_atom(gc, ATOM_SYMBOL, begin, end, true);
+}
+
+bool atom_text_equal(const struct Atom *atom, const char *text)
+{
+    assert(atom);
+    assert(atom->type == ATOM_SYMBOL || atom->type == ATOM_STRING);
+    assert(text);
+
+    return strlen(text) == atom->len && memcmp(atom->sym, text, atom->len) == 0;
+}
+
+struct Atom *create_native_atom(Gc *gc, NativeFunction fun, void *param)
 {
     struct Atom *atom = malloc(sizeof(struct Atom));
 
@@ -197,12 +183,9 @@ struct Atom *create_symbol_atom(Gc *gc, const char *sym, const char *sym_end)
         goto error;
     }
 
-    atom->type = ATOM_SYMBOL;
-    atom->sym = string_duplicate(sym, sym_end);
-
-    if (atom->sym == NULL) {
-        goto error;
-    }
+    atom->type = ATOM_NATIVE;
+    atom->native.fun = fun;
+    atom->native.param = param;
 
     if (gc_add_expr(gc, atom_as_expr(atom)) < 0) {
         goto error;
@@ -212,16 +195,13 @@ struct Atom *create_symbol_atom(Gc *gc, const char *sym, const char *sym_end)
 
 error:
     if (atom != NULL) {
-        if (atom->sym != NULL) {
-            free(atom->sym);
-        }
         free(atom);
     }
 
     return NULL;
 }
 
-struct Atom *create_native_atom(Gc *gc, NativeFunction fun, void *param)
+struct Atom *create_closure_atom(Gc *gc, struct Expr params, struct Expr body, struct Expr env)
 {
     struct Atom *atom = malloc(sizeof(struct Atom));
 
@@ -229,9 +209,15 @@ struct Atom *create_native_atom(Gc *gc, NativeFunction fun, void *param)
         goto error;
     }
 
-    atom->type = ATOM_NATIVE;
-    atom->native.fun = fun;
-    atom->native.param = param;
+    atom->type = ATOM_CLOSURE;
+    atom->closure.params = params;
+    atom->closure.body = body;
+    atom->closure.env = env;
+    atom->closure.arity = 0;
+
+    for (struct Expr param = params; param.type == EXPR_CONS; param = param.cons->cdr) {
+        atom->closure.arity++;
+    }
 
     if (gc_add_expr(gc, atom_as_expr(atom)) < 0) {
         goto error;
@@ -252,11 +238,11 @@ void destroy_atom(struct Atom *atom)
     switch (atom->type) {
     case ATOM_SYMBOL:
     case ATOM_STRING: {
-        free(atom->str);
+        free(atom->owned);
     } break;
 
     case ATOM_NATIVE:
-    case ATOM_NUMBER: {
+    case ATOM_CLOSURE: {
         /* Nothing */
     } break;
     }
@@ -264,97 +250,264 @@ void destroy_atom(struct Atom *atom)
     free(atom);
 }
 
-static int atom_as_sexpr(struct Atom *atom, char *output, size_t n)
+/* S-expression serializer
+ *
+ * Writes into a Sink that is either a FILE* or a growable string
+ * buffer. Lists are walked with an explicit stack of frames, so deeply
+ * nested expressions do not exhaust the C stack. Lists nested deeper
+ * than EXPR_PRINT_MAX_DEPTH are printed as `...`. A cons that is
+ * reached again while it is still being printed is printed as `#cycle`. */
+
+#define SINK_INITIAL_CAPACITY 64
+#define PRINT_STACK_INITIAL_CAPACITY 16
+
+struct Sink
 {
-    assert(atom);
-    assert(output);
+    FILE *stream;               /* NULL for the string buffer sink */
+    char *buffer;
+    size_t size;
+    size_t capacity;
+};
 
-    switch (atom->type) {
-    case ATOM_SYMBOL:
-        return snprintf(output, n, "%s", atom->sym);
+struct PrintFrame
+{
+    struct Cons *head;
+    struct Cons *cons;
+    /* Brent's cycle detection over the cdrs of the list */
+    struct Cons *tortoise;
+    size_t power;
+    size_t steps;
+};
+
+static int sink_write(struct Sink *sink, const char *data, size_t n)
+{
+    assert(sink);
+    assert(data);
+
+    if (sink->stream != NULL) {
+        return fwrite(data, sizeof(char), n, sink->stream) == n ? 0 : -1;
+    }
 
-    case ATOM_NUMBER:
-        return snprintf(output, n, "%ld", atom->num);
+    if (sink->size + n + 1 > sink->capacity) {
+        size_t new_capacity = sink->capacity == 0 ? SINK_INITIAL_CAPACITY : sink->capacity;
+        while (sink->size + n + 1 > new_capacity) {
+            new_capacity *= 2;
+        }
 
-    case ATOM_STRING:
-        return snprintf(output, n, "\"%s\"", atom->str);
+        char *new_buffer = realloc(sink->buffer, new_capacity);
+        if (new_buffer == NULL) {
+            return -1;
+        }
 
-    case ATOM_NATIVE:
-        return snprintf(output, n, "<native>");
+        sink->buffer = new_buffer;
+        sink->capacity = new_capacity;
     }
 
+    memcpy(sink->buffer + sink->size, data, n);
+    sink->size += n;
+    sink->buffer[sink->size] = 0;
+
     return 0;
 }
 
-static int cons_as_sexpr(struct Cons *head, char *output, size_t n)
+static int sink_write_str(struct Sink *sink, const char *str)
 {
-    assert(head);
-    assert(output);
+    return sink_write(sink, str, strlen(str));
+}
 
-    /* TODO(#378): cons_as_sexpr does not handle encoding errors of snprintf */
+static int sink_write_atomic(struct Sink *sink, struct Expr expr)
+{
+    char number[64];
+    int n = 0;
 
-    struct Cons *cons = head;
+    switch (expr.type) {
+    case EXPR_ATOM:
+        switch (expr.atom->type) {
+        case ATOM_SYMBOL:
+            return sink_write(sink, expr.atom->sym, expr.atom->len);
+
+        case ATOM_STRING:
+            if (sink_write(sink, "\"", 1) < 0
+                || sink_write(sink, expr.atom->str, expr.atom->len) < 0) {
+                return -1;
+            }
+            return sink_write(sink, "\"", 1);
+
+        case ATOM_NATIVE:
+            return sink_write_str(sink, "<native>");
+
+        case ATOM_CLOSURE:
+            return sink_write_str(sink, "<closure>");
+        }
+        break;
 
-    int m = (int) n;
+    case EXPR_INTEGER:
+        n = snprintf(number, sizeof(number), "%ld", expr.integer);
+        break;
 
-    int c = snprintf(output, n, "(");
-    if (m - c <= c) {
-        return c;
+    case EXPR_REAL:
+        /* 17 significant digits read back as the same double. A
+         * whole real keeps its ".0", so it is not read back as an
+         * integer; "inf" and "nan" are left alone. */
+        n = snprintf(number, sizeof(number), "%.17g", expr.real);
+        if (n > 0 && (size_t) n + 2 < sizeof(number) && strpbrk(number, ".ein") == NULL) {
+            memcpy(number + n, ".0", 3);
+            n += 2;
+        }
+        break;
+
+    case EXPR_CONS:
+    case EXPR_VOID:
+        return 0;
     }
 
-    c += expr_as_sexpr(cons->car, output + c, (size_t) (m - c));
-    if (m - c <= 0) {
-        return c;
+    if (n < 0) {
+        return -1;
     }
 
-    while (cons->cdr.type == EXPR_CONS) {
-        cons = cons->cdr.cons;
+    return sink_write(sink, number, (size_t) n);
+}
 
-        c += snprintf(output + c, (size_t) (m - c), " ");
-        if (m - c <= 0) {
-            return c;
+static bool print_stack_contains(const struct PrintFrame *frames, size_t size, const struct Cons *cons)
+{
+    for (size_t i = 0; i < size; ++i) {
+        if (frames[i].head == cons) {
+            return true;
         }
+    }
 
-        c += expr_as_sexpr(cons->car, output + c, (size_t) (m - c));
-        if (m - c <= 0) {
-            return c;
+    return false;
+}
+
+static int sink_write_expr(struct Sink *sink, struct Expr expr)
+{
+    struct PrintFrame initial[PRINT_STACK_INITIAL_CAPACITY];
+    struct PrintFrame *frames = initial;
+    size_t size = 0;
+    size_t capacity = PRINT_STACK_INITIAL_CAPACITY;
+    int status = 0;
+
+    while (true) {
+        /* Entering expr */
+        if (expr.type != EXPR_CONS) {
+            status = sink_write_atomic(sink, expr);
+        } else if (size >= EXPR_PRINT_MAX_DEPTH) {
+            status = sink_write_str(sink, "...");
+        } else if (print_stack_contains(frames, size, expr.cons)) {
+            status = sink_write_str(sink, "#cycle");
+        } else {
+            if (size >= capacity) {
+                const size_t new_capacity = capacity * 2;
+                struct PrintFrame *new_frames = frames == initial
+                    ? malloc(sizeof(struct PrintFrame) * new_capacity)
+                    : realloc(frames, sizeof(struct PrintFrame) * new_capacity);
+                if (new_frames == NULL) {
+                    status = -1;
+                    break;
+                }
+                if (frames == initial) {
+                    memcpy(new_frames, initial, sizeof(struct PrintFrame) * size);
+                }
+                frames = new_frames;
+                capacity = new_capacity;
+            }
+
+            struct PrintFrame *frame = &frames[size++];
+            frame->head = expr.cons;
+            frame->cons = expr.cons;
+            frame->tortoise = expr.cons;
+            frame->power = 1;
+            frame->steps = 0;
+
+            if (sink_write(sink, "(", 1) < 0) {
+                status = -1;
+                break;
+            }
+
+            expr = expr.cons->car;
+            continue;
         }
-    }
 
-    if (cons->cdr.atom->type != ATOM_SYMBOL ||
-        strcmp("nil", cons->cdr.atom->sym) != 0) {
+        if (status < 0) {
+            break;
+        }
 
-        c += snprintf(output + c, (size_t) (m - c), " . ");
-        if (m - c <= 0) {
-            return c;
+        /* Leaving expr: move to the next element of the innermost
+         * unfinished list */
+        bool entering = false;
+        while (size > 0 && !entering) {
+            struct PrintFrame *frame = &frames[size - 1];
+            struct Expr cdr = frame->cons->cdr;
+
+            if (cdr.type == EXPR_CONS) {
+                frame->cons = cdr.cons;
+
+                if (frame->cons == frame->tortoise) {
+                    status = sink_write_str(sink, " . #cycle)");
+                    size--;
+                } else {
+                    if (++frame->steps == frame->power) {
+                        frame->tortoise = frame->cons;
+                        frame->power *= 2;
+                        frame->steps = 0;
+                    }
+
+                    status = sink_write(sink, " ", 1);
+                    expr = frame->cons->car;
+                    entering = true;
+                }
+            } else {
+                if (!nil_p(cdr)) {
+                    if (sink_write(sink, " . ", 3) < 0
+                        || sink_write_atomic(sink, cdr) < 0) {
+                        status = -1;
+                    }
+                }
+
+                if (status == 0) {
+                    status = sink_write(sink, ")", 1);
+                }
+                size--;
+            }
+
+            if (status < 0) {
+                break;
+            }
         }
 
-        c += expr_as_sexpr(cons->cdr, output + c, (size_t) (m - c));
-        if (m - c <= 0) {
-            return c;
+        if (status < 0 || !entering) {
+            break;
         }
     }
 
-    c += snprintf(output + c, (size_t) (m - c), ")");
-    if (m - c <= 0) {
-        return c;
+    if (frames != initial) {
+        free(frames);
     }
 
-    return c;
+    return status;
 }
 
-int expr_as_sexpr(struct Expr expr, char *output, size_t n)
+int print_expr_as_sexpr(FILE *stream, struct Expr expr)
 {
-    switch(expr.type) {
-    case EXPR_ATOM:
-        return atom_as_sexpr(expr.atom, output, n);
+    assert(stream);
 
-    case EXPR_CONS:
-        return cons_as_sexpr(expr.cons, output, n);
+    struct Sink sink = {
+        .stream = stream
+    };
 
-    case EXPR_VOID:
-        return 0;
+    return sink_write_expr(&sink, expr);
+}
+
+char *expr_as_sexpr(struct Expr expr)
+{
+    struct Sink sink = {
+        .stream = NULL
+    };
+
+    if (sink_write(&sink, "", 0) < 0 || sink_write_expr(&sink, expr) < 0) {
+        free(sink.buffer);
+        return NULL;
     }
 
-    return 0;
+    return sink.buffer;
 }
@@ -11,12 +11,15 @@ typedef struct Scope Scope;
 struct Cons;
 struct Atom;
 
-#define NUMBER(G, X) atom_as_expr(create_number_atom(G, X))
+#define NUMBER(G, X) integer_expr(X)
+#define REAL(G, X) real_expr(X)
 #define STRING(G, S) atom_as_expr(create_string_atom(G, S, NULL))
 #define SYMBOL(G, S) atom_as_expr(create_symbol_atom(G, S, NULL))
 #define NATIVE(G, F, P) atom_as_expr(create_native_atom(G, F, P))
+#define CLOSURE(G, PARAMS, BODY, ENV) atom_as_expr(create_closure_atom(G, PARAMS, BODY, ENV))
 #define CONS(G, CAR, CDR) cons_as_expr(create_cons(G, CAR, CDR))
-#define NIL(G) SYMBOL(G, "nil")
+#define NIL(G) gc_nil(G)
+#define T(G) gc_t(G)
 
 #define CAR(O) ((O).cons->car)
 #define CDR(O) ((O).cons->cdr)
@@ -25,7 +28,11 @@ enum ExprType
 {
     EXPR_ATOM = 0,
     EXPR_CONS,
-    EXPR_VOID
+    EXPR_VOID,
+    // Immediate values. They live right inside of the Expr and are
+    // not tracked by the Gc.
+    EXPR_INTEGER,
+    EXPR_REAL
 };
 
 struct Expr
@@ -34,16 +41,27 @@ struct Expr
     union {
         struct Cons *cons;
         struct Atom *atom;
+        long int integer;
+        double real;
     };
 };
 
 struct Expr atom_as_expr(struct Atom *atom);
 struct Expr cons_as_expr(struct Cons *cons);
+struct Expr integer_expr(long int integer);
+struct Expr real_expr(double real);
 struct Expr void_expr(void);
 
 void destroy_expr(struct Expr expr);
-void print_expr_as_sexpr(FILE *stream, struct Expr expr);
-int expr_as_sexpr(struct Expr expr, char *output, size_t n);
+#define EXPR_PRINT_MAX_DEPTH 1024
+
+// Both functions print lists nested deeper than EXPR_PRINT_MAX_DEPTH
+// as `...` and conses that refer back to the list that contains
+// them as `#cycle`.
+int print_expr_as_sexpr(FILE *stream, struct Expr expr);
+// Returns a malloc'd string that has to be freed by the caller or
+// NULL in case of a failure.
+char *expr_as_sexpr(struct Expr expr);
 
 // TODO(#337): EvalResult does not belong to expr unit
 struct EvalResult
@@ -64,39 +82,65 @@ struct Native
 enum AtomType
 {
     ATOM_SYMBOL = 0,
-    ATOM_NUMBER,
     ATOM_STRING,
-    ATOM_NATIVE
+    ATOM_NATIVE,
+    ATOM_CLOSURE
+};
+
+// Result of evaluating a lambda. The parameters are validated once
+// when the closure is created, so applying it only has to compare
+// the number of arguments with arity.
+struct Closure
+{
+    struct Expr params;         // Proper list of symbols
+    struct Expr body;           // List of forms
+    struct Expr env;            // Scope the lambda was evaluated in
+    long int arity;
 };
 
 struct Atom
 {
     enum AtomType type;
+    int color;                  // Owned by the Gc
     union
     {
-        // TODO(#330): Atom doesn't support floats
-        long int num;           // ATOM_NUMBER
-        char *sym;              // ATOM_SYMBOL
-        char *str;              // ATOM_STRING
+        // ATOM_SYMBOL, ATOM_STRING
+        //
+        // The text is not NUL-terminated when it's borrowed from a
+        // Source. Always use len.
+        struct {
+            union {
+                const char *sym;    // ATOM_SYMBOL
+                const char *str;    // ATOM_STRING
+            };
+            size_t len;
+            char *owned;        // NULL if the text is borrowed
+            int builtin;        // ATOM_SYMBOL: cached enum BuiltinId, see builtins.h
+        };
         struct Native native;   // ATOM_NATIVE
+        struct Closure closure; // ATOM_CLOSURE
     };
 };
 
-struct Atom *create_number_atom(Gc *gc, long int num);
 struct Atom *create_string_atom(Gc *gc, const char *str, const char *str_end);
 struct Atom *create_symbol_atom(Gc *gc, const char *sym, const char *sym_end);
+// Slice atoms reference [begin, end) without copying it
+struct Atom *create_string_slice_atom(Gc *gc, const char *begin, const char *end);
+struct Atom *create_symbol_slice_atom(Gc *gc, const char *begin, const char *end);
+bool atom_text_equal(const struct Atom *atom, const char *text);
 struct Atom *create_native_atom(Gc *gc, NativeFunction fun, void *param);
+// params must be a proper list of symbols
+struct Atom *create_closure_atom(Gc *gc, struct Expr params, struct Expr body, struct Expr env);
 void destroy_atom(struct Atom *atom);
-void print_atom_as_sexpr(FILE *stream, struct Atom *atom);
 
 struct Cons
 {
     struct Expr car;
     struct Expr cdr;
+    int color;                  // Owned by the Gc
 };
 
 struct Cons *create_cons(Gc *gc, struct Expr car, struct Expr cdr);
 void destroy_cons(struct Cons *cons);
-void print_cons_as_sexpr(FILE *stream, struct Cons *cons);
 
 #endif  // EXPR_H_
@@ -6,46 +6,160 @@
 #include "builtins.h"
 #include "expr.h"
 #include "gc.h"
+#include "source.h"
+#include "system/clock.h"
 #include "system/error.h"
 #include "system/lt.h"
 
 #define GC_INITIAL_CAPACITY 256
+#define GC_ROOTS_INITIAL_CAPACITY 16
+/* How many objects are processed between two checks of the clock */
+#define GC_STEP_GRANULARITY 64
+/* Minimal amount of objects processed by gc_step per object allocated
+ * since the previous step. Without it a cycle never finishes if the
+ * scripts allocate faster than the time budget allows to collect. */
+#define GC_ALLOCATION_WORK_RATIO 2
+
+/* Incremental tri-colour mark and sweep.
+ *
+ * White objects are not known to be reachable yet. Gray objects are
+ * known to be reachable, but their children are not marked yet; they
+ * live on the gray stack. Black objects are reachable and all of their
+ * children are at least gray.
+ *
+ * The collector never lets a black object point to a white one:
+ * objects allocated during the mark phase are born gray, and
+ * gc_write_barrier() shades every white object that is stored into an
+ * existing object. The mark phase ends only when the gray stack is
+ * empty and all of the roots are black, so changes of the roots
+ * between the steps are not missed.
+ *
+ * The roots are the locations registered with gc_add_root() and the
+ * values on the handle stack.
+ *
+ * The sweep phase walks the objects once, destroys the white ones and
+ * turns the survivors white for the next cycle. Objects allocated
+ * during the sweep are born black so the sweep keeps them. */
+
+enum GcColor
+{
+    GC_WHITE = 0,
+    GC_GRAY,
+    GC_BLACK
+};
+
+enum GcPhase
+{
+    GC_PHASE_IDLE = 0,
+    GC_PHASE_MARK,
+    GC_PHASE_SWEEP
+};
 
 struct Gc
 {
     Lt *lt;
+    /* The growing arrays are replaced in their LT frames without
+     * looking the frames up */
+    Lt_frame exprs_frame;
+    Lt_frame gray_frame;
+    Lt_frame roots_frame;
+    Lt_frame handles_frame;
+
     struct Expr *exprs;
-    int *visited;
     size_t size;
     size_t capacity;
+
+    struct Expr **roots;
+    size_t roots_size;
+    size_t roots_capacity;
+    struct Expr *handles;
+    size_t handles_size;
+    size_t handles_capacity;
+
+    enum GcPhase phase;
+    struct Expr *gray;
+    size_t gray_size;
+    size_t gray_capacity;
+    /* Sweep phase: exprs[0..live) are processed survivors,
+     * exprs[sweep..size) are not processed yet */
+    size_t live;
+    size_t sweep;
+    /* gc_step starts a new cycle only when there are at least that
+     * many objects */
+    size_t next_cycle;
+    /* Objects allocated since the previous gc_step */
+    size_t allocated;
+
+    struct GcStats stats;
+
+    /* Registered as roots by create_gc */
+    struct Expr nil;
+    struct Expr t;
 };
 
-static long int value_of_expr(struct Expr expr)
+static int *expr_color(struct Expr expr)
 {
-    if (expr.type == EXPR_CONS) {
-        return (long int) expr.cons;
-    } else if (expr.type == EXPR_ATOM) {
-        return (long int) expr.atom;
-    } else {
+    switch (expr.type) {
+    case EXPR_ATOM:
+        return &expr.atom->color;
+    case EXPR_CONS:
+        return &expr.cons->color;
+    case EXPR_VOID:
+    case EXPR_INTEGER:
+    case EXPR_REAL:
+        /* Immediate values are not tracked */
+        return NULL;
+    }
+
+    return NULL;
+}
+
+static size_t expr_size(struct Expr expr)
+{
+    switch (expr.type) {
+    case EXPR_ATOM:
+        return sizeof(struct Atom)
+            + ((expr.atom->type == ATOM_SYMBOL || expr.atom->type == ATOM_STRING)
+               && expr.atom->owned != NULL
+               ? expr.atom->len + 1
+               : 0);
+    case EXPR_CONS:
+        return sizeof(struct Cons);
+    case EXPR_VOID:
+    case EXPR_INTEGER:
+    case EXPR_REAL:
         return 0;
     }
+
+    return 0;
 }
 
-static int compare_exprs(const void *a, const void *b)
+/* Accounts an object that enters (sign = 1) or leaves (sign = -1) the heap */
+static void gc_count_expr(Gc *gc, struct Expr expr, int sign)
 {
-    assert(a);
-    assert(b);
+    size_t *counter = NULL;
+
+    if (expr.type == EXPR_CONS) {
+        counter = &gc->stats.conses;
+    } else {
+        switch (expr.atom->type) {
+        case ATOM_SYMBOL: counter = &gc->stats.symbols; break;
+        case ATOM_STRING: counter = &gc->stats.strings; break;
+        case ATOM_NATIVE: counter = &gc->stats.natives; break;
+        case ATOM_CLOSURE: counter = &gc->stats.closures; break;
+        }
+    }
 
-    const long int ptr_a = value_of_expr(*(const struct Expr *)a);
-    const long int ptr_b = value_of_expr(*(const struct Expr *)b);
-    const long int d = ptr_b - ptr_a;
+    const size_t size = expr_size(expr);
 
-    if (d < 0) {
-        return -1;
-    } else if (d > 0) {
-        return 1;
+    if (sign > 0) {
+        (*counter)++;
+        gc->stats.bytes_live += size;
+        gc->stats.bytes_allocated += size;
+        gc->stats.objects_allocated++;
     } else {
-        return 0;
+        (*counter)--;
+        gc->stats.bytes_live -= size;
     }
 }
 
@@ -63,20 +177,54 @@ Gc *create_gc(void)
     }
     gc->lt = lt;
 
-    gc->exprs = PUSH_LT(lt, malloc(sizeof(struct Expr) * GC_INITIAL_CAPACITY), free);
+    gc->exprs = PUSH_LT_FRAME(lt, malloc(sizeof(struct Expr) * GC_INITIAL_CAPACITY), free, &gc->exprs_frame);
     if (gc->exprs == NULL) {
         throw_error(ERROR_TYPE_LIBC);
         RETURN_LT(lt, NULL);
     }
 
-    gc->visited = PUSH_LT(lt, malloc(sizeof(int) * GC_INITIAL_CAPACITY), free);
-    if (gc->visited == NULL) {
+    gc->gray = PUSH_LT_FRAME(lt, malloc(sizeof(struct Expr) * GC_INITIAL_CAPACITY), free, &gc->gray_frame);
+    if (gc->gray == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+
+    gc->roots = PUSH_LT_FRAME(lt, malloc(sizeof(struct Expr*) * GC_ROOTS_INITIAL_CAPACITY), free, &gc->roots_frame);
+    if (gc->roots == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+
+    gc->handles = PUSH_LT_FRAME(lt, malloc(sizeof(struct Expr) * GC_ROOTS_INITIAL_CAPACITY), free, &gc->handles_frame);
+    if (gc->handles == NULL) {
         throw_error(ERROR_TYPE_LIBC);
         RETURN_LT(lt, NULL);
     }
 
     gc->size = 0;
     gc->capacity = GC_INITIAL_CAPACITY;
+    gc->roots_size = 0;
+    gc->roots_capacity = GC_ROOTS_INITIAL_CAPACITY;
+    gc->handles_size = 0;
+    gc->handles_capacity = GC_ROOTS_INITIAL_CAPACITY;
+    gc->phase = GC_PHASE_IDLE;
+    gc->gray_size = 0;
+    gc->gray_capacity = GC_INITIAL_CAPACITY;
+    gc->live = 0;
+    gc->sweep = 0;
+    gc->next_cycle = GC_INITIAL_CAPACITY;
+    gc->allocated = 0;
+    memset(&gc->stats, 0, sizeof(gc->stats));
+
+    gc->nil = atom_as_expr(create_symbol_atom(gc, "nil", NULL));
+    gc->t = atom_as_expr(create_symbol_atom(gc, "t", NULL));
+    if (gc->nil.atom == NULL
+        || gc->t.atom == NULL
+        || gc_add_root(gc, &gc->nil) < 0
+        || gc_add_root(gc, &gc->t) < 0) {
+        destroy_gc(gc);
+        return NULL;
+    }
 
     return gc;
 }
@@ -86,12 +234,71 @@ void destroy_gc(Gc *gc)
     assert(gc);
 
     for (size_t i = 0; i < gc->size; ++i) {
+        if (gc->phase == GC_PHASE_SWEEP && gc->live <= i && i < gc->sweep) {
+            /* Already moved or destroyed by the sweep */
+            continue;
+        }
+
         destroy_expr(gc->exprs[i]);
     }
 
     RETURN_LT0(gc->lt);
 }
 
+int gc_add_source(Gc *gc, struct Source *source)
+{
+    assert(gc);
+    assert(source);
+
+    if (PUSH_LT(gc->lt, source, destroy_source) == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Abandons the current mark phase, for example when the gray stack
+ * can't grow. Nothing is deallocated, the next cycle starts over. */
+static void gc_abort_mark(Gc *gc)
+{
+    assert(gc->phase == GC_PHASE_MARK);
+
+    for (size_t i = 0; i < gc->size; ++i) {
+        *expr_color(gc->exprs[i]) = GC_WHITE;
+    }
+
+    gc->gray_size = 0;
+    gc->phase = GC_PHASE_IDLE;
+}
+
+static int gc_shade(Gc *gc, struct Expr expr)
+{
+    int *color = expr_color(expr);
+    if (color == NULL || *color != GC_WHITE) {
+        return 0;
+    }
+
+    if (gc->gray_size >= gc->gray_capacity) {
+        const size_t new_capacity = gc->gray_capacity * 2;
+        struct Expr *const new_gray = realloc(
+            gc->gray,
+            sizeof(struct Expr) * new_capacity);
+
+        if (new_gray == NULL) {
+            gc_abort_mark(gc);
+            return -1;
+        }
+
+        gc->gray_capacity = new_capacity;
+        gc->gray = REPLACE_LT_FRAME(gc->lt, gc->gray_frame, new_gray);
+    }
+
+    *color = GC_GRAY;
+    gc->gray[gc->gray_size++] = expr;
+
+    return 0;
+}
+
 int gc_add_expr(Gc *gc, struct Expr expr)
 {
     assert(gc);
@@ -107,83 +314,329 @@ int gc_add_expr(Gc *gc, struct Expr expr)
         }
 
         gc->capacity = new_capacity;
-        gc->exprs = REPLACE_LT(gc->lt, gc->exprs, new_exprs);
+        gc->exprs = REPLACE_LT_FRAME(gc->lt, gc->exprs_frame, new_exprs);
     }
 
+    int *color = expr_color(expr);
+    assert(color);
+
     gc->exprs[gc->size++] = expr;
+    gc->allocated++;
+    gc_count_expr(gc, expr, 1);
+
+    switch (gc->phase) {
+    case GC_PHASE_IDLE:
+        *color = GC_WHITE;
+        break;
+
+    case GC_PHASE_MARK:
+        *color = GC_WHITE;
+        gc_shade(gc, expr);
+        break;
+
+    case GC_PHASE_SWEEP:
+        *color = GC_BLACK;
+        break;
+    }
 
     return 0;
 }
 
-static long int gc_find_expr(Gc *gc, struct Expr expr)
+int gc_add_root(Gc *gc, struct Expr *root)
 {
     assert(gc);
-    (void) expr;
+    assert(root);
 
-    struct Expr *result =
-        (struct Expr *) bsearch(&expr, gc->exprs, gc->size,
-                                sizeof(struct Expr), compare_exprs);
+    if (gc->roots_size >= gc->roots_capacity) {
+        const size_t new_capacity = gc->roots_capacity * 2;
+        struct Expr **const new_roots = realloc(
+            gc->roots,
+            sizeof(struct Expr*) * new_capacity);
 
-    if (result == NULL) {
-        return -1;
+        if (new_roots == NULL) {
+            return -1;
+        }
+
+        gc->roots_capacity = new_capacity;
+        gc->roots = REPLACE_LT_FRAME(gc->lt, gc->roots_frame, new_roots);
     }
 
-    return (long int) (result - gc->exprs);
+    gc->roots[gc->roots_size++] = root;
+    gc_write_barrier(gc, *root);
+
+    return 0;
+}
+
+void gc_remove_root(Gc *gc, struct Expr *root)
+{
+    assert(gc);
+    assert(root);
+
+    for (size_t i = gc->roots_size; i > 0; --i) {
+        if (gc->roots[i - 1] == root) {
+            memmove(gc->roots + i - 1, gc->roots + i,
+                    sizeof(struct Expr*) * (gc->roots_size - i));
+            gc->roots_size--;
+            return;
+        }
+    }
 }
 
-static void gc_traverse_expr(Gc *gc, struct Expr root)
+size_t gc_handle_scope(const Gc *gc)
 {
     assert(gc);
-    const long int root_index = gc_find_expr(gc, root);
-    assert(root_index >= 0);
+    return gc->handles_size;
+}
 
-    if (gc->visited[root_index]) {
-        return;
+int gc_push_handle(Gc *gc, struct Expr expr)
+{
+    assert(gc);
+
+    if (gc->handles_size >= gc->handles_capacity) {
+        const size_t new_capacity = gc->handles_capacity * 2;
+        struct Expr *const new_handles = realloc(
+            gc->handles,
+            sizeof(struct Expr) * new_capacity);
+
+        if (new_handles == NULL) {
+            return -1;
+        }
+
+        gc->handles_capacity = new_capacity;
+        gc->handles = REPLACE_LT_FRAME(gc->lt, gc->handles_frame, new_handles);
+    }
+
+    gc->handles[gc->handles_size++] = expr;
+    gc_write_barrier(gc, expr);
+
+    return 0;
+}
+
+void gc_pop_handle_scope(Gc *gc, size_t scope)
+{
+    assert(gc);
+    assert(scope <= gc->handles_size);
+
+    gc->handles_size = scope;
+}
+
+void gc_write_barrier(Gc *gc, struct Expr value)
+{
+    assert(gc);
+
+    if (gc->phase == GC_PHASE_MARK) {
+        gc_shade(gc, value);
+    }
+}
+
+static void gc_record_pause(Gc *gc, int64_t begin_us)
+{
+    static const long int bounds[GC_PAUSE_BUCKETS - 1] = {
+        10, 50, 100, 500, 1000, 5000, 10000
+    };
+
+    const long int pause_us = (long int) (clock_now_us() - begin_us);
+
+    size_t bucket = 0;
+    while (bucket < GC_PAUSE_BUCKETS - 1 && pause_us >= bounds[bucket]) {
+        bucket++;
+    }
+
+    gc->stats.pauses[bucket]++;
+    if (pause_us > gc->stats.max_pause_us) {
+        gc->stats.max_pause_us = pause_us;
+    }
+}
+
+static int gc_shade_roots(Gc *gc)
+{
+    for (size_t i = 0; i < gc->roots_size; ++i) {
+        if (gc_shade(gc, *gc->roots[i]) < 0) {
+            return -1;
+        }
+    }
+
+    for (size_t i = 0; i < gc->handles_size; ++i) {
+        if (gc_shade(gc, gc->handles[i]) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void gc_start_sweep(Gc *gc)
+{
+    gc->phase = GC_PHASE_SWEEP;
+    gc->live = 0;
+    gc->sweep = 0;
+}
+
+/* Processes at most n objects of the current phase. Returns -1 if the
+ * mark phase had to be aborted. */
+static int gc_work(Gc *gc, size_t n)
+{
+    switch (gc->phase) {
+    case GC_PHASE_IDLE: {
+        gc->phase = GC_PHASE_MARK;
+        gc->gray_size = 0;
+        return gc_shade_roots(gc);
     }
 
-    if (cons_p(root)) {
-        gc_traverse_expr(gc, root.cons->car);
-        gc_traverse_expr(gc, root.cons->cdr);
+    case GC_PHASE_MARK: {
+        for (; n > 0 && gc->gray_size > 0; --n) {
+            struct Expr expr = gc->gray[--gc->gray_size];
+            *expr_color(expr) = GC_BLACK;
+
+            if (expr.type == EXPR_CONS) {
+                if (gc_shade(gc, expr.cons->car) < 0
+                    || gc_shade(gc, expr.cons->cdr) < 0) {
+                    return -1;
+                }
+            } else if (expr.type == EXPR_ATOM && expr.atom->type == ATOM_CLOSURE) {
+                if (gc_shade(gc, expr.atom->closure.params) < 0
+                    || gc_shade(gc, expr.atom->closure.body) < 0
+                    || gc_shade(gc, expr.atom->closure.env) < 0) {
+                    return -1;
+                }
+            }
+        }
+
+        if (gc->gray_size == 0) {
+            /* The roots could have changed since the beginning of the cycle */
+            if (gc_shade_roots(gc) < 0) {
+                return -1;
+            }
+
+            if (gc->gray_size == 0) {
+                gc_start_sweep(gc);
+            }
+        }
+    } break;
+
+    case GC_PHASE_SWEEP: {
+        for (; n > 0 && gc->sweep < gc->size; --n) {
+            struct Expr expr = gc->exprs[gc->sweep++];
+            int *color = expr_color(expr);
+
+            if (*color == GC_WHITE) {
+                gc_count_expr(gc, expr, -1);
+                destroy_expr(expr);
+            } else {
+                *color = GC_WHITE;
+                gc->exprs[gc->live++] = expr;
+            }
+        }
+
+        if (gc->sweep >= gc->size) {
+            gc->stats.collections++;
+            gc->size = gc->live;
+            gc->phase = GC_PHASE_IDLE;
+            gc->next_cycle = gc->size * 2 > GC_INITIAL_CAPACITY
+                ? gc->size * 2
+                : GC_INITIAL_CAPACITY;
+        }
+    } break;
     }
 
-    gc->visited[root_index] = 1;
+    return 0;
 }
 
-void gc_collect(Gc *gc, struct Expr root)
+int gc_step(Gc *gc, long int budget_us)
 {
     assert(gc);
-    (void) root;
 
-    /* Sort gc->exprs O(nlogn) */
-    qsort(gc->exprs, gc->size, sizeof(struct Expr), compare_exprs);
+    size_t debt = gc->allocated * GC_ALLOCATION_WORK_RATIO;
+    gc->allocated = 0;
 
-    /* Defragment O(n) */
-    while(gc->size > 0 && gc->exprs[gc->size - 1].type == EXPR_VOID) {
-        gc->size--;
+    if (gc->phase == GC_PHASE_IDLE && gc->size < gc->next_cycle) {
+        return 0;
     }
 
-    /* Initialize visited array O(n) */
-    memset(gc->visited, 0, sizeof(int) * gc->size);
+    const int64_t begin_us = clock_now_us();
+    const int64_t deadline_us = begin_us + budget_us;
+    int result = 0;
 
-    /* Traverse root O(nlogn)  */
-    gc_traverse_expr(gc, root);
+    do {
+        if (gc_work(gc, GC_STEP_GRANULARITY) < 0) {
+            result = -1;
+            break;
+        }
 
-    /* Dealloc unvisted O(n)   */
-    for (size_t i = 0; i < gc->size; ++i) {
-        if (!gc->visited[i]) {
-            destroy_expr(gc->exprs[i]);
-            gc->exprs[i] = void_expr();
+        if (gc->phase == GC_PHASE_IDLE) {
+            result = 1;
+            break;
         }
+
+        debt = debt > GC_STEP_GRANULARITY ? debt - GC_STEP_GRANULARITY : 0;
+    } while (debt > 0 || clock_now_us() < deadline_us);
+
+    gc->stats.steps++;
+    gc_record_pause(gc, begin_us);
+
+    return result;
+}
+
+void gc_collect(Gc *gc)
+{
+    assert(gc);
+
+    /* Objects that died after the current cycle had started survive
+     * it, so the cycle in progress is finished first and then a fresh
+     * one is run from the beginning */
+    const int64_t begin_us = clock_now_us();
+
+    for (int cycles = gc->phase == GC_PHASE_IDLE ? 1 : 2; cycles > 0; --cycles) {
+        do {
+            if (gc_work(gc, gc->size + 1) < 0) {
+                /* Not enough memory to finish the mark phase. Nothing
+                 * is deallocated, so reachable objects are not lost. */
+                cycles = 0;
+                break;
+            }
+        } while (gc->phase != GC_PHASE_IDLE);
     }
+
+    gc->allocated = 0;
+    gc->stats.steps++;
+    gc_record_pause(gc, begin_us);
+}
+
+struct Expr gc_nil(const Gc *gc)
+{
+    assert(gc);
+    return gc->nil;
+}
+
+struct Expr gc_t(const Gc *gc)
+{
+    assert(gc);
+    return gc->t;
+}
+
+void gc_stats(const Gc *gc, struct GcStats *stats)
+{
+    assert(gc);
+    assert(stats);
+
+    *stats = gc->stats;
+    stats->slots = gc->size;
+    stats->slots_capacity = gc->capacity;
 }
 
 void gc_inspect(const Gc *gc)
 {
+    static const char colors[] = {
+        [GC_WHITE] = '.',
+        [GC_GRAY] = '*',
+        [GC_BLACK] = '+'
+    };
+
     for (size_t i = 0; i < gc->size; ++i) {
-        if (gc->exprs[i].type == EXPR_VOID) {
-            printf(".");
+        if (gc->phase == GC_PHASE_SWEEP && gc->live <= i && i < gc->sweep) {
+            printf(" ");
         } else {
-            printf("+");
+            printf("%c", colors[*expr_color(gc->exprs[i])]);
         }
     }
     printf("\n");
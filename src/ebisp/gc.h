@@ -3,13 +3,84 @@
 
 #include "expr.h"
 
+struct Source;
+
 typedef struct Gc Gc;
 
+// Upper bounds of the buckets are 10us, 50us, 100us, 500us, 1ms,
+// 5ms, 10ms and infinity
+#define GC_PAUSE_BUCKETS 8
+
+struct GcStats
+{
+    // Objects on the heap, including the garbage that is not
+    // collected yet
+    size_t conses;
+    size_t symbols;
+    size_t strings;
+    size_t natives;
+    size_t closures;
+    size_t bytes_live;
+    // Total amount of bytes allocated since the creation of the Gc
+    size_t bytes_allocated;
+    // Total amount of objects allocated since the creation of the Gc
+    size_t objects_allocated;
+    size_t collections;         // Completed cycles
+    size_t steps;               // Calls of gc_step and gc_collect
+    size_t pauses[GC_PAUSE_BUCKETS];
+    long int max_pause_us;
+    // The object table is compacted by every sweep, so the slack of
+    // the table is the only fragmentation the Gc is responsible for
+    size_t slots;
+    size_t slots_capacity;
+};
+
 Gc *create_gc(void);
 void destroy_gc(Gc *gc);
 
+// The nil and t symbols of the Gc. They are created together with
+// the Gc and never collected, so NIL() and T() do not allocate.
+struct Expr gc_nil(const Gc *gc);
+struct Expr gc_t(const Gc *gc);
+
 int gc_add_expr(Gc *gc, struct Expr expr);
-void gc_collect(Gc *gc, struct Expr root);
+// Gc takes the ownership of the source and destroys it in destroy_gc()
+int gc_add_source(Gc *gc, struct Source *source);
+// Persistent roots are locations that are read at every collection,
+// like the expr of a Scope. The location must stay valid until it is
+// removed or the Gc is destroyed.
+int gc_add_root(Gc *gc, struct Expr *root);
+void gc_remove_root(Gc *gc, struct Expr *root);
+
+// Handles protect temporary values held by native code:
+//
+//     size_t handles = gc_handle_scope(gc);
+//     gc_push_handle(gc, value);
+//     ...
+//     gc_pop_handle_scope(gc, handles);
+size_t gc_handle_scope(const Gc *gc);
+int gc_push_handle(Gc *gc, struct Expr expr);
+void gc_pop_handle_scope(Gc *gc, size_t scope);
+
+// Stores of references into already existing objects must go
+// through the write barrier while a collection is in progress.
+void gc_write_barrier(Gc *gc, struct Expr value);
+
+// Full stop-the-world collection
+void gc_collect(Gc *gc);
+// Does some incremental collection work within budget_us microseconds.
+// A new cycle is started only after the amount of objects doubles
+// since the previous one. The budget is exceeded when the scripts
+// allocate faster than it allows to collect: every step processes at
+// least a couple of objects per object allocated since the previous
+// step. Returns 1 when a collection cycle was completed, 0 if the
+// cycle is still in progress and -1 if it had to be aborted.
+//
+// The Gc only knows about the roots, the handles and the references
+// between objects, so neither function may be called while an eval
+// is in progress.
+int gc_step(Gc *gc, long int budget_us);
+void gc_stats(const Gc *gc, struct GcStats *stats);
 void gc_inspect(const Gc *gc);
 
 #endif  // GC_H_
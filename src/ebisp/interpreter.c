@@ -1,11 +1,12 @@
 #include <assert.h>
-#include <math.h>
 #include <string.h>
 
 #include "./builtins.h"
 #include "./expr.h"
+#include "./gc.h"
 #include "./interpreter.h"
 #include "./scope.h"
+#include "system/clock.h"
 
 struct EvalResult eval_success(struct Expr expr)
 {
@@ -27,31 +28,19 @@ struct EvalResult eval_failure(struct Expr error)
     return result;
 }
 
-static struct EvalResult length(Gc *gc, struct Expr obj)
-{
-    if (!list_p(obj)) {
-        return eval_failure(list(gc, 3,
-                                 SYMBOL(gc, "wrong-argument-type"),
-                                 SYMBOL(gc, "listp"),
-                                 obj));
-    }
-
-    return eval_success(NUMBER(gc, length_of_list(obj)));
-}
-
 static struct EvalResult eval_atom(Gc *gc, struct Scope *scope, struct Atom *atom)
 {
     (void) scope;
     (void) gc;
 
     switch (atom->type) {
-    case ATOM_NUMBER:
     case ATOM_STRING:
     case ATOM_NATIVE:
+    case ATOM_CLOSURE:
         return eval_success(atom_as_expr(atom));
 
     case ATOM_SYMBOL: {
-        if (nil_p(atom_as_expr(atom))) {
+        if (nil_p(atom_as_expr(atom)) || atom_text_equal(atom, "t")) {
             return eval_success(atom_as_expr(atom));
         }
 
@@ -72,189 +61,636 @@ static struct EvalResult eval_atom(Gc *gc, struct Scope *scope, struct Atom *ato
                              atom_as_expr(atom)));
 }
 
-static struct EvalResult eval_all_args(Gc *gc, struct Scope *scope, struct Expr args)
+static struct EvalResult check_builtin_args(Gc *gc,
+                                            const struct Builtin *builtin,
+                                            struct Expr args)
 {
-    (void) scope;
-    (void) args;
+    if (!list_p(args)) {
+        return eval_failure(list(gc, 3,
+                                 SYMBOL(gc, "wrong-type-argument"),
+                                 SYMBOL(gc, "listp"),
+                                 args));
+    }
+
+    const long int n = length_of_list(args);
+
+    if (n < builtin->min_args || (builtin->max_args >= 0 && n > builtin->max_args)) {
+        return eval_failure(list(gc, 3,
+                                 SYMBOL(gc, "wrong-number-of-arguments"),
+                                 SYMBOL(gc, builtin->name),
+                                 NUMBER(gc, n)));
+    }
 
-    switch(args.type) {
-    case EXPR_ATOM:
-        return eval_atom(gc, scope, args.atom);
+    return eval_success(args);
+}
 
-    case EXPR_CONS: {
-        struct EvalResult car = eval(gc, scope, args.cons->car);
-        if (car.is_error) {
-            return car;
+static struct EvalResult check_let_bindings(Gc *gc, struct Expr bindings)
+{
+    for (struct Expr b = bindings; !nil_p(b); b = b.cons->cdr) {
+        if (!cons_p(b)) {
+            return eval_failure(list(gc, 3,
+                                     SYMBOL(gc, "wrong-type-argument"),
+                                     SYMBOL(gc, "listp"),
+                                     bindings));
         }
 
-        struct EvalResult cdr = eval_all_args(gc, scope, args.cons->cdr);
-        if (cdr.is_error) {
-            return cdr;
+        struct Expr binding = b.cons->car;
+
+        if (symbol_p(binding)) {
+            continue;
         }
 
-        return eval_success(cons_as_expr(create_cons(gc, car.expr, cdr.expr)));
+        if (!cons_p(binding)
+            || !symbol_p(binding.cons->car)
+            || !list_p(binding)
+            || length_of_list(binding) > 2) {
+            return eval_failure(CONS(gc,
+                                     SYMBOL(gc, "malformed-let-binding"),
+                                     binding));
+        }
     }
 
-    default: {}
-    }
+    return eval_success(bindings);
+}
 
-    return eval_failure(CONS(gc,
-                             SYMBOL(gc, "unexpected-expression"),
-                             args));
+/* The evaluator does not recurse on the C stack. Every pending
+ * computation is a frame on an explicit EvalStack:
+ *
+ * - EVAL_FRAME_ARGS collects the values of a funcall form one by one
+ *   and applies the callable once all of them are evaluated,
+ * - EVAL_FRAME_SET waits for the value of the `set` special form,
+ * - EVAL_FRAME_IF waits for the condition of the `if` special form,
+ * - EVAL_FRAME_LET collects the values of `let` bindings,
+ * - EVAL_FRAME_PROGN walks a sequence of forms except its last one,
+ * - EVAL_FRAME_RESTORE_SCOPE brings back the scope that was active
+ *   before a closure or a let was entered.
+ *
+ * A closure body is evaluated in a fresh frame on top of the scope the
+ * closure captured, not the scope of the caller. The last form of the
+ * body is evaluated right on top of the EVAL_FRAME_RESTORE_SCOPE of
+ * that call. If that form is a call of another closure, the frame is
+ * reused and the callee simply replaces the scope, so tail calls run
+ * in constant space. */
+
+#define EVAL_STACK_INITIAL_CAPACITY 64
+#define EVAL_STACK_MAX_CAPACITY (1024 * 1024)
+
+enum EvalFrameType
+{
+    EVAL_FRAME_ARGS = 0,
+    EVAL_FRAME_SET,
+    EVAL_FRAME_IF,
+    EVAL_FRAME_LET,
+    EVAL_FRAME_PROGN,
+    EVAL_FRAME_RESTORE_SCOPE
+};
+
+struct EvalFrame
+{
+    enum EvalFrameType type;
+    struct Expr forms;          /* ARGS, PROGN: forms left to evaluate.
+                                 * LET: bindings left to evaluate.
+                                 * IF: then and else forms.
+                                 * SET: name.
+                                 * RESTORE_SCOPE: scope to restore */
+    struct Expr body;           /* LET: body */
+    struct Cons *head;          /* ARGS: evaluated values. LET: evaluated bindings */
+    struct Cons *last;          /* ARGS, LET: last cons of head */
+    NativeFunction native;      /* ARGS: builtin to apply, NULL if head is the callable */
+    long int size;              /* ARGS: amount of values in head */
+};
+
+struct EvalStack
+{
+    struct EvalFrame *frames;
+    size_t size;
+    size_t capacity;
+    struct EvalFrame initial[EVAL_STACK_INITIAL_CAPACITY];
+};
+
+static void eval_stack_init(struct EvalStack *stack)
+{
+    assert(stack);
+
+    stack->frames = stack->initial;
+    stack->size = 0;
+    stack->capacity = EVAL_STACK_INITIAL_CAPACITY;
 }
 
-static struct EvalResult plus_op(Gc *gc, struct Expr args)
+static void eval_stack_free(struct EvalStack *stack)
 {
-    long int result = 0.0f;
+    assert(stack);
 
-    while (!nil_p(args)) {
-        if (args.type != EXPR_CONS) {
-            return eval_failure(CONS(gc,
-                                     SYMBOL(gc, "expected-cons"),
-                                     args));
+    if (stack->frames != stack->initial) {
+        free(stack->frames);
+    }
+}
+
+static struct EvalFrame *eval_stack_push(struct EvalStack *stack,
+                                         enum EvalFrameType type,
+                                         struct Expr forms)
+{
+    assert(stack);
+
+    if (stack->size >= stack->capacity) {
+        if (stack->capacity >= EVAL_STACK_MAX_CAPACITY) {
+            return NULL;
         }
 
-        if (args.cons->car.type != EXPR_ATOM ||
-            args.cons->car.atom->type != ATOM_NUMBER) {
-            return eval_failure(CONS(gc,
-                                     SYMBOL(gc, "expected-number"),
-                                     args.cons->car));
+        const size_t new_capacity = stack->capacity * 2;
+        struct EvalFrame *new_frames = NULL;
+
+        if (stack->frames == stack->initial) {
+            new_frames = malloc(sizeof(struct EvalFrame) * new_capacity);
+            if (new_frames != NULL) {
+                memcpy(new_frames, stack->initial, sizeof(struct EvalFrame) * stack->size);
+            }
+        } else {
+            new_frames = realloc(stack->frames, sizeof(struct EvalFrame) * new_capacity);
+        }
+
+        if (new_frames == NULL) {
+            return NULL;
         }
 
-        result += args.cons->car.atom->num;
-        args = args.cons->cdr;
+        stack->frames = new_frames;
+        stack->capacity = new_capacity;
     }
 
-    return eval_success(atom_as_expr(create_number_atom(gc, result)));
+    struct EvalFrame *frame = &stack->frames[stack->size++];
+    frame->type = type;
+    frame->forms = forms;
+    frame->body = void_expr();
+    frame->head = NULL;
+    frame->last = NULL;
+    frame->native = NULL;
+    frame->size = 0;
+
+    return frame;
 }
 
-static struct EvalResult call_lambda(Gc *gc,
-                                     struct Scope *scope,
-                                     struct Expr lambda,
-                                     struct Expr args) {
-    if (!lambda_p(lambda)) {
-        return eval_failure(CONS(gc,
-                                 SYMBOL(gc, "expected-callable"),
-                                 lambda));
-    }
+static struct EvalFrame *eval_stack_top(struct EvalStack *stack)
+{
+    assert(stack);
+    return stack->size > 0 ? &stack->frames[stack->size - 1] : NULL;
+}
 
-    if (!list_p(args)) {
-        return eval_failure(CONS(gc,
-                                 SYMBOL(gc, "expected-list"),
-                                 args));
+static void eval_frame_append(Gc *gc, struct EvalFrame *frame, struct Expr value)
+{
+    assert(frame);
+
+    struct Cons *cons = create_cons(gc, value, NIL(gc));
+    if (frame->last == NULL) {
+        frame->head = cons;
+    } else {
+        frame->last->cdr = cons_as_expr(cons);
+        gc_write_barrier(gc, frame->last->cdr);
     }
+    frame->last = cons;
+}
 
-    struct Expr vars = lambda.cons->cdr.cons->car;
-
-    if (length_of_list(args) != length_of_list(vars)) {
-        return eval_failure(CONS(gc,
-                                 SYMBOL(gc, "wrong-number-of-arguments"),
-                                 NUMBER(gc, length_of_list(args))));
+/* Makes sure that the current scope is restored when the current
+ * computation finishes. Reuses the EVAL_FRAME_RESTORE_SCOPE of the
+ * enclosing closure or let if the computation is in a tail position. */
+static int eval_stack_enter_scope(struct EvalStack *stack, const struct Scope *scope)
+{
+    struct EvalFrame *top = eval_stack_top(stack);
+    if (top != NULL && top->type == EVAL_FRAME_RESTORE_SCOPE) {
+        return 0;
     }
 
-    push_scope_frame(gc, scope, vars, args);
-    struct Expr body = lambda.cons->cdr.cons->cdr;
+    if (eval_stack_push(stack, EVAL_FRAME_RESTORE_SCOPE, scope->expr) == NULL) {
+        return -1;
+    }
 
-    struct EvalResult result = eval_success(NIL(gc));
+    return 0;
+}
 
-    while (!nil_p(body)) {
-        result = eval(gc, scope, body.cons->car);
-        if (result.is_error) {
-            return result;
-        }
-        body = body.cons->cdr;
-    }
+static struct EvalResult eval_stack_overflow(Gc *gc, struct Expr expr)
+{
+    return eval_failure(CONS(gc,
+                             SYMBOL(gc, "stack-overflow"),
+                             expr));
+}
 
-    pop_scope_frame(gc, scope);
+/* The clock and the Gc are consulted only once per that many steps */
+#define EVAL_BUDGET_CHECK_INTERVAL 64
 
-    return result;
+static size_t eval_allocations(const Gc *gc)
+{
+    struct GcStats stats;
+    gc_stats(gc, &stats);
+    return stats.objects_allocated;
 }
 
-static struct EvalResult call_callable(Gc *gc,
-                                       struct Scope *scope,
-                                       struct Expr callable,
-                                       struct Expr args) {
-    if (callable.type == EXPR_ATOM && callable.atom->type == ATOM_NATIVE) {
-        return ((NativeFunction)callable.atom->native.fun)(callable.atom->native.param, gc, scope, args);
-    }
+static struct EvalResult eval_budget_exceeded(Gc *gc, const char *resource, long int limit)
+{
+    return eval_failure(list(gc, 3,
+                             SYMBOL(gc, "budget-exceeded"),
+                             SYMBOL(gc, resource),
+                             NUMBER(gc, limit)));
+}
 
-    return call_lambda(gc, scope, callable, args);
+struct EvalResult eval(Gc *gc, struct Scope *scope, struct Expr expr)
+{
+    return eval_with_budget(gc, scope, expr, NULL, NULL);
 }
 
-static struct EvalResult eval_funcall(Gc *gc, struct Scope *scope, struct Cons *cons)
+struct EvalResult eval_with_budget(Gc *gc, struct Scope *scope, struct Expr expr,
+                                   const struct EvalBudget *budget,
+                                   struct EvalUsage *usage)
 {
-    assert(cons);
-    (void) scope;
+    struct EvalStack stack;
+    eval_stack_init(&stack);
 
-    if (symbol_p(cons->car)) {
-        if (strcmp(cons->car.atom->sym, "+") == 0) {
-            struct EvalResult args = eval_all_args(gc, scope, cons->cdr);
-            if (args.is_error) {
-                return args;
+    struct EvalResult result = eval_success(void_expr());
+    struct Expr value = void_expr();
+    bool returning = false;
+
+    const bool metered = budget != NULL || usage != NULL;
+    const int64_t begin_us = metered ? clock_now_us() : 0;
+    const size_t begin_allocations = metered ? eval_allocations(gc) : 0;
+    long int steps = 0;
+
+    while (true) {
+        steps++;
+
+        if (budget != NULL) {
+            if (budget->max_steps > 0 && steps > budget->max_steps) {
+                result = eval_budget_exceeded(gc, "steps", budget->max_steps);
+                goto unwind;
+            }
+
+            if (steps % EVAL_BUDGET_CHECK_INTERVAL == 0) {
+                if (budget->max_allocations > 0
+                    && eval_allocations(gc) - begin_allocations > budget->max_allocations) {
+                    result = eval_budget_exceeded(gc, "allocations", (long int) budget->max_allocations);
+                    goto unwind;
+                }
+
+                if (budget->max_time_us > 0
+                    && clock_now_us() - begin_us > budget->max_time_us) {
+                    result = eval_budget_exceeded(gc, "time", budget->max_time_us);
+                    goto unwind;
+                }
+            }
+        }
+
+        if (!returning) {
+            if (expr.type == EXPR_ATOM) {
+                result = eval_atom(gc, scope, expr.atom);
+                if (result.is_error) {
+                    goto unwind;
+                }
+                value = result.expr;
+                returning = true;
+                continue;
             }
-            return plus_op(gc, args.expr);
-        } else if (strcmp(cons->car.atom->sym, "set") == 0) {
-            struct Expr args = cons->cdr;
-            struct EvalResult n = length(gc, args);
 
-            if (n.is_error) {
-                return n;
+            if (number_p(expr)) {
+                value = expr;
+                returning = true;
+                continue;
             }
 
-            if (n.expr.atom->num != 2) {
-                return eval_failure(list(gc, 3,
-                                         SYMBOL(gc, "wrong-number-of-arguments"),
-                                         SYMBOL(gc, "set"),
-                                         NUMBER(gc, n.expr.atom->num)));
+            if (expr.type != EXPR_CONS) {
+                result = eval_failure(CONS(gc,
+                                           SYMBOL(gc, "unexpected-expression"),
+                                           expr));
+                goto unwind;
             }
 
-            struct Expr name = args.cons->car;
-            if (!symbol_p(name)) {
-                return eval_failure(list(gc, 3,
-                                         SYMBOL(gc, "wrong-type-argument"),
-                                         SYMBOL(gc, "symbolp"),
-                                         name));
+            struct Cons *cons = expr.cons;
+            struct Expr args = cons->cdr;
+            NativeFunction native = NULL;
+            const enum BuiltinId id = symbol_p(cons->car)
+                ? symbol_builtin(cons->car.atom)
+                : BUILTIN_NONE;
+
+            if (id != BUILTIN_NONE) {
+                const struct Builtin *builtin = builtin_by_id(id);
+
+                result = check_builtin_args(gc, builtin, args);
+                if (result.is_error) {
+                    goto unwind;
+                }
+
+                native = builtin->fun;
             }
 
-            struct EvalResult value = eval(gc, scope, args.cons->cdr.cons->car);
-            if (value.is_error) {
-                return value;
+            /* Evaluation never produces EXPR_VOID, so it marks the frames
+             * that have not received any values yet */
+            switch (id) {
+            case BUILTIN_QUOTE: {
+                value = args.cons->car;
+                returning = true;
+            } continue;
+
+            case BUILTIN_LAMBDA: {
+                if (!list_of_symbols_p(args.cons->car)) {
+                    result = eval_failure(list(gc, 3,
+                                               SYMBOL(gc, "wrong-type-argument"),
+                                               SYMBOL(gc, "list-of-symbols-p"),
+                                               args.cons->car));
+                    goto unwind;
+                }
+
+                value = CLOSURE(gc, args.cons->car, args.cons->cdr, scope->expr);
+                returning = true;
+            } continue;
+
+            case BUILTIN_SET: {
+                struct Expr name = args.cons->car;
+                if (!symbol_p(name)) {
+                    result = eval_failure(list(gc, 3,
+                                               SYMBOL(gc, "wrong-type-argument"),
+                                               SYMBOL(gc, "symbolp"),
+                                               name));
+                    goto unwind;
+                }
+
+                if (eval_stack_push(&stack, EVAL_FRAME_SET, name) == NULL) {
+                    result = eval_stack_overflow(gc, expr);
+                    goto unwind;
+                }
+
+                expr = args.cons->cdr.cons->car;
+            } continue;
+
+            case BUILTIN_IF: {
+                if (eval_stack_push(&stack, EVAL_FRAME_IF, args.cons->cdr) == NULL) {
+                    result = eval_stack_overflow(gc, expr);
+                    goto unwind;
+                }
+
+                expr = args.cons->car;
+            } continue;
+
+            case BUILTIN_LET: {
+                result = check_let_bindings(gc, args.cons->car);
+                if (result.is_error) {
+                    goto unwind;
+                }
+
+                struct EvalFrame *frame = eval_stack_push(&stack, EVAL_FRAME_LET, args.cons->car);
+                if (frame == NULL) {
+                    result = eval_stack_overflow(gc, expr);
+                    goto unwind;
+                }
+                frame->body = args.cons->cdr;
+
+                value = void_expr();
+                returning = true;
+            } continue;
+
+            case BUILTIN_PROGN: {
+                if (eval_stack_push(&stack, EVAL_FRAME_PROGN, args) == NULL) {
+                    result = eval_stack_overflow(gc, expr);
+                    goto unwind;
+                }
+
+                value = args;
+                returning = true;
+            } continue;
+
+            default: {}
             }
 
-            set_scope_value(gc, scope, name, value.expr);
+            struct EvalFrame *frame = eval_stack_push(
+                &stack,
+                EVAL_FRAME_ARGS,
+                native == NULL ? expr : args);
+            if (frame == NULL) {
+                result = eval_stack_overflow(gc, expr);
+                goto unwind;
+            }
+            frame->native = native;
 
-            return eval_success(value.expr);
-        } else if (strcmp(cons->car.atom->sym, "quote") == 0) {
-            /* TODO(#334): quote does not check the amout of it's arguments */
-            return eval_success(cons->cdr.cons->car);
-        } else if (strcmp(cons->car.atom->sym, "lambda") == 0) {
-            /* TODO(#335): lambda special form doesn't check if it forms a callable object */
-            return eval_success(cons_as_expr(cons));
+            value = void_expr();
+            returning = true;
+            continue;
         }
-    }
 
-    struct EvalResult r = eval_all_args(gc, scope, cons_as_expr(cons));
+        struct EvalFrame *frame = eval_stack_top(&stack);
+        if (frame == NULL) {
+            break;
+        }
+
+        switch (frame->type) {
+        case EVAL_FRAME_ARGS: {
+            if (value.type != EXPR_VOID) {
+                eval_frame_append(gc, frame, value);
+                frame->size++;
+            }
+
+            if (cons_p(frame->forms)) {
+                expr = frame->forms.cons->car;
+                frame->forms = frame->forms.cons->cdr;
+                returning = false;
+                continue;
+            }
+
+            const bool dotted = !nil_p(frame->forms);
+
+            if (dotted) {
+                if (frame->last == NULL
+                    || (frame->forms.type != EXPR_ATOM && !number_p(frame->forms))) {
+                    result = eval_failure(CONS(gc,
+                                               SYMBOL(gc, "unexpected-expression"),
+                                               frame->forms));
+                    goto unwind;
+                }
+
+                result = frame->forms.type == EXPR_ATOM
+                    ? eval_atom(gc, scope, frame->forms.atom)
+                    : eval_success(frame->forms);
+                if (result.is_error) {
+                    goto unwind;
+                }
+
+                frame->last->cdr = result.expr;
+                gc_write_barrier(gc, result.expr);
+            }
+
+            struct Expr values = frame->head == NULL ? NIL(gc) : cons_as_expr(frame->head);
+            NativeFunction native = frame->native;
+            const long int size = frame->size;
+            stack.size--;
+
+            struct Expr callable = void_expr();
+            struct Expr args = values;
+
+            if (native == NULL) {
+                callable = values.cons->car;
+                args = values.cons->cdr;
+
+                if (callable.type == EXPR_ATOM && callable.atom->type == ATOM_NATIVE) {
+                    native = callable.atom->native.fun;
+                }
+            }
+
+            if (native != NULL) {
+                void *param = callable.type == EXPR_ATOM ? callable.atom->native.param : NULL;
+                result = native(param, gc, scope, args);
+                if (result.is_error) {
+                    goto unwind;
+                }
+                value = result.expr;
+                continue;
+            }
+
+            if (callable.type != EXPR_ATOM || callable.atom->type != ATOM_CLOSURE) {
+                result = eval_failure(CONS(gc,
+                                           SYMBOL(gc, "expected-callable"),
+                                           callable));
+                goto unwind;
+            }
+
+            if (dotted) {
+                result = eval_failure(CONS(gc,
+                                           SYMBOL(gc, "expected-list"),
+                                           args));
+                goto unwind;
+            }
+
+            const struct Closure *closure = &callable.atom->closure;
+
+            /* The callable itself is the first value */
+            if (size - 1 != closure->arity) {
+                result = eval_failure(CONS(gc,
+                                           SYMBOL(gc, "wrong-number-of-arguments"),
+                                           NUMBER(gc, size - 1)));
+                goto unwind;
+            }
 
-    if (r.is_error) {
-        return r;
+            /* In a tail position the scope of the caller is not
+             * needed anymore and is simply replaced */
+            if (eval_stack_enter_scope(&stack, scope) < 0) {
+                result = eval_stack_overflow(gc, callable);
+                goto unwind;
+            }
+
+            scope->expr = closure->env;
+            push_scope_frame(gc, scope, closure->params, args);
+
+            struct Expr body = closure->body;
+            if (eval_stack_push(&stack, EVAL_FRAME_PROGN, body) == NULL) {
+                result = eval_stack_overflow(gc, callable);
+                goto unwind;
+            }
+            value = body;
+        } break;
+
+        case EVAL_FRAME_SET: {
+            set_scope_value(gc, scope, frame->forms, value);
+            stack.size--;
+        } break;
+
+        case EVAL_FRAME_IF: {
+            struct Expr forms = frame->forms;
+            stack.size--;
+
+            if (!nil_p(value)) {
+                expr = forms.cons->car;
+                returning = false;
+                continue;
+            }
+
+            if (eval_stack_push(&stack, EVAL_FRAME_PROGN, forms.cons->cdr) == NULL) {
+                result = eval_stack_overflow(gc, forms);
+                goto unwind;
+            }
+            value = forms.cons->cdr;
+        } break;
+
+        case EVAL_FRAME_LET: {
+            if (value.type != EXPR_VOID) {
+                struct Expr binding = frame->forms.cons->car;
+                eval_frame_append(gc, frame, CONS(gc, binding.cons->car, value));
+                frame->forms = frame->forms.cons->cdr;
+            }
+
+            /* Bindings without a value are bound to nil right away */
+            while (cons_p(frame->forms)) {
+                struct Expr binding = frame->forms.cons->car;
+
+                if (cons_p(binding) && cons_p(binding.cons->cdr)) {
+                    break;
+                }
+
+                struct Expr name = symbol_p(binding) ? binding : binding.cons->car;
+                eval_frame_append(gc, frame, CONS(gc, name, NIL(gc)));
+                frame->forms = frame->forms.cons->cdr;
+            }
+
+            if (cons_p(frame->forms)) {
+                expr = frame->forms.cons->car.cons->cdr.cons->car;
+                returning = false;
+                continue;
+            }
+
+            struct Expr bindings = frame->head == NULL ? NIL(gc) : cons_as_expr(frame->head);
+            struct Expr body = frame->body;
+            stack.size--;
+
+            if (eval_stack_enter_scope(&stack, scope) < 0) {
+                result = eval_stack_overflow(gc, body);
+                goto unwind;
+            }
+
+            push_scope_alist(gc, scope, bindings);
+
+            if (eval_stack_push(&stack, EVAL_FRAME_PROGN, body) == NULL) {
+                result = eval_stack_overflow(gc, body);
+                goto unwind;
+            }
+            value = body;
+        } break;
+
+        case EVAL_FRAME_PROGN: {
+            if (!cons_p(frame->forms)) {
+                /* Empty sequence evaluates to nil */
+                stack.size--;
+                continue;
+            }
+
+            expr = frame->forms.cons->car;
+            if (cons_p(frame->forms.cons->cdr)) {
+                frame->forms = frame->forms.cons->cdr;
+            } else {
+                stack.size--;
+            }
+            returning = false;
+        } break;
+
+        case EVAL_FRAME_RESTORE_SCOPE: {
+            scope->expr = frame->forms;
+            stack.size--;
+        } break;
+        }
     }
 
-    return call_callable(gc, scope, r.expr.cons->car, r.expr.cons->cdr);
-}
+    eval_stack_free(&stack);
+    result = eval_success(value);
+    goto done;
 
-struct EvalResult eval(Gc *gc, struct Scope *scope, struct Expr expr)
-{
-    switch(expr.type) {
-    case EXPR_ATOM:
-        return eval_atom(gc, scope, expr.atom);
+unwind:
+    while (stack.size > 0) {
+        struct EvalFrame *frame = &stack.frames[--stack.size];
+
+        if (frame->type == EVAL_FRAME_RESTORE_SCOPE) {
+            scope->expr = frame->forms;
+        }
+    }
 
-    case EXPR_CONS:
-        return eval_funcall(gc, scope, expr.cons);
+    eval_stack_free(&stack);
 
-    default: {}
+done:
+    if (usage != NULL) {
+        usage->steps = steps;
+        usage->allocations = eval_allocations(gc) - begin_allocations;
+        usage->time_us = (long int) (clock_now_us() - begin_us);
     }
 
-    return eval_failure(CONS(gc,
-                             SYMBOL(gc, "unexpected-expression"),
-                             expr));
+    return result;
 }
@@ -13,6 +13,27 @@ struct Gc;
 struct EvalResult eval_success(struct Expr expr);
 struct EvalResult eval_failure(struct Expr expr);
 
+// Limits of a single eval invocation. Zero means no limit. An
+// invocation that exceeds any of them fails with
+// (budget-exceeded <steps|allocations|time> <limit>).
+struct EvalBudget
+{
+    long int max_steps;
+    size_t max_allocations;
+    long int max_time_us;
+};
+
+struct EvalUsage
+{
+    long int steps;
+    size_t allocations;
+    long int time_us;
+};
+
 struct EvalResult eval(Gc *gc, struct Scope *scope, struct Expr expr);
+// budget and usage can be NULL
+struct EvalResult eval_with_budget(Gc *gc, struct Scope *scope, struct Expr expr,
+                                   const struct EvalBudget *budget,
+                                   struct EvalUsage *usage);
 
 #endif  // INTERPRETER_H_
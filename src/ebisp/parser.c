@@ -8,21 +8,27 @@
 #include <inttypes.h>
 
 #include "ebisp/builtins.h"
+#include "ebisp/gc.h"
 #include "ebisp/parser.h"
-#include "system/lt.h"
-#include "system/lt/lt_adapters.h"
+#include "ebisp/source.h"
 
-#define MAX_BUFFER_LENGTH (5 * 1000 * 1000)
+/* Lists and quotes deeper than that are rejected instead of
+ * overflowing the C stack of the recursive descent */
+#define PARSER_MAX_DEPTH 1024
 
-static struct ParseResult parse_expr(Gc *gc, struct Token current_token);
+/* When borrow is true the parsed atoms reference the text of the
+ * input instead of copying it. Only used for the text of a Source
+ * owned by the Gc. depth is the amount of lists and quotes the
+ * expression is nested in. */
+static struct ParseResult parse_expr(Gc *gc, struct Token current_token, bool borrow, size_t depth);
 
-static struct ParseResult parse_cdr(Gc *gc, struct Token current_token)
+static struct ParseResult parse_cdr(Gc *gc, struct Token current_token, bool borrow, size_t depth)
 {
     if (*current_token.begin != '.') {
         return parse_failure("Expected .", current_token.begin);
     }
 
-    struct ParseResult cdr = read_expr_from_string(gc, current_token.end);
+    struct ParseResult cdr = parse_expr(gc, next_token(current_token.end), borrow, depth);
     if (cdr.is_error) {
         return cdr;
     }
@@ -46,7 +52,7 @@ static struct ParseResult parse_list_end(Gc *gc, struct Token current_token)
                          current_token.end);
 }
 
-static struct ParseResult parse_list(Gc *gc, struct Token current_token)
+static struct ParseResult parse_list(Gc *gc, struct Token current_token, bool borrow, size_t depth)
 {
     if (*current_token.begin != '(') {
         return parse_failure("Expected (", current_token.begin);
@@ -58,7 +64,7 @@ static struct ParseResult parse_list(Gc *gc, struct Token current_token)
         return parse_list_end(gc, current_token);
     }
 
-    struct ParseResult car = parse_expr(gc, current_token);
+    struct ParseResult car = parse_expr(gc, current_token, borrow, depth);
     if (car.is_error) {
         return car;
     }
@@ -70,19 +76,20 @@ static struct ParseResult parse_list(Gc *gc, struct Token current_token)
     while (*current_token.begin != '.' &&
            *current_token.begin != ')' &&
            *current_token.begin != 0) {
-        car = parse_expr(gc, current_token);
+        car = parse_expr(gc, current_token, borrow, depth);
         if (car.is_error) {
             return car;
         }
 
         cons->cdr = cons_as_expr(create_cons(gc, car.expr, void_expr()));
+        gc_write_barrier(gc, cons->cdr);
         cons = cons->cdr.cons;
 
         current_token = next_token(car.end);
     }
 
     struct ParseResult cdr = *current_token.begin == '.'
-        ? parse_cdr(gc, current_token)
+        ? parse_cdr(gc, current_token, borrow, depth)
         : parse_list_end(gc, current_token);
 
     if (cdr.is_error) {
@@ -90,11 +97,12 @@ static struct ParseResult parse_list(Gc *gc, struct Token current_token)
     }
 
     cons->cdr = cdr.expr;
+    gc_write_barrier(gc, cdr.expr);
 
     return parse_success(cons_as_expr(list), cdr.end);
 }
 
-static struct ParseResult parse_string(Gc *gc, struct Token current_token)
+static struct ParseResult parse_string(Gc *gc, struct Token current_token, bool borrow)
 {
     if (*current_token.begin != '"') {
         return parse_failure("Expected \"", current_token.begin);
@@ -109,49 +117,63 @@ static struct ParseResult parse_string(Gc *gc, struct Token current_token)
                              current_token.end);
     }
 
-    return parse_success(
-        atom_as_expr(
-            create_string_atom(gc, current_token.begin + 1, current_token.end - 1)),
-        current_token.end);
+    struct Atom *atom = borrow
+        ? create_string_slice_atom(gc, current_token.begin + 1, current_token.end - 1)
+        : create_string_atom(gc, current_token.begin + 1, current_token.end - 1);
+
+    return parse_success(atom_as_expr(atom), current_token.end);
 }
 
 static struct ParseResult parse_number(Gc *gc, struct Token current_token)
 {
+    (void) gc;
+
     char *endptr = 0;
     const long int x = strtoimax(current_token.begin, &endptr, 10);
 
-    if (current_token.begin == endptr || current_token.end != endptr) {
-        return parse_failure("Expected number", current_token.begin);
+    if (current_token.begin != endptr && current_token.end == endptr) {
+        return parse_success(NUMBER(gc, x), current_token.end);
+    }
+
+    const double y = strtod(current_token.begin, &endptr);
+
+    if (current_token.begin != endptr && current_token.end == endptr) {
+        return parse_success(REAL(gc, y), current_token.end);
     }
 
-    return parse_success(
-        atom_as_expr(create_number_atom(gc, x)),
-        current_token.end);
+    return parse_failure("Expected number", current_token.begin);
 }
 
-static struct ParseResult parse_symbol(Gc *gc, struct Token current_token)
+static struct ParseResult parse_symbol(Gc *gc, struct Token current_token, bool borrow)
 {
     if (*current_token.begin == 0) {
         return parse_failure("EOF", current_token.begin);
     }
 
-    return parse_success(
-        atom_as_expr(create_symbol_atom(gc, current_token.begin, current_token.end)),
-        current_token.end);
+    struct Atom *atom = borrow
+        ? create_symbol_slice_atom(gc, current_token.begin, current_token.end)
+        : create_symbol_atom(gc, current_token.begin, current_token.end);
+
+    return parse_success(atom_as_expr(atom), current_token.end);
 }
 
-static struct ParseResult parse_expr(Gc *gc, struct Token current_token)
+static struct ParseResult parse_expr(Gc *gc, struct Token current_token, bool borrow, size_t depth)
 {
     if (*current_token.begin == 0) {
         return parse_failure("EOF", current_token.begin);
     }
 
+    if ((*current_token.begin == '(' || *current_token.begin == '\'')
+        && depth >= PARSER_MAX_DEPTH) {
+        return parse_failure("Too deeply nested", current_token.begin);
+    }
+
     switch (*current_token.begin) {
-    case '(': return parse_list(gc, current_token);
+    case '(': return parse_list(gc, current_token, borrow, depth + 1);
     /* TODO(#292): parser does not support escaped string characters */
-    case '"': return parse_string(gc, current_token);
+    case '"': return parse_string(gc, current_token, borrow);
     case '\'': {
-        struct ParseResult result = parse_expr(gc, next_token(current_token.end));
+        struct ParseResult result = parse_expr(gc, next_token(current_token.end), borrow, depth + 1);
 
         if (result.is_error) {
             return result;
@@ -171,64 +193,95 @@ static struct ParseResult parse_expr(Gc *gc, struct Token current_token)
         }
     }
 
-    return parse_symbol(gc, current_token);
+    return parse_symbol(gc, current_token, borrow);
 }
 
 struct ParseResult read_expr_from_string(Gc *gc, const char *str)
 {
     assert(str);
-    return parse_expr(gc, next_token(str));
+    return parse_expr(gc, next_token(str), false, 0);
 }
 
-struct ParseResult read_expr_from_file(Gc *gc, const char *filename)
+static struct ParseResult read_source_from_file(Gc *gc, const char *filename)
 {
+    assert(gc);
     assert(filename);
 
-    Lt *lt = create_lt();
-    if (lt == NULL) {
-        return parse_failure("Could not create Lt object", NULL);
-    }
-
-    FILE *stream = PUSH_LT(lt, fopen(filename, "rb"), fclose_lt);
-    if (!stream) {
+    struct Source *source = create_source_from_file(filename);
+    if (source == NULL) {
         /* TODO(#307): ParseResult should not be used for reporting IO failures */
-        RETURN_LT(lt, parse_failure(strerror(errno), NULL));
+        return parse_failure(strerror(errno), NULL);
     }
 
-    if (fseek(stream, 0, SEEK_END) != 0) {
-        RETURN_LT(lt, parse_failure("Could not find the end of the file", NULL));
+    if (gc_add_source(gc, source) < 0) {
+        destroy_source(source);
+        return parse_failure(strerror(errno), NULL);
     }
 
-    const long int buffer_length = ftell(stream);
+    return parse_success(void_expr(), source_text(source));
+}
 
-    if (buffer_length < 0) {
-        RETURN_LT(lt, parse_failure("Couldn't get the size of file", NULL));
-    }
+struct ParseResult read_expr_from_file(Gc *gc, const char *filename)
+{
+    assert(filename);
 
-    if (buffer_length == 0) {
-        RETURN_LT(lt, parse_failure("File is empty", NULL));
+    struct ParseResult source = read_source_from_file(gc, filename);
+    if (source.is_error) {
+        return source;
     }
 
-    if (buffer_length >= MAX_BUFFER_LENGTH) {
-        RETURN_LT(lt, parse_failure("File is too big", NULL));
+    struct Token current_token = next_token(source.end);
+    if (*current_token.begin == 0) {
+        return parse_failure("File is empty", NULL);
     }
 
-    if (fseek(stream, 0, SEEK_SET) != 0) {
-        RETURN_LT(lt, parse_failure("Could not find the beginning of the file", NULL));
-    }
+    return parse_expr(gc, current_token, true, 0);
+}
 
-    char * const buffer = PUSH_LT(lt, malloc((size_t) buffer_length + 1), free);
-    if (buffer == NULL) {
-        RETURN_LT(lt, parse_failure(strerror(errno), NULL));
-    }
+static struct ParseResult read_all_exprs(Gc *gc, const char *str, bool borrow)
+{
+    struct Cons *head = NULL;
+    struct Cons *last = NULL;
+    struct Token current_token = next_token(str);
+
+    while (*current_token.begin != 0) {
+        struct ParseResult result = parse_expr(gc, current_token, borrow, 0);
+        if (result.is_error) {
+            return result;
+        }
+
+        struct Cons *cons = create_cons(gc, result.expr, NIL(gc));
+        if (last == NULL) {
+            head = cons;
+        } else {
+            last->cdr = cons_as_expr(cons);
+            gc_write_barrier(gc, last->cdr);
+        }
+        last = cons;
 
-    if (fread(buffer, 1, (size_t) buffer_length, stream) != (size_t) buffer_length) {
-        RETURN_LT(lt, parse_failure("Could not read the file", NULL));
+        current_token = next_token(result.end);
     }
 
-    struct ParseResult result = read_expr_from_string(gc, buffer);
+    return parse_success(head == NULL ? NIL(gc) : cons_as_expr(head),
+                         current_token.end);
+}
+
+struct ParseResult read_all_exprs_from_string(Gc *gc, const char *str)
+{
+    assert(str);
+    return read_all_exprs(gc, str, false);
+}
+
+struct ParseResult read_all_exprs_from_file(Gc *gc, const char *filename)
+{
+    assert(filename);
+
+    struct ParseResult source = read_source_from_file(gc, filename);
+    if (source.is_error) {
+        return source;
+    }
 
-    RETURN_LT(lt, result);
+    return read_all_exprs(gc, source.end, true);
 }
 
 struct ParseResult parse_success(struct Expr expr,
@@ -23,6 +23,11 @@ struct ParseResult parse_failure(const char *error,
 
 struct ParseResult read_expr_from_string(Gc *gc, const char *str);
 struct ParseResult read_expr_from_file(Gc *gc, const char *filename);
+struct ParseResult read_all_exprs_from_string(Gc *gc, const char *str);
+/* Reads every top-level form of the file into a list. The file is
+ * memory mapped and the symbols and strings of the result reference
+ * its text directly. The mapping is owned by the Gc. */
+struct ParseResult read_all_exprs_from_file(Gc *gc, const char *filename);
 
 void print_parse_error(FILE *stream,
                        const char *str,
@@ -1,10 +1,13 @@
 #include <assert.h>
 #include <stdbool.h>
+#include <string.h>
 
+#include "builtins.h"
 #include "parser.h"
 #include "interpreter.h"
 #include "scope.h"
 #include "gc.h"
+#include "system/clock.h"
 
 #define REPL_BUFFER_MAX 1024
 
@@ -45,12 +48,10 @@ static struct EvalResult get_scope(void *param, Gc *gc, struct Scope *scope, str
 static void eval_line(Gc *gc, Scope *scope, const char *line)
 {
     while (*line != 0) {
-        gc_collect(gc, scope->expr);
-
         struct ParseResult parse_result = read_expr_from_string(gc, line);
         if (parse_result.is_error) {
             print_parse_error(stderr, line, parse_result);
-            return;
+            break;
         }
 
         struct EvalResult eval_result = eval(gc, scope, parse_result.expr);
@@ -58,7 +59,7 @@ static void eval_line(Gc *gc, Scope *scope, const char *line)
             fprintf(stderr, "Error:\t");
             print_expr_as_sexpr(stderr, eval_result.expr);
             fprintf(stderr, "\n");
-            return;
+            break;
         }
 
         print_expr_as_sexpr(stderr, eval_result.expr);
@@ -66,12 +67,102 @@ static void eval_line(Gc *gc, Scope *scope, const char *line)
 
         line = next_token(parse_result.end).begin;
     }
+
+    gc_collect(gc);
+}
+
+/* Evaluates all of the top-level forms of the file `iterations` times.
+ * When bench is true reports the throughput of eval and the time spent
+ * in the Gc. */
+static int run_file(Gc *gc, Scope *scope, const char *filename, long int iterations, bool bench)
+{
+    struct ParseResult parse_result = read_all_exprs_from_file(gc, filename);
+    if (parse_result.is_error) {
+        fprintf(stderr, "%s: %s\n", filename, parse_result.error_message);
+        return -1;
+    }
+
+    struct Expr forms = parse_result.expr;
+    if (gc_push_handle(gc, forms) < 0) {
+        fprintf(stderr, "Could not protect the forms of %s\n", filename);
+        return -1;
+    }
+
+    long int eval_us = 0;
+    long int gc_us = 0;
+    long int evals = 0;
+
+    for (long int i = 0; i < iterations; ++i) {
+        const int64_t eval_begin = clock_now_us();
+
+        for (struct Expr form = forms; cons_p(form); form = CDR(form)) {
+            struct EvalResult eval_result = eval(gc, scope, CAR(form));
+            evals++;
+
+            if (eval_result.is_error) {
+                fprintf(stderr, "Error:\t");
+                print_expr_as_sexpr(stderr, eval_result.expr);
+                fprintf(stderr, "\n");
+                return -1;
+            }
+        }
+
+        const int64_t gc_begin = clock_now_us();
+        eval_us += (long int) (gc_begin - eval_begin);
+
+        gc_collect(gc);
+        gc_us += (long int) (clock_now_us() - gc_begin);
+    }
+
+    if (bench) {
+        struct GcStats stats;
+        gc_stats(gc, &stats);
+
+        printf("iterations: %ld\n", iterations);
+        printf("forms: %ld\n", length_of_list(forms));
+        printf("evals: %ld\n", evals);
+        printf("eval-time-us: %ld\n", eval_us);
+        printf("evals-per-second: %.1f\n",
+               eval_us > 0 ? (double) evals * 1e6 / (double) eval_us : 0.0);
+        printf("gc-time-us: %ld\n", gc_us);
+        printf("gc-max-pause-us: %ld\n", stats.max_pause_us);
+        printf("bytes-allocated: %zu\n", stats.bytes_allocated);
+        printf("bytes-live: %zu\n", stats.bytes_live);
+    }
+
+    return 0;
+}
+
+static void print_usage(FILE *stream, const char *program)
+{
+    fprintf(stream, "Usage: %s [--run <file.lisp> [--bench <N>]]\n", program);
 }
 
 int main(int argc, char *argv[])
 {
-    (void) argc;
-    (void) argv;
+    const char *run_filename = NULL;
+    long int bench_iterations = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--run") == 0 && i + 1 < argc) {
+            run_filename = argv[++i];
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            char *end = NULL;
+            bench_iterations = strtol(argv[++i], &end, 10);
+            if (*end != 0 || bench_iterations <= 0) {
+                print_usage(stderr, argv[0]);
+                return -1;
+            }
+        } else {
+            print_usage(stderr, argv[0]);
+            return -1;
+        }
+    }
+
+    if (bench_iterations > 0 && run_filename == NULL) {
+        print_usage(stderr, argv[0]);
+        return -1;
+    }
 
     char buffer[REPL_BUFFER_MAX + 1];
 
@@ -79,11 +170,20 @@ int main(int argc, char *argv[])
     struct Scope scope = {
         .expr = CONS(gc, NIL(gc), NIL(gc))
     };
+    gc_add_root(gc, &scope.expr);
 
     set_scope_value(gc, &scope, SYMBOL(gc, "quit"), NATIVE(gc, quit, NULL));
     set_scope_value(gc, &scope, SYMBOL(gc, "gc-inspect"), NATIVE(gc, gc_inspect_adapter, NULL));
     set_scope_value(gc, &scope, SYMBOL(gc, "scope"), NATIVE(gc, get_scope, NULL));
 
+    if (run_filename != NULL) {
+        const int result = run_file(gc, &scope, run_filename,
+                                    bench_iterations > 0 ? bench_iterations : 1,
+                                    bench_iterations > 0);
+        destroy_gc(gc);
+        return result < 0 ? 1 : 0;
+    }
+
     while (true) {
         printf("> ");
 
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include "./gc.h"
 #include "./scope.h"
 
 static struct Expr get_scope_value_impl(struct Expr scope, struct Expr name)
@@ -16,25 +17,6 @@ struct Expr get_scope_value(const struct Scope *scope, struct Expr name)
     return get_scope_value_impl(scope->expr, name);
 }
 
-static struct Expr set_scope_value_impl(Gc *gc, struct Expr scope, struct Expr name, struct Expr value)
-{
-    if (cons_p(scope)) {
-        if (!nil_p(assoc(name, scope.cons->car)) || nil_p(scope.cons->cdr)) {
-            return CONS(gc,
-                        CONS(gc, CONS(gc, name, value), scope.cons->car),
-                        scope.cons->cdr);
-        } else {
-            return CONS(gc,
-                        scope.cons->car,
-                        set_scope_value_impl(gc, scope.cons->cdr, name, value));
-        }
-    } else {
-        return CONS(gc,
-                    CONS(gc, CONS(gc, name, value), NIL(gc)),
-                    scope);
-    }
-}
-
 struct Scope create_scope(Gc *gc)
 {
     struct Scope scope = {
@@ -45,7 +27,28 @@ struct Scope create_scope(Gc *gc)
 
 void set_scope_value(Gc *gc, struct Scope *scope, struct Expr name, struct Expr value)
 {
-    scope->expr = set_scope_value_impl(gc, scope->expr, name, value);
+    gc_write_barrier(gc, value);
+
+    /* Bindings are updated in place, because closures share the
+     * frames of the scope they were created in and have to see the
+     * new values. */
+    struct Expr binding = get_scope_value(scope, name);
+    if (!nil_p(binding)) {
+        binding.cons->cdr = value;
+        return;
+    }
+
+    if (!cons_p(scope->expr)) {
+        scope->expr = CONS(gc, NIL(gc), scope->expr);
+    }
+
+    /* Unbound variables are defined in the outermost frame */
+    struct Expr global = scope->expr;
+    while (cons_p(global.cons->cdr)) {
+        global = global.cons->cdr;
+    }
+
+    global.cons->car = CONS(gc, CONS(gc, name, value), global.cons->car);
 }
 
 void push_scope_frame(Gc *gc, struct Scope *scope, struct Expr vars, struct Expr args)
@@ -66,6 +69,14 @@ void push_scope_frame(Gc *gc, struct Scope *scope, struct Expr vars, struct Expr
     scope->expr = CONS(gc, frame, scope->expr);
 }
 
+void push_scope_alist(Gc *gc, struct Scope *scope, struct Expr alist)
+{
+    assert(gc);
+    assert(scope);
+
+    scope->expr = CONS(gc, alist, scope->expr);
+}
+
 void pop_scope_frame(Gc *gc, struct Scope *scope)
 {
     assert(gc);
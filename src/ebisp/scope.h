@@ -19,6 +19,7 @@ struct Scope create_scope(Gc *gc);
 struct Expr get_scope_value(const struct Scope *scope, struct Expr name);
 void set_scope_value(Gc *gc, struct Scope *scope, struct Expr name, struct Expr value);
 void push_scope_frame(Gc *gc, struct Scope *scope, struct Expr vars, struct Expr args);
+void push_scope_alist(Gc *gc, struct Scope *scope, struct Expr alist);
 void pop_scope_frame(Gc *gc, struct Scope *scope);
 
 #endif  // SCOPE_H_
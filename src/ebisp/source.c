@@ -0,0 +1,189 @@
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <stdio.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "./source.h"
+#include "system/error.h"
+#include "system/lt.h"
+
+struct Source
+{
+    Lt *lt;
+    char *text;
+    size_t size;
+    size_t mapped_size;
+};
+
+#ifdef _WIN32
+
+/* There is no mmap, so the file is read into a buffer with one extra
+ * byte for the NUL terminator */
+static int source_load(struct Source *source, const char *filename)
+{
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    long int file_size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        file_size = ftell(file);
+    }
+
+    if (file_size < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        fclose(file);
+        return -1;
+    }
+
+    source->size = (size_t) file_size;
+    source->mapped_size = source->size + 1;
+    source->text = malloc(source->mapped_size);
+    if (source->text == NULL
+        || fread(source->text, 1, source->size, file) != source->size) {
+        throw_error(ERROR_TYPE_LIBC);
+        free(source->text);
+        fclose(file);
+        return -1;
+    }
+    source->text[source->size] = 0;
+
+    fclose(file);
+
+    return 0;
+}
+
+static void source_unload(struct Source *source)
+{
+    free(source->text);
+}
+
+#else
+
+static void close_fd_lt(void *fd)
+{
+    close(*(int*) fd);
+}
+
+static int source_load(struct Source *source, const char *filename)
+{
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+    PUSH_LT(lt, &fd, close_fd_lt);
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) < 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    const long int page_size = sysconf(_SC_PAGESIZE);
+    if (page_size <= 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    source->size = (size_t) file_stat.st_size;
+    /* At least one extra byte past the end of the file, rounded up to
+     * whole pages */
+    source->mapped_size =
+        (source->size / (size_t) page_size + 1) * (size_t) page_size;
+
+    /* Reserving zero filled anonymous pages first and mapping the file
+     * on top of them guarantees the NUL terminator even when the size
+     * of the file is a multiple of the page size */
+    char *text = mmap(NULL, source->mapped_size,
+                      PROT_READ,
+                      MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1, 0);
+    if (text == MAP_FAILED) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    if (source->size > 0) {
+        if (mmap(text, source->size,
+                 PROT_READ,
+                 MAP_PRIVATE | MAP_FIXED,
+                 fd, 0) == MAP_FAILED) {
+            throw_error(ERROR_TYPE_LIBC);
+            munmap(text, source->mapped_size);
+            RETURN_LT(lt, -1);
+        }
+    }
+
+    source->text = text;
+
+    /* The mapping stays valid after the file is closed */
+    RETURN_LT(lt, 0);
+}
+
+static void source_unload(struct Source *source)
+{
+    munmap(source->text, source->mapped_size);
+}
+
+#endif
+
+struct Source *create_source_from_file(const char *filename)
+{
+    assert(filename);
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return NULL;
+    }
+
+    struct Source *source = PUSH_LT(lt, malloc(sizeof(struct Source)), free);
+    if (source == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+    source->lt = lt;
+
+    if (source_load(source, filename) < 0) {
+        RETURN_LT(lt, NULL);
+    }
+
+    return source;
+}
+
+void destroy_source(struct Source *source)
+{
+    assert(source);
+
+    source_unload(source);
+
+    RETURN_LT0(source->lt);
+}
+
+const char *source_text(const struct Source *source)
+{
+    assert(source);
+    return source->text;
+}
+
+size_t source_size(const struct Source *source)
+{
+    assert(source);
+    return source->size;
+}
@@ -0,0 +1,23 @@
+#ifndef SOURCE_H_
+#define SOURCE_H_
+
+#include <stddef.h>
+
+// Source is a read-only memory mapped file with the script text. On
+// Windows the file is read into memory instead.
+// The text is always followed by a NUL byte so the tokenizer can
+// walk it as a regular C string.
+//
+// Atoms parsed from a Source reference slices of its text instead of
+// copying them, so the Source must outlive all of them. Usually that
+// is achieved by handing the Source over to the Gc with gc_add_source().
+
+struct Source;
+
+struct Source *create_source_from_file(const char *filename);
+void destroy_source(struct Source *source);
+
+const char *source_text(const struct Source *source);
+size_t source_size(const struct Source *source);
+
+#endif  // SOURCE_H_
@@ -1,7 +1,7 @@
 #include <stdbool.h>
 #include <assert.h>
-#include <ctype.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "./tokenizer.h"
 
@@ -15,60 +15,63 @@ static struct Token token(const char *begin, const char *end)
     return token;
 }
 
-static bool is_symbol_char(char x)
+enum CharClass
 {
-    static const char forbidden_symbol_chars[] = {
-        '(', ')', '"', '\'', ';', '.'
-    };
-    static const size_t n = sizeof(forbidden_symbol_chars) / sizeof(char);
-
-    for (size_t i = 0; i < n; ++i) {
-        if (x == forbidden_symbol_chars[i] || isspace(x)) {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-static const char *skip_whitespace(const char *str)
+    CHAR_END = 1 << 0,          /* NUL terminator */
+    CHAR_SPACE = 1 << 1,
+    CHAR_DELIM = 1 << 2,        /* ( ) " ' ; */
+    CHAR_DOT = 1 << 3,
+    CHAR_DIGIT = 1 << 4
+};
+
+#define SYMBOL_STOP (CHAR_END | CHAR_SPACE | CHAR_DELIM | CHAR_DOT)
+#define NUMBER_STOP (CHAR_END | CHAR_SPACE | CHAR_DELIM)
+
+static const unsigned char char_class[256] = {
+    [0] = CHAR_END,
+    [' '] = CHAR_SPACE, ['\t'] = CHAR_SPACE, ['\n'] = CHAR_SPACE,
+    ['\v'] = CHAR_SPACE, ['\f'] = CHAR_SPACE, ['\r'] = CHAR_SPACE,
+    ['('] = CHAR_DELIM, [')'] = CHAR_DELIM, ['"'] = CHAR_DELIM,
+    ['\''] = CHAR_DELIM, [';'] = CHAR_DELIM,
+    ['.'] = CHAR_DOT,
+    ['0'] = CHAR_DIGIT, ['1'] = CHAR_DIGIT, ['2'] = CHAR_DIGIT,
+    ['3'] = CHAR_DIGIT, ['4'] = CHAR_DIGIT, ['5'] = CHAR_DIGIT,
+    ['6'] = CHAR_DIGIT, ['7'] = CHAR_DIGIT, ['8'] = CHAR_DIGIT,
+    ['9'] = CHAR_DIGIT
+};
+
+static inline unsigned char class_of(const char *str)
 {
-    assert(str);
-
-    while(*str != 0 && isspace(*str)) {
-        str++;
-    }
-
-    return str;
+    return char_class[(unsigned char) *str];
 }
 
-static const char *next_quote(const char *str)
+static const char *skip_whitespace(const char *str)
 {
     assert(str);
 
-    while(*str != 0 && *str != '"') {
+    while (class_of(str) & CHAR_SPACE) {
         str++;
     }
 
     return str;
 }
 
-static const char *skip_until_newline(const char *str)
+/* Quote and newline runs are usually long (strings and comments), so
+ * they are scanned with strchr which libc implements with vector
+ * instructions where available. */
+static const char *next_char(const char *str, char c)
 {
     assert(str);
 
-    while(*str != 0 && *str != '\n') {
-        str++;
-    }
-
-    return str;
+    const char *result = strchr(str, c);
+    return result != NULL ? result : str + strlen(str);
 }
 
-static const char *next_non_symbol(const char *str)
+static const char *next_stop(const char *str, unsigned char stop)
 {
     assert(str);
 
-    while(*str != 0 && is_symbol_char(*str)) {
+    while (!(class_of(str) & stop)) {
         str++;
     }
 
@@ -84,12 +87,15 @@ struct Token next_token(const char *str)
         return token(str, str);
     }
 
-    while (*str != 0 && *str == ';') {
-        str = skip_until_newline(str + 1);
+    while (*str == ';') {
+        str = next_char(str + 1, '\n');
         str = skip_whitespace(str);
     }
 
     switch (*str) {
+    case 0:
+        return token(str, str);
+
     case '(':
     case ')':
     case '.':
@@ -97,11 +103,16 @@ struct Token next_token(const char *str)
         return token(str, str + 1);
 
     case '"': {
-        const char *str_end = next_quote(str + 1);
+        const char *str_end = next_char(str + 1, '"');
         return token(str, *str_end == 0 ? str_end : str_end + 1);
     }
 
     default:
-        return token(str, next_non_symbol(str + 1));
+        if ((class_of(str) & CHAR_DIGIT)
+            || (*str == '-' && (class_of(str + 1) & CHAR_DIGIT))) {
+            return token(str, next_stop(str + 1, NUMBER_STOP));
+        }
+
+        return token(str, next_stop(str + 1, SYMBOL_STOP));
     }
 }
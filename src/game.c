@@ -6,15 +6,27 @@
 #include "game.h"
 #include "ui/edit_field.h"
 #include "game/level.h"
+#include "game/level_loader.h"
 #include "ui/console.h"
 #include "game/sound_samples.h"
+#include "sdl/renderer.h"
 #include "system/error.h"
+#include "system/file_watcher.h"
 #include "system/lt.h"
 
+#define LOADING_BACKGROUND color(0.0f, 0.0f, 0.0f, 1.0f)
+#define LOADING_FOREGROUND color(0.8f, 0.8f, 0.8f, 1.0f)
+#define LOADING_BAR_WIDTH 300.0f
+#define LOADING_BAR_HEIGHT 10.0f
+#define LOADING_FONT_SCALE 3.0f
+/* Relative to the working directory of the game */
+#define SCRIPT_CACHE_DIR "script-cache"
+
 typedef enum Game_state {
     GAME_STATE_RUNNING = 0,
     GAME_STATE_PAUSE,
     GAME_STATE_CONSOLE,
+    GAME_STATE_LOADING,
     GAME_STATE_QUIT,
 
     GAME_STATE_N
@@ -24,8 +36,13 @@ typedef struct Game {
     Lt *lt;
 
     Game_state state;
+    /* NULL until the first level is loaded */
     Level *level;
+    /* Not NULL only in GAME_STATE_LOADING */
+    LevelLoader *level_loader;
     char *level_file_path;
+    /* NULL if the level file could not be watched */
+    FileWatcher *level_watcher;
     Sound_samples *sound_samples;
     Camera *camera;
     Sprite_font *font;
@@ -53,14 +70,8 @@ Game *create_game(const char *level_file_path,
     game->lt = lt;
 
     game->renderer = renderer;
-
-    game->level = PUSH_LT(
-        lt,
-        create_level_from_file(level_file_path),
-        destroy_level);
-    if (game->level == NULL) {
-        RETURN_LT(lt, NULL);
-    }
+    game->level = NULL;
+    game->console = NULL;
 
     game->level_file_path = PUSH_LT(lt, malloc(sizeof(char) * (strlen(level_file_path) + 1)), free);
     if (game->level_file_path == NULL) {
@@ -69,6 +80,15 @@ Game *create_game(const char *level_file_path,
     }
     strcpy(game->level_file_path, level_file_path);
 
+    /* Hot reloading is a convenience, the game is playable without it */
+    game->level_watcher = PUSH_LT(
+        lt,
+        create_file_watcher(level_file_path),
+        destroy_file_watcher);
+    if (game->level_watcher == NULL) {
+        print_current_error_msg("Could not watch the level file");
+    }
+
     game->font = PUSH_LT(
         lt,
         create_sprite_font_from_file("fonts/charmap-oldschool.bmp", renderer),
@@ -92,25 +112,120 @@ Game *create_game(const char *level_file_path,
         RETURN_LT(lt, NULL);
     }
 
-    game->console = PUSH_LT(
+    game->level_loader = PUSH_LT(
         lt,
-        create_console(game->level, game->font),
-        destroy_console);
-    if (game->console == NULL) {
+        create_level_loader(level_file_path, SCRIPT_CACHE_DIR),
+        destroy_level_loader);
+    if (game->level_loader == NULL) {
         RETURN_LT(lt, NULL);
     }
 
-    game->state = GAME_STATE_RUNNING;
+    game->state = GAME_STATE_LOADING;
 
     return game;
 }
 
+/* The current level (if any) keeps living until the new one is
+ * completely loaded */
+static int game_start_loading(Game *game)
+{
+    assert(game);
+    assert(game->level_loader == NULL);
+
+    game->level_loader = PUSH_LT(
+        game->lt,
+        create_level_loader(game->level_file_path, SCRIPT_CACHE_DIR),
+        destroy_level_loader);
+    if (game->level_loader == NULL) {
+        return -1;
+    }
+
+    game->state = GAME_STATE_LOADING;
+
+    return 0;
+}
+
+static int game_finish_loading(Game *game)
+{
+    assert(game);
+    assert(game->level_loader);
+
+    const int status = level_loader_poll(game->level_loader);
+    if (status <= 0) {
+        return status;
+    }
+
+    Level *const level = level_loader_take(game->level_loader);
+    destroy_level_loader(RELEASE_LT(game->lt, game->level_loader));
+    game->level_loader = NULL;
+
+    if (game->level == NULL) {
+        game->level = PUSH_LT(game->lt, level, destroy_level);
+    } else {
+        game->level = RESET_LT(game->lt, game->level, level);
+    }
+
+    /* The console is bound to the level it was created for */
+    Console *const console = create_console(game->level, game->font);
+    if (console == NULL) {
+        return -1;
+    }
+
+    if (game->console == NULL) {
+        game->console = PUSH_LT(game->lt, console, destroy_console);
+    } else {
+        game->console = RESET_LT(game->lt, game->console, console);
+    }
+
+    camera_disable_debug_mode(game->camera);
+    game->state = GAME_STATE_RUNNING;
+
+    return 0;
+}
+
 void destroy_game(Game *game)
 {
     assert(game);
     RETURN_LT0(game->lt);
 }
 
+static int game_render_loading(const Game *game)
+{
+    assert(game);
+    assert(game->level_loader);
+
+    SDL_Rect view_port;
+    SDL_RenderGetViewport(game->renderer, &view_port);
+
+    const float progress = level_loader_progress(game->level_loader);
+    const float x = ((float) view_port.w - LOADING_BAR_WIDTH) * 0.5f;
+    const float y = ((float) view_port.h - LOADING_BAR_HEIGHT) * 0.5f;
+
+    if (fill_rect(game->renderer,
+                  rect(0.0f, 0.0f, (float) view_port.w, (float) view_port.h),
+                  LOADING_BACKGROUND) < 0) {
+        return -1;
+    }
+
+    if (sprite_font_render_text(
+            game->font,
+            game->renderer,
+            vec(x, y - FONT_CHAR_HEIGHT * LOADING_FONT_SCALE * 2.0f),
+            vec(LOADING_FONT_SCALE, LOADING_FONT_SCALE),
+            LOADING_FOREGROUND,
+            "Loading...") < 0) {
+        return -1;
+    }
+
+    if (fill_rect(game->renderer,
+                  rect(x, y, LOADING_BAR_WIDTH * progress, LOADING_BAR_HEIGHT),
+                  LOADING_FOREGROUND) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
 int game_render(const Game *game)
 {
     assert(game);
@@ -119,6 +234,10 @@ int game_render(const Game *game)
         return 0;
     }
 
+    if (game->state == GAME_STATE_LOADING) {
+        return game_render_loading(game);
+    }
+
     if (level_render(game->level, game->camera) < 0) {
         return -1;
     }
@@ -134,6 +253,10 @@ int game_render(const Game *game)
 
 int game_sound(Game *game)
 {
+    if (game->state == GAME_STATE_LOADING) {
+        return 0;
+    }
+
     return level_sound(game->level, game->sound_samples);
 }
 
@@ -146,11 +269,36 @@ int game_update(Game *game, float delta_time)
         return 0;
     }
 
+    if (game->state == GAME_STATE_LOADING) {
+        if (game_finish_loading(game) < 0) {
+            game->state = GAME_STATE_QUIT;
+            return -1;
+        }
+
+        return 0;
+    }
+
     if (game->state == GAME_STATE_RUNNING || game->state == GAME_STATE_CONSOLE) {
+        if (game->level_watcher != NULL) {
+            const int changed = file_watcher_changed(game->level_watcher);
+            if (changed < 0) {
+                print_current_error_msg("Could not watch the level file");
+            } else if (changed > 0) {
+                printf("Hot reloading the level from '%s'...\n", game->level_file_path);
+                if (level_hot_reload(game->level, game->level_file_path) < 0) {
+                    print_current_error_msg("Could not hot reload the level");
+                }
+            }
+        }
+
         if (level_update(game->level, delta_time) < 0) {
             return -1;
         }
 
+        if (level_dispatch_events(game->level) < 0) {
+            return -1;
+        }
+
         if (level_enter_camera_event(game->level, game->camera) < 0) {
             return -1;
         }
@@ -207,21 +355,13 @@ static int game_event_running(Game *game, const SDL_Event *event)
         case SDLK_r:
             printf("Reloading the level from '%s'...\n", game->level_file_path);
 
-            game->level = RESET_LT(
-                game->lt,
-                game->level,
-                create_level_from_file(
-                    game->level_file_path));
-
-            if (game->level == NULL) {
+            if (game_start_loading(game) < 0) {
                 print_current_error_msg("Could not reload the level");
                 game->state = GAME_STATE_QUIT;
                 return -1;
             }
 
-            camera_disable_debug_mode(game->camera);
-
-            break;
+            return 0;
 
         case SDLK_q:
             printf("Reloading the level's platforms from '%s'...\n", game->level_file_path);
@@ -257,6 +397,18 @@ static int game_event_running(Game *game, const SDL_Event *event)
     return level_event(game->level, event);
 }
 
+static int game_event_loading(Game *game, const SDL_Event *event)
+{
+    assert(game);
+    assert(event);
+
+    if (event->type == SDL_QUIT) {
+        game->state = GAME_STATE_QUIT;
+    }
+
+    return 0;
+}
+
 static int game_event_console(Game *game, const SDL_Event *event)
 {
     switch (event->type) {
@@ -294,6 +446,9 @@ int game_event(Game *game, const SDL_Event *event)
     case GAME_STATE_CONSOLE:
         return game_event_console(game, event);
 
+    case GAME_STATE_LOADING:
+        return game_event_loading(game, event);
+
     default: {}
     }
 
@@ -308,9 +463,10 @@ int game_input(Game *game,
     assert(game);
     assert(keyboard_state);
 
-    if (game->state == GAME_STATE_QUIT  ||
-        game->state == GAME_STATE_PAUSE ||
-        game->state == GAME_STATE_CONSOLE) {
+    if (game->state == GAME_STATE_QUIT    ||
+        game->state == GAME_STATE_PAUSE   ||
+        game->state == GAME_STATE_CONSOLE ||
+        game->state == GAME_STATE_LOADING) {
         return 0;
     }
 
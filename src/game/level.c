@@ -1,11 +1,13 @@
 #include <SDL2/SDL.h>
 #include <assert.h>
+#include <string.h>
 
 #include "color.h"
 #include "game/camera.h"
 #include "game/level.h"
 #include "game/level/background.h"
 #include "game/level/boxes.h"
+#include "game/level/compiled_level.h"
 #include "game/level/goals.h"
 #include "game/level/labels.h"
 #include "game/level/lava.h"
@@ -13,17 +15,30 @@
 #include "game/level/platforms.h"
 #include "game/level/player.h"
 #include "game/level/regions.h"
+#include "game/level/world_streamer.h"
+#include "system/arena.h"
 #include "system/error.h"
 #include "system/line_stream.h"
 #include "system/lt.h"
 #include "system/lt/lt_adapters.h"
 
 #define LEVEL_LINE_MAX_LENGTH 512
+#define LEVEL_ARENA_CHUNK_SIZE (64 * 1024)
+
+/* Sections of a text level that level_hot_reload can patch. The
+ * regions are left alone just like in level_reload_preserve_player
+ * since their scripts carry state. */
+#define LEVEL_HOT_SECTIONS (LEVEL_SECTION_LABELS + 1)
 
 struct Level
 {
     Lt *lt;
 
+    /* Background, platforms, goals, lava, boxes and labels live here
+     * and are freed together. The player and the regions own
+     * resources besides memory and are not in the arena. */
+    Arena *arena;
+
     Physical_world *physical_world;
     Player *player;
     Platforms *platforms;
@@ -34,9 +49,64 @@ struct Level
     Boxes *boxes;
     Labels *labels;
     Regions *regions;
+
+    /* Terrain of a compiled world that is streamed in around the
+     * camera. NULL for the regular levels. */
+    WorldStreamer *world;
+
+    uint64_t section_hashes[LEVEL_HOT_SECTIONS];
 };
 
-Level *create_level_from_file(const char *file_name)
+static int level_skip_section(LineStream *level_stream, LevelSection section)
+{
+    switch (section) {
+    case LEVEL_SECTION_BACKGROUND:
+    case LEVEL_SECTION_PLAYER:
+        return line_stream_skip_lines(level_stream, 1);
+
+    default: {
+        size_t count = 0;
+        if (line_stream_read_count(level_stream, &count) < 0
+            || line_stream_end_line(level_stream) < 0) {
+            return -1;
+        }
+
+        /* Every label takes a line for its position and a line for
+         * its text */
+        return line_stream_skip_lines(
+            level_stream,
+            section == LEVEL_SECTION_LABELS ? count * 2 : count);
+    }
+    }
+}
+
+/* Finds where every hot reloadable section begins without parsing
+ * its entities and hashes its text */
+static int level_fingerprint_sections(LineStream *level_stream,
+                                      LineStreamPosition begins[LEVEL_HOT_SECTIONS],
+                                      uint64_t hashes[LEVEL_HOT_SECTIONS])
+{
+    for (LevelSection section = 0; section < LEVEL_HOT_SECTIONS; ++section) {
+        begins[section] = line_stream_position(level_stream);
+        if (level_skip_section(level_stream, section) < 0) {
+            return -1;
+        }
+        hashes[section] = line_stream_hash(level_stream, begins[section]);
+    }
+
+    return 0;
+}
+
+static void level_loaded_stage(SDL_atomic_t *progress)
+{
+    if (progress != NULL) {
+        SDL_AtomicAdd(progress, 1);
+    }
+}
+
+static Level *create_level_from_compiled_file(const char *file_name,
+                                              const char *script_cache_dir,
+                                              SDL_atomic_t *progress)
 {
     assert(file_name);
 
@@ -51,6 +121,214 @@ Level *create_level_from_file(const char *file_name)
         RETURN_LT(lt, NULL);
     }
 
+    level->arena = PUSH_LT(lt, create_arena(LEVEL_ARENA_CHUNK_SIZE), destroy_arena);
+    if (level->arena == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    CompiledLevel *const compiled = PUSH_LT(
+        lt,
+        create_compiled_level_from_file(file_name),
+        destroy_compiled_level);
+    if (compiled == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+#define SECTION(S) \
+    compiled_level_count(compiled, S)
+
+    level->background = create_background(level->arena, compiled_level_colors(compiled, LEVEL_SECTION_BACKGROUND)[0]);
+    if (level->background == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    level_loaded_stage(progress);
+
+    const Point player_position = compiled_level_points(compiled, LEVEL_SECTION_PLAYER)[0];
+    level->player = PUSH_LT(
+        lt,
+        create_player(
+            player_position.x,
+            player_position.y,
+            compiled_level_colors(compiled, LEVEL_SECTION_PLAYER)[0]),
+        destroy_player);
+    if (level->player == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    level_loaded_stage(progress);
+
+    level->platforms = create_platforms(
+        level->arena,
+        compiled_level_rects(compiled, LEVEL_SECTION_PLATFORMS),
+        compiled_level_colors(compiled, LEVEL_SECTION_PLATFORMS),
+        SECTION(LEVEL_SECTION_PLATFORMS));
+    if (level->platforms == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    level_loaded_stage(progress);
+
+    level->goals = create_goals(
+        level->arena,
+        compiled_level_strings(compiled, LEVEL_SECTION_GOALS),
+        compiled_level_points(compiled, LEVEL_SECTION_GOALS),
+        compiled_level_rects(compiled, LEVEL_SECTION_GOALS),
+        compiled_level_colors(compiled, LEVEL_SECTION_GOALS),
+        SECTION(LEVEL_SECTION_GOALS));
+    if (level->goals == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    level_loaded_stage(progress);
+
+    level->lava = create_lava(
+        level->arena,
+        compiled_level_rects(compiled, LEVEL_SECTION_LAVA),
+        compiled_level_colors(compiled, LEVEL_SECTION_LAVA),
+        SECTION(LEVEL_SECTION_LAVA));
+    if (level->lava == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    level_loaded_stage(progress);
+
+    level->back_platforms = create_platforms(
+        level->arena,
+        compiled_level_rects(compiled, LEVEL_SECTION_BACK_PLATFORMS),
+        compiled_level_colors(compiled, LEVEL_SECTION_BACK_PLATFORMS),
+        SECTION(LEVEL_SECTION_BACK_PLATFORMS));
+    if (level->back_platforms == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    level_loaded_stage(progress);
+
+    level->boxes = create_boxes(
+        level->arena,
+        compiled_level_strings(compiled, LEVEL_SECTION_BOXES),
+        compiled_level_rects(compiled, LEVEL_SECTION_BOXES),
+        compiled_level_colors(compiled, LEVEL_SECTION_BOXES),
+        SECTION(LEVEL_SECTION_BOXES));
+    if (level->boxes == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    level_loaded_stage(progress);
+
+    level->labels = create_labels(
+        level->arena,
+        compiled_level_points(compiled, LEVEL_SECTION_LABELS),
+        compiled_level_colors(compiled, LEVEL_SECTION_LABELS),
+        compiled_level_strings(compiled, LEVEL_SECTION_LABELS),
+        SECTION(LEVEL_SECTION_LABELS));
+    if (level->labels == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    level_loaded_stage(progress);
+
+    level->regions = PUSH_LT(
+        lt,
+        create_regions(
+            compiled_level_rects(compiled, LEVEL_SECTION_REGIONS),
+            compiled_level_strings(compiled, LEVEL_SECTION_REGIONS),
+            SECTION(LEVEL_SECTION_REGIONS),
+            script_cache_dir),
+        destroy_regions);
+    if (level->regions == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    level_loaded_stage(progress);
+
+#undef SECTION
+
+    level->physical_world = PUSH_LT(lt, create_physical_world(), destroy_physical_world);
+    if (level->physical_world == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    if (physical_world_add_solid(
+            level->physical_world,
+            player_as_solid(level->player)) < 0) { RETURN_LT(lt, NULL); }
+    if (boxes_add_to_physical_world(
+            level->boxes,
+            level->physical_world) < 0) { RETURN_LT(lt, NULL); }
+
+    level->world = NULL;
+    level->lt = lt;
+    level_loaded_stage(progress);
+
+    /* Compiled levels are not hot reloaded section by section */
+    memset(level->section_hashes, 0, sizeof(level->section_hashes));
+
+    /* Entities copy everything they need out of the mapping */
+    destroy_compiled_level(RELEASE_LT(lt, compiled));
+
+    return level;
+}
+
+static Level *create_level_from_world(const char *world_dir,
+                                      const char *script_cache_dir,
+                                      SDL_atomic_t *progress)
+{
+    WorldStreamer *const world = create_world_streamer(world_dir);
+    if (world == NULL) {
+        return NULL;
+    }
+
+    Level *const level = create_level_from_compiled_file(
+        world_streamer_global_file(world),
+        script_cache_dir,
+        progress);
+    if (level == NULL) {
+        destroy_world_streamer(world);
+        return NULL;
+    }
+
+    level->world = PUSH_LT(level->lt, world, destroy_world_streamer);
+    if (level->world == NULL) {
+        destroy_world_streamer(world);
+        RETURN_LT(level->lt, NULL);
+    }
+
+    if (world_streamer_load(level->world, player_hitbox(level->player)) < 0) {
+        RETURN_LT(level->lt, NULL);
+    }
+    level_loaded_stage(progress);
+
+    return level;
+}
+
+Level *create_level_from_file(const char *file_name, const char *script_cache_dir)
+{
+    return create_level_from_file_with_progress(file_name, script_cache_dir, NULL);
+}
+
+Level *create_level_from_file_with_progress(const char *file_name,
+                                            const char *script_cache_dir,
+                                            SDL_atomic_t *progress)
+{
+    assert(file_name);
+
+    if (world_file_p(file_name)) {
+        return create_level_from_world(file_name, script_cache_dir, progress);
+    }
+
+    if (compiled_level_file_p(file_name)) {
+        Level *const level = create_level_from_compiled_file(file_name, script_cache_dir, progress);
+        /* No tiles to stream in */
+        level_loaded_stage(progress);
+        return level;
+    }
+
+    Lt *const lt = create_lt();
+    if (lt == NULL) {
+        return NULL;
+    }
+
+    Level *const level = PUSH_LT(lt, malloc(sizeof(Level)), free);
+    if (level == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+
+    level->arena = PUSH_LT(lt, create_arena(LEVEL_ARENA_CHUNK_SIZE), destroy_arena);
+    if (level->arena == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
     LineStream *level_stream = PUSH_LT(
         lt,
         create_line_stream(
@@ -62,13 +340,13 @@ Level *create_level_from_file(const char *file_name)
         throw_error(ERROR_TYPE_LIBC);
         RETURN_LT(lt, NULL);
     }
-    level->background = PUSH_LT(
-        lt,
-        create_background_from_line_stream(level_stream),
-        destroy_background);
+    const LineStreamPosition level_begin = line_stream_position(level_stream);
+
+    level->background = create_background_from_line_stream(level->arena, level_stream);
     if (level->background == NULL) {
         RETURN_LT(lt, NULL);
     }
+    level_loaded_stage(progress);
 
     level->player = PUSH_LT(
         lt,
@@ -77,62 +355,52 @@ Level *create_level_from_file(const char *file_name)
     if (level->player == NULL) {
         RETURN_LT(lt, NULL);
     }
+    level_loaded_stage(progress);
 
-    level->platforms = PUSH_LT(
-        lt,
-        create_platforms_from_line_stream(level_stream),
-        destroy_platforms);
+    level->platforms = create_platforms_from_line_stream(level->arena, level_stream);
     if (level->platforms == NULL) {
         RETURN_LT(lt, NULL);
     }
+    level_loaded_stage(progress);
 
-    level->goals = PUSH_LT(
-        lt,
-        create_goals_from_line_stream(level_stream),
-        destroy_goals);
+    level->goals = create_goals_from_line_stream(level->arena, level_stream);
     if (level->goals == NULL) {
         RETURN_LT(lt, NULL);
     }
+    level_loaded_stage(progress);
 
-    level->lava = PUSH_LT(
-        lt,
-        create_lava_from_line_stream(level_stream),
-        destroy_lava);
+    level->lava = create_lava_from_line_stream(level->arena, level_stream);
     if (level->lava == NULL) {
         RETURN_LT(lt, NULL);
     }
+    level_loaded_stage(progress);
 
-    level->back_platforms = PUSH_LT(
-        lt,
-        create_platforms_from_line_stream(level_stream),
-        destroy_platforms);
+    level->back_platforms = create_platforms_from_line_stream(level->arena, level_stream);
     if (level->back_platforms == NULL) {
         RETURN_LT(lt, NULL);
     }
+    level_loaded_stage(progress);
 
-    level->boxes = PUSH_LT(
-        lt,
-        create_boxes_from_line_stream(level_stream),
-        destroy_boxes);
+    level->boxes = create_boxes_from_line_stream(level->arena, level_stream);
     if (level->boxes == NULL) {
         RETURN_LT(lt, NULL);
     }
+    level_loaded_stage(progress);
 
-    level->labels = PUSH_LT(
-        lt,
-        create_labels_from_line_stream(level_stream),
-        destroy_labels);
+    level->labels = create_labels_from_line_stream(level->arena, level_stream);
     if (level->labels == NULL) {
         RETURN_LT(lt, NULL);
     }
+    level_loaded_stage(progress);
 
     level->regions = PUSH_LT(
         lt,
-        create_regions_from_line_stream(level_stream),
+        create_regions_from_line_stream(level_stream, script_cache_dir),
         destroy_regions);
-    if (level->regions == NULL) {
+    if (level->regions == NULL || line_stream_end_file(level_stream) < 0) {
         RETURN_LT(lt, NULL);
     }
+    level_loaded_stage(progress);
 
     level->physical_world = PUSH_LT(lt, create_physical_world(), destroy_physical_world);
     if (level->physical_world == NULL) {
@@ -145,7 +413,17 @@ Level *create_level_from_file(const char *file_name)
             level->boxes,
             level->physical_world) < 0) { RETURN_LT(lt, NULL); }
 
+    LineStreamPosition begins[LEVEL_HOT_SECTIONS];
+    line_stream_seek(level_stream, level_begin);
+    if (level_fingerprint_sections(level_stream, begins, level->section_hashes) < 0) {
+        RETURN_LT(lt, NULL);
+    }
+
+    level->world = NULL;
     level->lt = lt;
+    level_loaded_stage(progress);
+    /* No tiles to stream in */
+    level_loaded_stage(progress);
 
     destroy_line_stream(RELEASE_LT(lt, level_stream));
 
@@ -172,6 +450,12 @@ int level_render(const Level *level, Camera *camera)
         return -1;
     }
 
+    for (size_t i = 0; level->world != NULL && i < world_streamer_count(level->world); ++i) {
+        if (platforms_render(world_streamer_tile(level->world, i)->back_platforms, camera) < 0) {
+            return -1;
+        }
+    }
+
     if (player_render(level->player, camera) < 0) {
         return -1;
     }
@@ -184,10 +468,22 @@ int level_render(const Level *level, Camera *camera)
         return -1;
     }
 
+    for (size_t i = 0; level->world != NULL && i < world_streamer_count(level->world); ++i) {
+        if (lava_render(world_streamer_tile(level->world, i)->lava, camera) < 0) {
+            return -1;
+        }
+    }
+
     if (platforms_render(level->platforms, camera) < 0) {
         return -1;
     }
 
+    for (size_t i = 0; level->world != NULL && i < world_streamer_count(level->world); ++i) {
+        if (platforms_render(world_streamer_tile(level->world, i)->platforms, camera) < 0) {
+            return -1;
+        }
+    }
+
     if (goals_render(level->goals, camera) < 0) {
         return -1;
     }
@@ -196,6 +492,10 @@ int level_render(const Level *level, Camera *camera)
         return -1;
     }
 
+    if (regions_render(level->regions, camera) < 0) {
+        return -1;
+    }
+
     return 0;
 }
 
@@ -204,24 +504,66 @@ int level_update(Level *level, float delta_time)
     assert(level);
     assert(delta_time > 0);
 
+    const size_t tiles_count = level->world != NULL ? world_streamer_count(level->world) : 0;
+
+    /* The boxes only take part in the physics while the terrain around
+     * them is streamed in */
+    if (level->world != NULL) {
+        boxes_sleep_outside(level->boxes, level->world);
+
+        physical_world_clean(level->physical_world);
+        if (physical_world_add_solid(
+                level->physical_world,
+                player_as_solid(level->player)) < 0) { return -1; }
+        if (boxes_add_to_physical_world(
+                level->boxes,
+                level->physical_world) < 0) { return -1; }
+    }
+
     physical_world_apply_gravity(level->physical_world);
     boxes_float_in_lava(level->boxes, level->lava);
+    for (size_t i = 0; i < tiles_count; ++i) {
+        boxes_float_in_lava(level->boxes, world_streamer_tile(level->world, i)->lava);
+    }
 
     boxes_update(level->boxes, delta_time);
     player_update(level->player, delta_time);
 
-    physical_world_collide_solids(level->physical_world, level->platforms);
+    /* The global platforms of a world are empty, all of its terrain
+     * is in the tiles */
+    if (level->world != NULL) {
+        physical_world_collide_solids(
+            level->physical_world,
+            world_streamer_platforms(level->world),
+            tiles_count);
+    } else {
+        physical_world_collide_solids(level->physical_world, &level->platforms, 1);
+    }
 
     player_hide_goals(level->player, level->goals);
     player_die_from_lava(level->player, level->lava);
+    for (size_t i = 0; i < tiles_count; ++i) {
+        player_die_from_lava(level->player, world_streamer_tile(level->world, i)->lava);
+    }
 
     goals_update(level->goals, delta_time);
     lava_update(level->lava, delta_time);
+    for (size_t i = 0; i < tiles_count; ++i) {
+        lava_update(world_streamer_tile(level->world, i)->lava, delta_time);
+    }
     labels_update(level->labels, delta_time);
 
+    regions_track_player(level->regions, level->player);
+
     return 0;
 }
 
+int level_dispatch_events(Level *level)
+{
+    assert(level);
+    return regions_dispatch_events(level->regions);
+}
+
 int level_event(Level *level, const SDL_Event *event)
 {
     assert(level);
@@ -269,8 +611,162 @@ int level_input(Level *level,
     return 0;
 }
 
+/* The entities are swapped in only after all of them were created, so
+ * a failed reload leaves the level intact. The old entities go away
+ * together with their arena. */
+static int level_swap_arena(Level *level,
+                            Arena *arena,
+                            Background *background,
+                            Platforms *platforms,
+                            Goals *goals,
+                            Lava *lava,
+                            Platforms *back_platforms,
+                            Boxes *boxes,
+                            Labels *labels)
+{
+    level->arena = RESET_LT(level->lt, level->arena, arena);
+    level->background = background;
+    level->platforms = platforms;
+    level->goals = goals;
+    level->lava = lava;
+    level->back_platforms = back_platforms;
+    level->boxes = boxes;
+    level->labels = labels;
+
+    /* The terrain of a world goes away together with the rest of the
+     * entities. A reloaded world brings its own streamer in after the
+     * swap. */
+    if (level->world != NULL) {
+        destroy_world_streamer(RELEASE_LT(level->lt, level->world));
+        level->world = NULL;
+    }
+
+    physical_world_clean(level->physical_world);
+    if (physical_world_add_solid(
+            level->physical_world,
+            player_as_solid(level->player)) < 0) { return -1; }
+    if (boxes_add_to_physical_world(
+            level->boxes,
+            level->physical_world) < 0) { return -1; }
+
+    return 0;
+}
+
+static int level_reload_compiled_preserve_player(Level *level, const char *file_name)
+{
+    Lt * const lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    CompiledLevel * const compiled = PUSH_LT(
+        lt,
+        create_compiled_level_from_file(file_name),
+        destroy_compiled_level);
+    if (compiled == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    Arena * const arena = PUSH_LT(lt, create_arena(LEVEL_ARENA_CHUNK_SIZE), destroy_arena);
+    if (arena == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    Background * const background = create_background(
+        arena,
+        compiled_level_colors(compiled, LEVEL_SECTION_BACKGROUND)[0]);
+    Platforms * const platforms = create_platforms(
+        arena,
+        compiled_level_rects(compiled, LEVEL_SECTION_PLATFORMS),
+        compiled_level_colors(compiled, LEVEL_SECTION_PLATFORMS),
+        compiled_level_count(compiled, LEVEL_SECTION_PLATFORMS));
+    Goals * const goals = create_goals(
+        arena,
+        compiled_level_strings(compiled, LEVEL_SECTION_GOALS),
+        compiled_level_points(compiled, LEVEL_SECTION_GOALS),
+        compiled_level_rects(compiled, LEVEL_SECTION_GOALS),
+        compiled_level_colors(compiled, LEVEL_SECTION_GOALS),
+        compiled_level_count(compiled, LEVEL_SECTION_GOALS));
+    Lava * const lava = create_lava(
+        arena,
+        compiled_level_rects(compiled, LEVEL_SECTION_LAVA),
+        compiled_level_colors(compiled, LEVEL_SECTION_LAVA),
+        compiled_level_count(compiled, LEVEL_SECTION_LAVA));
+    Platforms * const back_platforms = create_platforms(
+        arena,
+        compiled_level_rects(compiled, LEVEL_SECTION_BACK_PLATFORMS),
+        compiled_level_colors(compiled, LEVEL_SECTION_BACK_PLATFORMS),
+        compiled_level_count(compiled, LEVEL_SECTION_BACK_PLATFORMS));
+    Boxes * const boxes = create_boxes(
+        arena,
+        compiled_level_strings(compiled, LEVEL_SECTION_BOXES),
+        compiled_level_rects(compiled, LEVEL_SECTION_BOXES),
+        compiled_level_colors(compiled, LEVEL_SECTION_BOXES),
+        compiled_level_count(compiled, LEVEL_SECTION_BOXES));
+    Labels * const labels = create_labels(
+        arena,
+        compiled_level_points(compiled, LEVEL_SECTION_LABELS),
+        compiled_level_colors(compiled, LEVEL_SECTION_LABELS),
+        compiled_level_strings(compiled, LEVEL_SECTION_LABELS),
+        compiled_level_count(compiled, LEVEL_SECTION_LABELS));
+
+    if (background == NULL || platforms == NULL || goals == NULL
+        || lava == NULL || back_platforms == NULL || boxes == NULL
+        || labels == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    if (level_swap_arena(level, RELEASE_LT(lt, arena),
+                         background, platforms, goals, lava,
+                         back_platforms, boxes, labels) < 0) {
+        RETURN_LT(lt, -1);
+    }
+
+    RETURN_LT(lt, 0);
+}
+
+/* The recompiled world may be cut into different tiles, so the
+ * resident ones are thrown away together with the old index */
+static int level_reload_world_preserve_player(Level *level, const char *world_dir)
+{
+    Lt * const lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    WorldStreamer * const world = PUSH_LT(lt, create_world_streamer(world_dir), destroy_world_streamer);
+    if (world == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    if (world_streamer_load(world, player_hitbox(level->player)) < 0) {
+        RETURN_LT(lt, -1);
+    }
+
+    if (level_reload_compiled_preserve_player(level, world_streamer_global_file(world)) < 0) {
+        RETURN_LT(lt, -1);
+    }
+
+    /* The old streamer was dropped by the swap */
+    level->world = PUSH_LT(level->lt, world, destroy_world_streamer);
+    if (level->world == NULL) {
+        RETURN_LT(lt, -1);
+    }
+    RELEASE_LT(lt, world);
+
+    RETURN_LT(lt, 0);
+}
+
 int level_reload_preserve_player(Level *level, const char *file_name)
 {
+    if (world_file_p(file_name)) {
+        return level_reload_world_preserve_player(level, file_name);
+    }
+
+    if (compiled_level_file_p(file_name)) {
+        return level_reload_compiled_preserve_player(level, file_name);
+    }
+
     Lt * const lt = create_lt();
     if (lt == NULL) {
         return -1;
@@ -289,62 +785,216 @@ int level_reload_preserve_player(Level *level, const char *file_name)
         throw_error(ERROR_TYPE_LIBC);
         RETURN_LT(lt, -1);
     }
+    const LineStreamPosition level_begin = line_stream_position(level_stream);
 
-    Background * const background = create_background_from_line_stream(level_stream);
+    Arena * const arena = PUSH_LT(lt, create_arena(LEVEL_ARENA_CHUNK_SIZE), destroy_arena);
+    if (arena == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    Background * const background = create_background_from_line_stream(arena, level_stream);
     if (background == NULL) {
         RETURN_LT(lt, -1);
     }
-    level->background = RESET_LT(level->lt, level->background, background);
 
-    Player * const skipped_player = create_player_from_line_stream(level_stream);
-    if (skipped_player == NULL) {
+    /* The player stays where it is */
+    if (line_stream_skip_lines(level_stream, 1) < 0) {
         RETURN_LT(lt, -1);
     }
-    destroy_player(skipped_player);
 
-    Platforms * const platforms = create_platforms_from_line_stream(level_stream);
+    Platforms * const platforms = create_platforms_from_line_stream(arena, level_stream);
     if (platforms == NULL) {
         RETURN_LT(lt, -1);
     }
-    level->platforms = RESET_LT(level->lt, level->platforms, platforms);
 
-    Goals * const goals = create_goals_from_line_stream(level_stream);
+    Goals * const goals = create_goals_from_line_stream(arena, level_stream);
     if (goals == NULL) {
         RETURN_LT(lt, -1);
     }
-    level->goals = RESET_LT(level->lt, level->goals, goals);
 
-    Lava * const lava = create_lava_from_line_stream(level_stream);
+    Lava * const lava = create_lava_from_line_stream(arena, level_stream);
     if (lava == NULL) {
         RETURN_LT(lt, -1);
     }
-    level->lava = RESET_LT(level->lt, level->lava, lava);
 
-    Platforms * const back_platforms = create_platforms_from_line_stream(level_stream);
+    Platforms * const back_platforms = create_platforms_from_line_stream(arena, level_stream);
     if (back_platforms == NULL) {
         RETURN_LT(lt, -1);
     }
-    level->back_platforms = RESET_LT(level->lt, level->back_platforms, back_platforms);
 
-    Boxes * const boxes = create_boxes_from_line_stream(level_stream);
+    Boxes * const boxes = create_boxes_from_line_stream(arena, level_stream);
     if (boxes == NULL) {
         RETURN_LT(lt, -1);
     }
-    level->boxes = RESET_LT(level->lt, level->boxes, boxes);
 
-    Labels * const labels = create_labels_from_line_stream(level_stream);
+    Labels * const labels = create_labels_from_line_stream(arena, level_stream);
     if (labels == NULL) {
         RETURN_LT(lt, -1);
     }
-    level->labels = RESET_LT(level->lt, level->labels, labels);
 
-    physical_world_clean(level->physical_world);
-    if (physical_world_add_solid(
-            level->physical_world,
-            player_as_solid(level->player)) < 0) { RETURN_LT(lt, -1); }
-    if (boxes_add_to_physical_world(
-            level->boxes,
-            level->physical_world) < 0) { RETURN_LT(lt, -1); }
+    uint64_t section_hashes[LEVEL_HOT_SECTIONS];
+    LineStreamPosition begins[LEVEL_HOT_SECTIONS];
+    line_stream_seek(level_stream, level_begin);
+    if (level_fingerprint_sections(level_stream, begins, section_hashes) < 0) {
+        RETURN_LT(lt, -1);
+    }
+
+    if (level_swap_arena(level, RELEASE_LT(lt, arena),
+                         background, platforms, goals, lava,
+                         back_platforms, boxes, labels) < 0) {
+        RETURN_LT(lt, -1);
+    }
+    memcpy(level->section_hashes, section_hashes, sizeof(section_hashes));
+
+    RETURN_LT(lt, 0);
+}
+
+/* Parses the section into the scratch arena and patches the live
+ * entities with it. Returns 1 if the section cannot be patched in
+ * place. */
+static int level_hot_reload_section(Level *level,
+                                    Arena *scratch,
+                                    LineStream *level_stream,
+                                    LevelSection section)
+{
+    switch (section) {
+    case LEVEL_SECTION_BACKGROUND: {
+        Background * const background = create_background_from_line_stream(scratch, level_stream);
+        if (background == NULL) {
+            return -1;
+        }
+        background_patch(level->background, background);
+    } break;
+
+    case LEVEL_SECTION_PLAYER:
+        /* The player stays where it is */
+        break;
+
+    case LEVEL_SECTION_PLATFORMS:
+    case LEVEL_SECTION_BACK_PLATFORMS: {
+        Platforms * const platforms = create_platforms_from_line_stream(scratch, level_stream);
+        if (platforms == NULL) {
+            return -1;
+        }
+        if (platforms_patch(
+                section == LEVEL_SECTION_PLATFORMS ? level->platforms : level->back_platforms,
+                platforms) < 0) {
+            return 1;
+        }
+    } break;
+
+    case LEVEL_SECTION_GOALS: {
+        Goals * const goals = create_goals_from_line_stream(scratch, level_stream);
+        if (goals == NULL) {
+            return -1;
+        }
+        if (goals_patch(level->goals, goals) < 0) {
+            return 1;
+        }
+    } break;
+
+    case LEVEL_SECTION_LAVA: {
+        Lava * const lava = create_lava_from_line_stream(scratch, level_stream);
+        if (lava == NULL) {
+            return -1;
+        }
+        if (lava_patch(level->lava, lava) < 0) {
+            return 1;
+        }
+    } break;
+
+    case LEVEL_SECTION_BOXES: {
+        Boxes * const boxes = create_boxes_from_line_stream(scratch, level_stream);
+        if (boxes == NULL) {
+            return -1;
+        }
+        if (boxes_patch(level->boxes, boxes) < 0) {
+            return 1;
+        }
+    } break;
+
+    case LEVEL_SECTION_LABELS: {
+        Labels * const labels = create_labels_from_line_stream(scratch, level_stream);
+        if (labels == NULL) {
+            return -1;
+        }
+        if (labels_patch(level->labels, labels) < 0) {
+            return 1;
+        }
+    } break;
+
+    default:
+        assert(0 && "Section is not hot reloadable");
+    }
+
+    return 0;
+}
+
+int level_hot_reload(Level *level, const char *file_name)
+{
+    assert(level);
+    assert(file_name);
+
+    /* A level that was a world has no text sections to patch */
+    if (level->world != NULL
+        || world_file_p(file_name)
+        || compiled_level_file_p(file_name)) {
+        return level_reload_preserve_player(level, file_name);
+    }
+
+    Lt * const lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    LineStream * const level_stream = PUSH_LT(
+        lt,
+        create_line_stream(
+            file_name,
+            "r",
+            LEVEL_LINE_MAX_LENGTH),
+        destroy_line_stream);
+    if (level_stream == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    LineStreamPosition begins[LEVEL_HOT_SECTIONS];
+    uint64_t hashes[LEVEL_HOT_SECTIONS];
+    if (level_fingerprint_sections(level_stream, begins, hashes) < 0) {
+        RETURN_LT(lt, -1);
+    }
+
+    /* The changed sections are only needed until they are patched
+     * into the live entities */
+    Arena * const scratch = PUSH_LT(lt, create_arena(LEVEL_ARENA_CHUNK_SIZE), destroy_arena);
+    if (scratch == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    for (LevelSection section = 0; section < LEVEL_HOT_SECTIONS; ++section) {
+        if (hashes[section] == level->section_hashes[section]) {
+            continue;
+        }
+
+        line_stream_seek(level_stream, begins[section]);
+        const int result = level_hot_reload_section(level, scratch, level_stream, section);
+        if (result < 0) {
+            RETURN_LT(lt, -1);
+        }
+
+        if (result > 0) {
+            /* The entities cannot grow inside the arena of the
+             * level, so a changed amount of them rebuilds the
+             * level around the player */
+            destroy_lt(lt);
+            return level_reload_preserve_player(level, file_name);
+        }
+
+        /* A section that failed to reload keeps its old hash and is
+         * retried on the next change */
+        level->section_hashes[section] = hashes[section];
+    }
 
     RETURN_LT(lt, 0);
 }
@@ -370,6 +1020,11 @@ void level_toggle_debug_mode(Level *level)
 int level_enter_camera_event(Level *level,
                              const Camera *camera)
 {
+    if (level->world != NULL
+        && world_streamer_update(level->world, camera_view_port(camera)) < 0) {
+        return -1;
+    }
+
     goals_cue(level->goals, camera);
     goals_checkpoint(level->goals, level->player);
     labels_enter_camera_event(level->labels, camera);
@@ -395,3 +1050,40 @@ Rigid_rect *level_rigid_rect(Level *level,
 
     return NULL;
 }
+
+void level_stats(const Level *level, struct LevelStats *stats)
+{
+    assert(level);
+    assert(stats);
+
+    stats->platforms = platforms_count(level->platforms);
+    stats->back_platforms = platforms_count(level->back_platforms);
+    stats->lava = lava_count(level->lava);
+    stats->goals = goals_count(level->goals);
+    stats->boxes = boxes_count(level->boxes);
+    stats->labels = labels_count(level->labels);
+    stats->regions = regions_count(level->regions);
+    stats->tiles = level->world != NULL ? world_streamer_count(level->world) : 0;
+    stats->player = player_hitbox(level->player);
+
+    for (size_t i = 0; i < stats->tiles; ++i) {
+        const WorldTile *tile = world_streamer_tile(level->world, i);
+        stats->platforms += platforms_count(tile->platforms);
+        stats->back_platforms += platforms_count(tile->back_platforms);
+        stats->lava += lava_count(tile->lava);
+    }
+}
+
+Platforms *const *level_platforms(const Level *level, size_t *count)
+{
+    assert(level);
+    assert(count);
+
+    if (level->world != NULL) {
+        *count = world_streamer_count(level->world);
+        return world_streamer_platforms(level->world);
+    }
+
+    *count = 1;
+    return &level->platforms;
+}
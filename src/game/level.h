@@ -11,13 +11,42 @@
 
 typedef struct Level Level;
 
-Level *create_level_from_file(const char *file_name);
+struct LevelStats
+{
+    // The terrain counts include the resident tiles of a compiled world
+    size_t platforms;
+    size_t back_platforms;
+    size_t lava;
+    size_t goals;
+    size_t boxes;
+    size_t labels;
+    size_t regions;
+    size_t tiles;
+    Rect player;
+};
+
+// Amount of stages create_level_from_file_with_progress goes through.
+// The last one streams in the tiles around the player and is done
+// right away for the levels that are not worlds.
+#define LEVEL_LOAD_STAGES 11
+
+// The parsed scripts of the regions are cached in script_cache_dir.
+// NULL script_cache_dir disables the cache, so nothing is written to
+// the disk.
+Level *create_level_from_file(const char *file_name, const char *script_cache_dir);
+// Increments progress after every loaded stage. Does not touch any
+// global state, so it can be called outside of the main thread.
+Level *create_level_from_file_with_progress(const char *file_name,
+                                            const char *script_cache_dir,
+                                            SDL_atomic_t *progress);
 void destroy_level(Level *level);
 
 int level_render(const Level *level, Camera *camera);
 
 int level_sound(Level *level, Sound_samples *sound_samples);
 int level_update(Level *level, float delta_time);
+// Runs the script callbacks of the events queued by level_update
+int level_dispatch_events(Level *level);
 
 int level_event(Level *level, const SDL_Event *event);
 int level_input(Level *level,
@@ -28,10 +57,18 @@ int level_enter_camera_event(Level *level,
 
 int level_reload_preserve_player(Level *level,
                                  const char *file_name);
+// Re-parses only the sections of the level file that changed since
+// the level was loaded and patches the live entities in place
+int level_hot_reload(Level *level, const char *file_name);
 
 Rigid_rect *level_rigid_rect(Level *level,
                              const char *rigid_rect_id);
 
+void level_stats(const Level *level, struct LevelStats *stats);
+// The platforms the solids of the level collide with. A compiled
+// world has one of them per resident tile.
+Platforms *const *level_platforms(const Level *level, size_t *count);
+
 void level_toggle_debug_mode(Level *level);
 void level_toggle_pause_mode(Level *level);
 
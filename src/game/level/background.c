@@ -3,8 +3,7 @@
 #include "game/level/background.h"
 #include "math/rand.h"
 #include "math/rect.h"
-#include "system/error.h"
-#include "system/lt.h"
+#include "system/arena.h"
 #include "system/line_stream.h"
 
 #define BACKGROUND_CHUNK_COUNT 5
@@ -21,47 +20,36 @@ int render_chunk(const Background *background,
 
 struct Background
 {
-    Lt *lt;
     Color base_color;
     Vec position;
     int debug_mode;
 };
 
-Background *create_background(Color base_color)
+Background *create_background(Arena *arena, Color base_color)
 {
-    Lt *lt = create_lt();
-    if (lt == NULL) {
-        return NULL;
-    }
+    assert(arena);
 
-    Background *background = PUSH_LT(lt, malloc(sizeof(Background)), free);
+    Background *background = arena_alloc(arena, sizeof(Background));
     if (background == NULL) {
-        RETURN_LT(lt, NULL);
+        return NULL;
     }
 
     background->base_color = base_color;
     background->position = vec(0.0f, 0.0f);
     background->debug_mode = 0;
-    background->lt = lt;
 
     return background;
 }
 
-Background *create_background_from_line_stream(LineStream *line_stream)
+Background *create_background_from_line_stream(Arena *arena, LineStream *line_stream)
 {
-    char color[7];
-    if (sscanf(line_stream_next(line_stream), "%6s", color) == EOF) {
-        throw_error(ERROR_TYPE_LIBC);
+    Color color;
+    if (line_stream_read_color(line_stream, &color) < 0
+        || line_stream_end_line(line_stream) < 0) {
         return NULL;
     }
 
-    return create_background(color_from_hexstr(color));
-}
-
-void destroy_background(Background *background)
-{
-    assert(background);
-    RETURN_LT0(background->lt);
+    return create_background(arena, color);
 }
 
 /* TODO(#182): background chunks are randomly disappearing when the size of the window is less than size of the chunk  */
@@ -162,3 +150,11 @@ void background_toggle_debug_mode(Background *background)
 {
     background->debug_mode = !background->debug_mode;
 }
+
+void background_patch(Background *background, const Background *source)
+{
+    assert(background);
+    assert(source);
+
+    background->base_color = source->base_color;
+}
@@ -8,14 +8,16 @@
 
 typedef struct Background Background;
 typedef struct LineStream LineStream;
+typedef struct Arena Arena;
 
-Background *create_background(Color base_color);
-Background *create_background_from_line_stream(LineStream *line_stream);
-void destroy_background(Background *background);
+Background *create_background(Arena *arena, Color base_color);
+Background *create_background_from_line_stream(Arena *arena, LineStream *line_stream);
 
 int background_render(const Background *background,
                       Camera *camera);
 
 void background_toggle_debug_mode(Background *background);
 
+void background_patch(Background *background, const Background *source);
+
 #endif  // BACKGROUND_H_
@@ -1,69 +1,134 @@
+#define _DEFAULT_SOURCE
+
 #include <assert.h>
+#include <string.h>
 
 #include "game/level/boxes.h"
 #include "game/level/physical_world.h"
 #include "game/level/player.h"
 #include "game/level/player/rigid_rect.h"
-#include "system/error.h"
-#include "system/lt.h"
+#include "game/level/world_streamer.h"
+#include "system/arena.h"
 #include "system/line_stream.h"
 
+#define BOXES_MAX_ID_SIZE 36
+
 struct Boxes
 {
-    Lt *lt;
     size_t count;
     Rigid_rect **bodies;
+    bool *awake;
+
+    /* What the bodies were created from, so boxes_patch can tell
+     * which of them were changed in the level file */
+    char **ids;
+    Rect *rects;
+    Color *colors;
 };
 
-Boxes *create_boxes_from_line_stream(LineStream *line_stream)
+static Boxes *alloc_boxes(Arena *arena, size_t count)
 {
-    assert(line_stream);
-
-    Lt *lt = create_lt();
+    Boxes *boxes = arena_alloc(arena, sizeof(Boxes));
+    if (boxes == NULL) {
+        return NULL;
+    }
 
-    if (lt == NULL) {
+    boxes->count = count;
+    boxes->bodies = arena_alloc(arena, sizeof(Rigid_rect*) * count);
+    boxes->awake = arena_alloc(arena, sizeof(bool) * count);
+    boxes->ids = arena_alloc(arena, sizeof(char*) * count);
+    boxes->rects = arena_alloc(arena, sizeof(Rect) * count);
+    boxes->colors = arena_alloc(arena, sizeof(Color) * count);
+    char *const id_buffer = arena_alloc(arena, sizeof(char) * BOXES_MAX_ID_SIZE * count);
+    if (boxes->bodies == NULL
+        || boxes->awake == NULL
+        || boxes->ids == NULL
+        || boxes->rects == NULL
+        || boxes->colors == NULL
+        || id_buffer == NULL) {
         return NULL;
     }
 
-    Boxes *boxes = PUSH_LT(lt, malloc(sizeof(Boxes)), free);
-    if (boxes == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    for (size_t i = 0; i < count; ++i) {
+        boxes->awake[i] = true;
+        boxes->ids[i] = id_buffer + i * BOXES_MAX_ID_SIZE;
     }
 
-    if (sscanf(
-            line_stream_next(line_stream),
-            "%lu",
-            &boxes->count) == EOF) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    return boxes;
+}
+
+static int boxes_create_body(Boxes *boxes, Arena *arena, size_t i,
+                             const char *id, Rect rect, Color color)
+{
+    const size_t id_size = strnlen(id, BOXES_MAX_ID_SIZE - 1);
+    memcpy(boxes->ids[i], id, id_size);
+    boxes->ids[i][id_size] = 0;
+    boxes->rects[i] = rect;
+    boxes->colors[i] = color;
+
+    boxes->bodies[i] = create_rigid_rect(arena, rect, color, id);
+    if (boxes->bodies[i] == NULL) {
+        return -1;
     }
 
-    boxes->bodies = PUSH_LT(lt, malloc(sizeof(Rigid_rect*) * boxes->count), free);
-    if (boxes->bodies == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    return 0;
+}
+
+Boxes *create_boxes(Arena *arena,
+                    const char *const *ids,
+                    const Rect *rects,
+                    const Color *colors,
+                    size_t count)
+{
+    assert(arena);
+    assert(ids || count == 0);
+    assert(rects || count == 0);
+    assert(colors || count == 0);
+
+    Boxes *boxes = alloc_boxes(arena, count);
+    if (boxes == NULL) {
+        return NULL;
     }
 
-    for (size_t i = 0; i < boxes->count; ++i) {
-        boxes->bodies[i] = PUSH_LT(
-            lt,
-            create_rigid_rect_from_line_stream(line_stream),
-            destroy_rigid_rect);
-        if (boxes->bodies[i] == NULL) {
-            RETURN_LT(lt, NULL);
+    for (size_t i = 0; i < count; ++i) {
+        if (boxes_create_body(boxes, arena, i, ids[i], rects[i], colors[i]) < 0) {
+            return NULL;
         }
     }
 
-    boxes->lt = lt;
-
     return boxes;
 }
 
-void destroy_boxes(Boxes *boxes)
+Boxes *create_boxes_from_line_stream(Arena *arena, LineStream *line_stream)
 {
-    assert(boxes);
-    RETURN_LT0(boxes->lt);
+    assert(arena);
+    assert(line_stream);
+
+    size_t count = 0;
+    if (line_stream_read_count(line_stream, &count) < 0
+        || line_stream_end_line(line_stream) < 0) {
+        return NULL;
+    }
+
+    Boxes *boxes = alloc_boxes(arena, count);
+    if (boxes == NULL) {
+        return NULL;
+    }
+
+    char id[BOXES_MAX_ID_SIZE];
+    Rect rect;
+    Color color;
+    for (size_t i = 0; i < count; ++i) {
+        if (line_stream_read_word(line_stream, id, BOXES_MAX_ID_SIZE) < 0
+            || line_stream_read_rect(line_stream, &rect) < 0
+            || line_stream_read_color(line_stream, &color) < 0
+            || line_stream_end_line(line_stream) < 0
+            || boxes_create_body(boxes, arena, i, id, rect, color) < 0) {
+            return NULL;
+        }
+    }
+
+    return boxes;
 }
 
 int boxes_render(Boxes *boxes, Camera *camera)
@@ -87,7 +152,7 @@ int boxes_update(Boxes *boxes,
     assert(delta_time);
 
     for (size_t i = 0; i < boxes->count; ++i) {
-        if (rigid_rect_update(boxes->bodies[i], delta_time) < 0) {
+        if (boxes->awake[i] && rigid_rect_update(boxes->bodies[i], delta_time) < 0) {
             return -1;
         }
     }
@@ -102,7 +167,7 @@ int boxes_add_to_physical_world(const Boxes *boxes,
     assert(physical_world);
 
     for (size_t i = 0; i < boxes->count; ++i) {
-        if (physical_world_add_solid(
+        if (boxes->awake[i] && physical_world_add_solid(
                 physical_world,
                 rigid_rect_as_solid(boxes->bodies[i])) < 0) {
             return -1;
@@ -118,7 +183,21 @@ void boxes_float_in_lava(Boxes *boxes, Lava *lava)
     assert(lava);
 
     for (size_t i = 0; i < boxes->count; ++i) {
-        lava_float_rigid_rect(lava, boxes->bodies[i]);
+        if (boxes->awake[i]) {
+            lava_float_rigid_rect(lava, boxes->bodies[i]);
+        }
+    }
+}
+
+void boxes_sleep_outside(Boxes *boxes, const WorldStreamer *world_streamer)
+{
+    assert(boxes);
+    assert(world_streamer);
+
+    for (size_t i = 0; i < boxes->count; ++i) {
+        boxes->awake[i] = world_streamer_resident_p(
+            world_streamer,
+            rigid_rect_hitbox(boxes->bodies[i]));
     }
 }
 
@@ -135,3 +214,36 @@ Rigid_rect *boxes_rigid_rect(Boxes *boxes, const char *id)
 
     return 0;
 }
+
+size_t boxes_count(const Boxes *boxes)
+{
+    assert(boxes);
+    return boxes->count;
+}
+
+int boxes_patch(Boxes *boxes, const Boxes *source)
+{
+    assert(boxes);
+    assert(source);
+
+    if (boxes->count != source->count) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < boxes->count; ++i) {
+        if (strcmp(boxes->ids[i], source->ids[i]) == 0
+            && memcmp(&boxes->rects[i], &source->rects[i], sizeof(Rect)) == 0
+            && memcmp(&boxes->colors[i], &source->colors[i], sizeof(Color)) == 0) {
+            continue;
+        }
+
+        /* The changed box starts over from its new definition while
+         * the rest of them keep moving from where they are */
+        rigid_rect_patch(boxes->bodies[i], source->bodies[i]);
+        memcpy(boxes->ids[i], source->ids[i], BOXES_MAX_ID_SIZE);
+        boxes->rects[i] = source->rects[i];
+        boxes->colors[i] = source->colors[i];
+    }
+
+    return 0;
+}
@@ -9,18 +9,38 @@ typedef struct Boxes Boxes;
 typedef struct Player Player;
 typedef struct Physical_world Physical_world;
 typedef struct LineStream LineStream;
+typedef struct Arena Arena;
+typedef struct WorldStreamer WorldStreamer;
 
-Boxes *create_boxes_from_line_stream(LineStream *line_stream);
-void destroy_boxes(Boxes *boxes);
+Boxes *create_boxes(Arena *arena,
+                    const char *const *ids,
+                    const Rect *rects,
+                    const Color *colors,
+                    size_t count);
+Boxes *create_boxes_from_line_stream(Arena *arena, LineStream *line_stream);
 
 int boxes_render(Boxes *boxes, Camera *camera);
 int boxes_update(Boxes *boxes, float delta_time);
 
 void boxes_float_in_lava(Boxes *boxes, Lava *lava);
 
+// Adds only the boxes that are awake
 int boxes_add_to_physical_world(const Boxes *boxes,
                                 Physical_world *Physical_world);
 
+// Puts the boxes whose terrain is not resident in world_streamer to
+// sleep and wakes up the rest. Sleeping boxes are skipped by the
+// physics and keep their state, so they do not fall through the
+// terrain that is not streamed in yet.
+void boxes_sleep_outside(Boxes *boxes, const WorldStreamer *world_streamer);
+
 Rigid_rect *boxes_rigid_rect(Boxes *boxes, const char *id);
 
+size_t boxes_count(const Boxes *boxes);
+
+// Resets the boxes whose definition differs in source to the new
+// definition. Fails without touching anything if the amount of boxes
+// changed.
+int boxes_patch(Boxes *boxes, const Boxes *source);
+
 #endif  // BOXES_H_
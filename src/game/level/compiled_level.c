@@ -0,0 +1,372 @@
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "compiled_level.h"
+#include "system/error.h"
+#include "system/lt.h"
+
+static const unsigned int section_arrays[LEVEL_SECTION_N] = {
+    [LEVEL_SECTION_BACKGROUND] = LEVEL_ARRAY_COLORS,
+    [LEVEL_SECTION_PLAYER] = LEVEL_ARRAY_POINTS | LEVEL_ARRAY_COLORS,
+    [LEVEL_SECTION_PLATFORMS] = LEVEL_ARRAY_RECTS | LEVEL_ARRAY_COLORS,
+    [LEVEL_SECTION_GOALS] = LEVEL_ARRAY_POINTS | LEVEL_ARRAY_RECTS | LEVEL_ARRAY_COLORS | LEVEL_ARRAY_STRINGS,
+    [LEVEL_SECTION_LAVA] = LEVEL_ARRAY_RECTS | LEVEL_ARRAY_COLORS,
+    [LEVEL_SECTION_BACK_PLATFORMS] = LEVEL_ARRAY_RECTS | LEVEL_ARRAY_COLORS,
+    [LEVEL_SECTION_BOXES] = LEVEL_ARRAY_RECTS | LEVEL_ARRAY_COLORS | LEVEL_ARRAY_STRINGS,
+    [LEVEL_SECTION_LABELS] = LEVEL_ARRAY_POINTS | LEVEL_ARRAY_COLORS | LEVEL_ARRAY_STRINGS,
+    [LEVEL_SECTION_REGIONS] = LEVEL_ARRAY_RECTS | LEVEL_ARRAY_STRINGS,
+    [LEVEL_SECTION_STRINGS] = 0
+};
+
+unsigned int level_section_arrays(LevelSection section)
+{
+    assert(section < LEVEL_SECTION_N);
+    return section_arrays[section];
+}
+
+size_t level_section_record_size(LevelSection section)
+{
+    const unsigned int arrays = level_section_arrays(section);
+
+    if (section == LEVEL_SECTION_STRINGS) {
+        return 1;
+    }
+
+    return ((arrays & LEVEL_ARRAY_POINTS) ? sizeof(Point) : 0)
+        + ((arrays & LEVEL_ARRAY_RECTS) ? sizeof(Rect) : 0)
+        + ((arrays & LEVEL_ARRAY_COLORS) ? sizeof(Color) : 0)
+        + ((arrays & LEVEL_ARRAY_STRINGS) ? sizeof(uint32_t) : 0);
+}
+
+struct CompiledLevel
+{
+    Lt *lt;
+    char *data;
+    size_t size;
+    const struct LevelFormatHeader *header;
+    const char **strings[LEVEL_SECTION_N];
+};
+
+bool compiled_level_file_p(const char *file_name)
+{
+    assert(file_name);
+
+    FILE *file = fopen(file_name, "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    char magic[LEVEL_FORMAT_MAGIC_SIZE];
+    const bool result = fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+        && memcmp(magic, LEVEL_FORMAT_MAGIC, sizeof(magic)) == 0;
+
+    fclose(file);
+
+    return result;
+}
+
+static const void *compiled_level_array(const CompiledLevel *level,
+                                        LevelSection section,
+                                        enum LevelSectionArray array)
+{
+    const unsigned int arrays = level_section_arrays(section);
+    if (!(arrays & array)) {
+        return NULL;
+    }
+
+    const size_t count = compiled_level_count(level, section);
+    size_t offset = (size_t) level->header->sections[section].offset;
+
+    if (array != LEVEL_ARRAY_POINTS && (arrays & LEVEL_ARRAY_POINTS)) {
+        offset += sizeof(Point) * count;
+    }
+
+    if (array != LEVEL_ARRAY_POINTS && array != LEVEL_ARRAY_RECTS
+        && (arrays & LEVEL_ARRAY_RECTS)) {
+        offset += sizeof(Rect) * count;
+    }
+
+    if (array == LEVEL_ARRAY_STRINGS && (arrays & LEVEL_ARRAY_COLORS)) {
+        offset += sizeof(Color) * count;
+    }
+
+    return level->data + offset;
+}
+
+static int compiled_level_error(const char *file_name, const char *message, size_t section)
+{
+    if (section < LEVEL_SECTION_N) {
+        fprintf(stderr, "%s: section %lu: %s\n", file_name, (unsigned long) section, message);
+    } else {
+        fprintf(stderr, "%s: %s\n", file_name, message);
+    }
+
+    return -1;
+}
+
+static int compiled_level_validate(CompiledLevel *level, const char *file_name)
+{
+    if (level->size < sizeof(struct LevelFormatHeader)) {
+        return compiled_level_error(file_name, "file is too short for the header", LEVEL_SECTION_N);
+    }
+
+    level->header = (const void *) level->data;
+
+    if (memcmp(level->header->magic, LEVEL_FORMAT_MAGIC, LEVEL_FORMAT_MAGIC_SIZE) != 0
+        || level->header->version != LEVEL_FORMAT_VERSION
+        || level->header->section_count != LEVEL_SECTION_N) {
+        return compiled_level_error(file_name, "unsupported version of the format", LEVEL_SECTION_N);
+    }
+
+    for (size_t i = 0; i < LEVEL_SECTION_N; ++i) {
+        const struct LevelFormatSection section = level->header->sections[i];
+        const size_t record_size = level_section_record_size((LevelSection) i);
+
+        if (section.offset % LEVEL_FORMAT_ALIGNMENT != 0) {
+            return compiled_level_error(file_name, "misaligned", i);
+        }
+
+        if (section.offset > level->size
+            || section.count > (level->size - section.offset) / record_size) {
+            return compiled_level_error(file_name, "out of the bounds of the file", i);
+        }
+    }
+
+    if (level->header->sections[LEVEL_SECTION_BACKGROUND].count != 1) {
+        return compiled_level_error(file_name, "expected exactly one background", LEVEL_SECTION_BACKGROUND);
+    }
+
+    if (level->header->sections[LEVEL_SECTION_PLAYER].count != 1) {
+        return compiled_level_error(file_name, "expected exactly one player", LEVEL_SECTION_PLAYER);
+    }
+
+    /* The text of the last string must be terminated inside of the section */
+    const size_t strings_size = compiled_level_count(level, LEVEL_SECTION_STRINGS);
+    const char *strings = level->data + level->header->sections[LEVEL_SECTION_STRINGS].offset;
+    if (strings_size > 0 && strings[strings_size - 1] != 0) {
+        return compiled_level_error(file_name, "unterminated string", LEVEL_SECTION_STRINGS);
+    }
+
+    return 0;
+}
+
+static int compiled_level_resolve_strings(CompiledLevel *level, const char *file_name)
+{
+    const size_t strings_size = compiled_level_count(level, LEVEL_SECTION_STRINGS);
+    const char *strings = level->data + level->header->sections[LEVEL_SECTION_STRINGS].offset;
+
+    for (size_t i = 0; i < LEVEL_SECTION_N; ++i) {
+        const uint32_t *offsets = compiled_level_array(level, (LevelSection) i, LEVEL_ARRAY_STRINGS);
+        level->strings[i] = NULL;
+
+        if (offsets == NULL) {
+            continue;
+        }
+
+        const size_t count = compiled_level_count(level, (LevelSection) i);
+        level->strings[i] = PUSH_LT(level->lt, malloc(sizeof(const char*) * (count + 1)), free);
+        if (level->strings[i] == NULL) {
+            throw_error(ERROR_TYPE_LIBC);
+            return -1;
+        }
+
+        for (size_t j = 0; j < count; ++j) {
+            if (offsets[j] >= strings_size) {
+                compiled_level_error(file_name, "string is out of the string table", i);
+                errno = EINVAL;
+                throw_error(ERROR_TYPE_LIBC);
+                return -1;
+            }
+
+            level->strings[i][j] = strings + offsets[j];
+        }
+    }
+
+    return 0;
+}
+
+#ifdef _WIN32
+
+/* There is no mmap, so the file is read into a buffer. The validation
+ * does not care where the bytes came from. */
+static int compiled_level_load(CompiledLevel *level, const char *file_name)
+{
+    FILE *file = fopen(file_name, "rb");
+    if (file == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    long int file_size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        file_size = ftell(file);
+    }
+
+    if (file_size < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        fclose(file);
+        return -1;
+    }
+
+    level->size = (size_t) file_size;
+    if (level->size == 0) {
+        fclose(file);
+        errno = EINVAL;
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    level->data = malloc(level->size);
+    if (level->data == NULL
+        || fread(level->data, 1, level->size, file) != level->size) {
+        throw_error(ERROR_TYPE_LIBC);
+        free(level->data);
+        fclose(file);
+        return -1;
+    }
+
+    fclose(file);
+
+    return 0;
+}
+
+static void compiled_level_unload_lt(void *level)
+{
+    free(((CompiledLevel*) level)->data);
+}
+
+#else
+
+static void close_fd_lt(void *fd)
+{
+    close(*(int*) fd);
+}
+
+static int compiled_level_load(CompiledLevel *level, const char *file_name)
+{
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+    PUSH_LT(lt, &fd, close_fd_lt);
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) < 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    level->size = (size_t) file_stat.st_size;
+    if (level->size == 0) {
+        errno = EINVAL;
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    void *data = mmap(NULL, level->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+    level->data = data;
+
+    /* The mapping stays valid after the file is closed */
+    RETURN_LT(lt, 0);
+}
+
+static void compiled_level_unload_lt(void *level)
+{
+    munmap(((CompiledLevel*) level)->data, ((CompiledLevel*) level)->size);
+}
+
+#endif
+
+CompiledLevel *create_compiled_level_from_file(const char *file_name)
+{
+    assert(file_name);
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return NULL;
+    }
+
+    CompiledLevel *level = PUSH_LT(lt, malloc(sizeof(CompiledLevel)), free);
+    if (level == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+    level->lt = lt;
+
+    if (compiled_level_load(level, file_name) < 0) {
+        RETURN_LT(lt, NULL);
+    }
+    PUSH_LT(lt, level, compiled_level_unload_lt);
+
+    if (compiled_level_validate(level, file_name) < 0) {
+        errno = EINVAL;
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+
+    if (compiled_level_resolve_strings(level, file_name) < 0) {
+        RETURN_LT(lt, NULL);
+    }
+
+    return level;
+}
+
+void destroy_compiled_level(CompiledLevel *level)
+{
+    assert(level);
+    RETURN_LT0(level->lt);
+}
+
+size_t compiled_level_count(const CompiledLevel *level, LevelSection section)
+{
+    assert(level);
+    assert(section < LEVEL_SECTION_N);
+    return (size_t) level->header->sections[section].count;
+}
+
+const Point *compiled_level_points(const CompiledLevel *level, LevelSection section)
+{
+    assert(level);
+    return compiled_level_array(level, section, LEVEL_ARRAY_POINTS);
+}
+
+const Rect *compiled_level_rects(const CompiledLevel *level, LevelSection section)
+{
+    assert(level);
+    return compiled_level_array(level, section, LEVEL_ARRAY_RECTS);
+}
+
+const Color *compiled_level_colors(const CompiledLevel *level, LevelSection section)
+{
+    assert(level);
+    return compiled_level_array(level, section, LEVEL_ARRAY_COLORS);
+}
+
+const char *const *compiled_level_strings(const CompiledLevel *level, LevelSection section)
+{
+    assert(level);
+    assert(section < LEVEL_SECTION_N);
+    return level->strings[section];
+}
@@ -0,0 +1,109 @@
+#ifndef COMPILED_LEVEL_H_
+#define COMPILED_LEVEL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "color.h"
+#include "math/point.h"
+#include "math/rect.h"
+
+// Compiled level is a binary form of the level text file produced by
+// the level-compile tool. It is memory mapped as is: the sections
+// are packed arrays of the in-memory types, so loading it does not
+// involve any parsing. The numbers are stored in the byte order of
+// the machine that compiled the level.
+//
+// The file starts with struct LevelFormatHeader. Every section is
+// aligned to LEVEL_FORMAT_ALIGNMENT and stores `count` records as a
+// structure of arrays, in this order:
+//
+//   points  Point[count]     PLAYER, GOALS, LABELS
+//   rects   Rect[count]      PLATFORMS, GOALS, LAVA, BACK_PLATFORMS, BOXES, REGIONS
+//   colors  Color[count]     every section except REGIONS and STRINGS
+//   strings uint32_t[count]  GOALS (ids), BOXES (ids), LABELS (texts), REGIONS (scripts)
+//
+// Strings are offsets of NUL-terminated strings in the STRINGS
+// section, which is just `count` bytes of text.
+
+#define LEVEL_FORMAT_MAGIC "NOTHLVL"
+#define LEVEL_FORMAT_MAGIC_SIZE 8
+#define LEVEL_FORMAT_VERSION 1
+#define LEVEL_FORMAT_ALIGNMENT 8
+
+// Compiled world is a directory made by `level-compile --tile-size`
+// for levels too big to keep resident. The terrain (platforms, lava
+// and back platforms) is cut into square tiles by the top-left corner
+// of every rect and each non-empty tile is a compiled level of its
+// own. Everything else stays in the global level.
+//
+//   world.txt           <tile size> <margin>
+//                       <amount of tiles>
+//                       <tile x> <tile y>    sorted by y, then by x
+//   global.bin          the level without the terrain
+//   tile_<x>_<y>.bin    the terrain of the tile
+//
+// Margin is the biggest width or height of a terrain rect, so a rect
+// reaches at most that far out of its tile.
+
+#define WORLD_INDEX_FILE "world.txt"
+#define WORLD_GLOBAL_FILE "global.bin"
+#define WORLD_TILE_FILE_FORMAT "tile_%d_%d.bin"
+
+typedef enum LevelSection {
+    LEVEL_SECTION_BACKGROUND = 0,
+    LEVEL_SECTION_PLAYER,
+    LEVEL_SECTION_PLATFORMS,
+    LEVEL_SECTION_GOALS,
+    LEVEL_SECTION_LAVA,
+    LEVEL_SECTION_BACK_PLATFORMS,
+    LEVEL_SECTION_BOXES,
+    LEVEL_SECTION_LABELS,
+    LEVEL_SECTION_REGIONS,
+    LEVEL_SECTION_STRINGS,
+
+    LEVEL_SECTION_N
+} LevelSection;
+
+struct LevelFormatSection
+{
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct LevelFormatHeader
+{
+    char magic[LEVEL_FORMAT_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t section_count;
+    struct LevelFormatSection sections[LEVEL_SECTION_N];
+};
+
+enum LevelSectionArray
+{
+    LEVEL_ARRAY_POINTS = 1 << 0,
+    LEVEL_ARRAY_RECTS = 1 << 1,
+    LEVEL_ARRAY_COLORS = 1 << 2,
+    LEVEL_ARRAY_STRINGS = 1 << 3
+};
+
+// Mask of enum LevelSectionArray stored by the section
+unsigned int level_section_arrays(LevelSection section);
+// Size of one record of the section in bytes
+size_t level_section_record_size(LevelSection section);
+
+typedef struct CompiledLevel CompiledLevel;
+
+bool compiled_level_file_p(const char *file_name);
+// Validates the header and the bounds of every section and string
+CompiledLevel *create_compiled_level_from_file(const char *file_name);
+void destroy_compiled_level(CompiledLevel *level);
+
+size_t compiled_level_count(const CompiledLevel *level, LevelSection section);
+// Return NULL if the section does not store such an array
+const Point *compiled_level_points(const CompiledLevel *level, LevelSection section);
+const Rect *compiled_level_rects(const CompiledLevel *level, LevelSection section);
+const Color *compiled_level_colors(const CompiledLevel *level, LevelSection section);
+const char *const *compiled_level_strings(const CompiledLevel *level, LevelSection section);
+
+#endif  // COMPILED_LEVEL_H_
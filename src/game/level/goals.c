@@ -1,13 +1,14 @@
+#define _DEFAULT_SOURCE
+
 #include <SDL2/SDL.h>
 #include <assert.h>
 #include <math.h>
+#include <string.h>
 
 #include "goals.h"
 #include "math/pi.h"
 #include "math/triangle.h"
-#include "str.h"
-#include "system/error.h"
-#include "system/lt.h"
+#include "system/arena.h"
 #include "system/line_stream.h"
 
 #define GOAL_RADIUS 10.0f
@@ -22,7 +23,6 @@ typedef enum Cue_state {
 } Cue_state;
 
 struct Goals {
-    Lt *lt;
     char **ids;
     Point *points;
     Rect *regions;
@@ -33,102 +33,98 @@ struct Goals {
     float angle;
 };
 
-Goals *create_goals_from_line_stream(LineStream *line_stream)
+static Goals *alloc_goals(Arena *arena, size_t count)
 {
-    assert(line_stream);
-
-    Lt *const lt = create_lt();
-    if (lt == NULL) {
+    Goals *const goals = arena_alloc(arena, sizeof(Goals));
+    if (goals == NULL) {
         return NULL;
     }
 
-    Goals *const goals = PUSH_LT(lt, malloc(sizeof(Goals)), free);
-    if (goals == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
-    }
+    goals->count = count;
+    goals->angle = 0.0f;
 
-    goals->count = 0;
-    if (sscanf(
-            line_stream_next(line_stream),
-            "%lu",
-            &goals->count) == EOF) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    goals->ids = arena_alloc(arena, sizeof(char*) * count);
+    goals->points = arena_alloc(arena, sizeof(Point) * count);
+    goals->regions = arena_alloc(arena, sizeof(Rect) * count);
+    goals->colors = arena_alloc(arena, sizeof(Color) * count);
+    goals->cue_states = arena_alloc(arena, sizeof(Cue_state) * count);
+    char *const id_buffer = arena_alloc(arena, sizeof(char) * GOAL_MAX_ID_SIZE * count);
+    if (goals->ids == NULL
+        || goals->points == NULL
+        || goals->regions == NULL
+        || goals->colors == NULL
+        || goals->cue_states == NULL
+        || id_buffer == NULL) {
+        return NULL;
     }
 
-    goals->ids = PUSH_LT(
-        lt,
-        malloc(sizeof(char*) * goals->count),
-        free);
-    if (goals->ids == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
-    }
-    for (size_t i = 0; i < goals->count; ++i) {
-        goals->ids[i] = PUSH_LT(lt, malloc(sizeof(char) * GOAL_MAX_ID_SIZE), free);
-        if (goals->ids[i] == NULL) {
-            throw_error(ERROR_TYPE_LIBC);
-            RETURN_LT(lt, NULL);
-        }
+    for (size_t i = 0; i < count; ++i) {
+        goals->ids[i] = id_buffer + i * GOAL_MAX_ID_SIZE;
+        goals->cue_states[i] = CUE_STATE_VIRGIN;
     }
 
-    goals->points = PUSH_LT(lt, malloc(sizeof(Point) * goals->count), free);
-    if (goals->points == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    return goals;
+}
+
+Goals *create_goals(Arena *arena,
+                    const char *const *ids,
+                    const Point *points,
+                    const Rect *regions,
+                    const Color *colors,
+                    size_t count)
+{
+    assert(arena);
+    assert(ids || count == 0);
+    assert(points || count == 0);
+    assert(regions || count == 0);
+    assert(colors || count == 0);
+
+    Goals *const goals = alloc_goals(arena, count);
+    if (goals == NULL) {
+        return NULL;
     }
 
-    goals->regions = PUSH_LT(lt, malloc(sizeof(Rect) * goals->count), free);
-    if (goals->regions == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t id_size = strnlen(ids[i], GOAL_MAX_ID_SIZE - 1);
+        memcpy(goals->ids[i], ids[i], id_size);
+        goals->ids[i][id_size] = 0;
+        goals->points[i] = points[i];
+        goals->regions[i] = regions[i];
+        goals->colors[i] = colors[i];
     }
 
-    goals->colors = PUSH_LT(lt, malloc(sizeof(Color) * goals->count), free);
-    if (goals->colors == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    return goals;
+}
+
+Goals *create_goals_from_line_stream(Arena *arena, LineStream *line_stream)
+{
+    assert(arena);
+    assert(line_stream);
+
+    size_t count = 0;
+    if (line_stream_read_count(line_stream, &count) < 0
+        || line_stream_end_line(line_stream) < 0) {
+        return NULL;
     }
 
-    goals->cue_states = PUSH_LT(lt, malloc(sizeof(int) * goals->count), free);
-    if (goals->cue_states == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    Goals *const goals = alloc_goals(arena, count);
+    if (goals == NULL) {
+        return NULL;
     }
 
-    char color[7];
-    for (size_t i = 0; i < goals->count; ++i) {
-        if (sscanf(
-                line_stream_next(line_stream),
-                "%" STRINGIFY(GOAL_MAX_ID_SIZE) "s%f%f%f%f%f%f%6s",
-                goals->ids[i],
-                &goals->points[i].x,
-                &goals->points[i].y,
-                &goals->regions[i].x,
-                &goals->regions[i].y,
-                &goals->regions[i].w,
-                &goals->regions[i].h,
-                color) < 0) {
-            throw_error(ERROR_TYPE_LIBC);
-            RETURN_LT(lt, NULL);
+    for (size_t i = 0; i < count; ++i) {
+        if (line_stream_read_word(line_stream, goals->ids[i], GOAL_MAX_ID_SIZE) < 0
+            || line_stream_read_point(line_stream, &goals->points[i]) < 0
+            || line_stream_read_rect(line_stream, &goals->regions[i]) < 0
+            || line_stream_read_color(line_stream, &goals->colors[i]) < 0
+            || line_stream_end_line(line_stream) < 0) {
+            return NULL;
         }
-        goals->colors[i] = color_from_hexstr(color);
-        goals->cue_states[i] = CUE_STATE_VIRGIN;
     }
 
-    goals->lt = lt;
-    goals->angle = 0.0f;
-
     return goals;
 }
 
-void destroy_goals(Goals *goals)
-{
-    assert(goals);
-    RETURN_LT0(goals->lt);
-}
-
 static int goals_render_core(const Goals *goals,
                              size_t goal_index,
                              Camera *camera)
@@ -254,3 +250,38 @@ static int goals_is_goal_hidden(const Goals *goals, size_t i)
 {
     return rects_overlap(goals->regions[i], goals->player_hitbox);
 }
+
+size_t goals_count(const Goals *goals)
+{
+    assert(goals);
+    return goals->count;
+}
+
+int goals_patch(Goals *goals, const Goals *source)
+{
+    assert(goals);
+    assert(source);
+
+    if (goals->count != source->count) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < goals->count; ++i) {
+        if (strcmp(goals->ids[i], source->ids[i]) == 0
+            && memcmp(&goals->points[i], &source->points[i], sizeof(Point)) == 0
+            && memcmp(&goals->regions[i], &source->regions[i], sizeof(Rect)) == 0
+            && memcmp(&goals->colors[i], &source->colors[i], sizeof(Color)) == 0) {
+            continue;
+        }
+
+        const size_t id_size = strnlen(source->ids[i], GOAL_MAX_ID_SIZE - 1);
+        memcpy(goals->ids[i], source->ids[i], id_size);
+        goals->ids[i][id_size] = 0;
+        goals->points[i] = source->points[i];
+        goals->regions[i] = source->regions[i];
+        goals->colors[i] = source->colors[i];
+        goals->cue_states[i] = CUE_STATE_VIRGIN;
+    }
+
+    return 0;
+}
@@ -9,9 +9,15 @@
 
 typedef struct Goals Goals;
 typedef struct LineStream LineStream;
+typedef struct Arena Arena;
 
-Goals *create_goals_from_line_stream(LineStream *line_stream);
-void destroy_goals(Goals *goals);
+Goals *create_goals(Arena *arena,
+                    const char *const *ids,
+                    const Point *points,
+                    const Rect *regions,
+                    const Color *colors,
+                    size_t count);
+Goals *create_goals_from_line_stream(Arena *arena, LineStream *line_stream);
 
 Rect goals_hitbox(const Goals *goals);
 
@@ -28,4 +34,10 @@ void goals_checkpoint(const Goals *goals,
 void goals_cue(Goals *goals,
                const Camera *camera);
 
+size_t goals_count(const Goals *goals);
+
+// Copies the changed goals of source over the live ones, the
+// unchanged goals keep their cue state
+int goals_patch(Goals *goals, const Goals *source);
+
 #endif  // GOALS_H_
@@ -1,15 +1,15 @@
 #include <assert.h>
+#include <string.h>
 
 #include "game/camera.h"
 #include "game/level/labels.h"
+#include "system/arena.h"
 #include "system/error.h"
-#include "system/lt.h"
 #include "str.h"
 #include "system/line_stream.h"
 
 struct Labels
 {
-    Lt *lt;
     size_t count;
     Vec *positions;
     Color *colors;
@@ -18,91 +18,97 @@ struct Labels
     int *visible;
 };
 
-Labels *create_labels_from_line_stream(LineStream *line_stream)
+static Labels *alloc_labels(Arena *arena, size_t count)
 {
-    assert(line_stream);
-
-    Lt *const lt = create_lt();
-    if (lt == NULL) {
-        return NULL;
-    }
-
-    Labels * const labels = PUSH_LT(lt, malloc(sizeof(Labels)), free);
+    Labels * const labels = arena_alloc(arena, sizeof(Labels));
     if (labels == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+        return NULL;
     }
-    labels->lt = lt;
-
-    if (sscanf(
-            line_stream_next(line_stream),
-            "%lu",
-            &labels->count) == EOF) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    labels->count = count;
+
+    labels->positions = arena_alloc(arena, sizeof(Vec) * count);
+    labels->colors = arena_alloc(arena, sizeof(Color) * count);
+    labels->texts = arena_alloc(arena, sizeof(char*) * count);
+    labels->states = arena_alloc(arena, sizeof(float) * count);
+    labels->visible = arena_alloc(arena, sizeof(int) * count);
+    if (labels->positions == NULL
+        || labels->colors == NULL
+        || labels->texts == NULL
+        || labels->states == NULL
+        || labels->visible == NULL) {
+        return NULL;
     }
 
-    labels->positions = PUSH_LT(lt, malloc(sizeof(Vec) * labels->count), free);
-    if (labels->positions == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    for (size_t i = 0; i < count; ++i) {
+        labels->states[i] = 1.0f;
+        labels->visible[i] = 0;
+        labels->texts[i] = NULL;
     }
 
-    labels->colors = PUSH_LT(lt, malloc(sizeof(Color) * labels->count), free);
-    if (labels->colors == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
-    }
+    return labels;
+}
+
+Labels *create_labels(Arena *arena,
+                      const Vec *positions,
+                      const Color *colors,
+                      const char *const *texts,
+                      size_t count)
+{
+    assert(arena);
+    assert(positions || count == 0);
+    assert(colors || count == 0);
+    assert(texts || count == 0);
 
-    labels->texts = PUSH_LT(lt, malloc(sizeof(char*) * labels->count), free);
-    if (labels->texts == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    Labels * const labels = alloc_labels(arena, count);
+    if (labels == NULL) {
+        return NULL;
     }
 
-    labels->states = PUSH_LT(lt, malloc(sizeof(float) * labels->count), free);
-    if (labels->states == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    for (size_t i = 0; i < count; ++i) {
+        labels->positions[i] = positions[i];
+        labels->colors[i] = colors[i];
+
+        labels->texts[i] = arena_string_duplicate(arena, texts[i]);
+        if (labels->texts[i] == NULL) {
+            return NULL;
+        }
     }
 
-    labels->visible = PUSH_LT(lt, malloc(sizeof(int) * labels->count), free);
-    if (labels->visible == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    return labels;
+}
+
+Labels *create_labels_from_line_stream(Arena *arena, LineStream *line_stream)
+{
+    assert(arena);
+    assert(line_stream);
+
+    size_t count = 0;
+    if (line_stream_read_count(line_stream, &count) < 0
+        || line_stream_end_line(line_stream) < 0) {
+        return NULL;
     }
 
-    char color[7];
-    for (size_t i = 0; i < labels->count; ++i) {
-        labels->states[i] = 1.0f;
-        labels->visible[i] = 0;
-        labels->texts[i] = NULL;
+    Labels * const labels = alloc_labels(arena, count);
+    if (labels == NULL) {
+        return NULL;
+    }
 
-        if (sscanf(
-                line_stream_next(line_stream),
-                "%f%f%6s\n",
-                &labels->positions[i].x,
-                &labels->positions[i].y,
-                color) == EOF) {
-            throw_error(ERROR_TYPE_LIBC);
-            RETURN_LT(lt, NULL);
+    for (size_t i = 0; i < count; ++i) {
+        if (line_stream_read_point(line_stream, &labels->positions[i]) < 0
+            || line_stream_read_color(line_stream, &labels->colors[i]) < 0
+            || line_stream_end_line(line_stream) < 0) {
+            return NULL;
         }
 
-        labels->colors[i] = color_from_hexstr(color);
-
         const char *label_text = line_stream_next(line_stream);
         if (label_text == NULL) {
             throw_error(ERROR_TYPE_LIBC);
-            RETURN_LT(lt, NULL);
+            return NULL;
         }
 
-        labels->texts[i] = PUSH_LT(
-            lt,
-            string_duplicate(label_text, NULL),
-            free);
+        labels->texts[i] = arena_string_duplicate(arena, label_text);
         if (labels->texts[i] == NULL) {
-            throw_error(ERROR_TYPE_LIBC);
-            RETURN_LT(lt, NULL);
+            return NULL;
         }
 
         trim_endline(labels->texts[i]);
@@ -111,12 +117,6 @@ Labels *create_labels_from_line_stream(LineStream *line_stream)
     return labels;
 }
 
-void destroy_labels(Labels *label)
-{
-    assert(label);
-    RETURN_LT0(label->lt);
-}
-
 int labels_render(const Labels *label,
                  Camera *camera)
 {
@@ -176,3 +176,40 @@ void labels_enter_camera_event(Labels *labels,
         labels->visible[i] = became_visible;
     }
 }
+
+size_t labels_count(const Labels *labels)
+{
+    assert(labels);
+    return labels->count;
+}
+
+int labels_patch(Labels *labels, const Labels *source)
+{
+    assert(labels);
+    assert(source);
+
+    if (labels->count != source->count) {
+        return -1;
+    }
+
+    /* The texts live in the arena of the level and cannot grow */
+    for (size_t i = 0; i < labels->count; ++i) {
+        if (strcmp(labels->texts[i], source->texts[i]) != 0) {
+            return -1;
+        }
+    }
+
+    for (size_t i = 0; i < labels->count; ++i) {
+        if (memcmp(&labels->positions[i], &source->positions[i], sizeof(Vec)) == 0
+            && memcmp(&labels->colors[i], &source->colors[i], sizeof(Color)) == 0) {
+            continue;
+        }
+
+        labels->positions[i] = source->positions[i];
+        labels->colors[i] = source->colors[i];
+        /* Let the changed label pop up again */
+        labels->states[i] = 0.0f;
+    }
+
+    return 0;
+}
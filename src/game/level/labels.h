@@ -7,9 +7,14 @@
 typedef struct Labels Labels;
 typedef struct Camera Camera;
 typedef struct LineStream LineStream;
+typedef struct Arena Arena;
 
-Labels *create_labels_from_line_stream(LineStream *line_stream);
-void destroy_labels(Labels *label);
+Labels *create_labels(Arena *arena,
+                      const Vec *positions,
+                      const Color *colors,
+                      const char *const *texts,
+                      size_t count);
+Labels *create_labels_from_line_stream(Arena *arena, LineStream *line_stream);
 
 int labels_render(const Labels *label,
                   Camera *camera);
@@ -18,4 +23,11 @@ void labels_update(Labels *label,
 void labels_enter_camera_event(Labels *label,
                                const Camera *camera);
 
+size_t labels_count(const Labels *labels);
+
+// Moves and recolors the changed labels of source. Fails without
+// touching anything if the amount of labels or any of the texts
+// changed.
+int labels_patch(Labels *labels, const Labels *source);
+
 #endif  // LABELS_H_
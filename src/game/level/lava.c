@@ -7,63 +7,77 @@
 #include "game/level/player/rigid_rect.h"
 #include "lava.h"
 #include "math/rect.h"
-#include "system/error.h"
-#include "system/lt.h"
+#include "system/arena.h"
 #include "system/line_stream.h"
 
 #define LAVA_BOINGNESS 2500.0f
 
 struct Lava {
-    Lt *lt;
     size_t rects_count;
     Wavy_rect **rects;
 };
 
-Lava *create_lava_from_line_stream(LineStream *line_stream)
+static Lava *alloc_lava(Arena *arena, size_t count)
 {
-    assert(line_stream);
-
-    Lt *lt = create_lt();
-    if (lt == NULL) {
+    Lava *lava = arena_alloc(arena, sizeof(Lava));
+    if (lava == NULL) {
         return NULL;
     }
 
-    Lava *lava = PUSH_LT(lt, malloc(sizeof(Lava)), free);
-    if (lava == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    lava->rects_count = count;
+    lava->rects = arena_alloc(arena, sizeof(Wavy_rect*) * count);
+    if (lava->rects == NULL) {
+        return NULL;
     }
 
-    if (sscanf(
-            line_stream_next(line_stream),
-            "%lu",
-            &lava->rects_count) < 0) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
-    }
+    return lava;
+}
 
-    lava->rects = PUSH_LT(lt, malloc(sizeof(Wavy_rect*) * lava->rects_count), free);
-    if (lava->rects == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+Lava *create_lava(Arena *arena, const Rect *rects, const Color *colors, size_t count)
+{
+    assert(arena);
+    assert(rects || count == 0);
+    assert(colors || count == 0);
+
+    Lava *lava = alloc_lava(arena, count);
+    if (lava == NULL) {
+        return NULL;
     }
 
-    for (size_t i = 0; i < lava->rects_count; ++i) {
-        lava->rects[i] = PUSH_LT(lt, create_wavy_rect_from_line_stream(line_stream), destroy_wavy_rect);
+    for (size_t i = 0; i < count; ++i) {
+        lava->rects[i] = create_wavy_rect(arena, rects[i], colors[i]);
         if (lava->rects[i] == NULL) {
-            RETURN_LT(lt, NULL);
+            return NULL;
         }
     }
 
-    lava->lt = lt;
-
     return lava;
 }
 
-void destroy_lava(Lava *lava)
+Lava *create_lava_from_line_stream(Arena *arena, LineStream *line_stream)
 {
-    assert(lava);
-    RETURN_LT0(lava->lt);
+    assert(arena);
+    assert(line_stream);
+
+    size_t count = 0;
+    if (line_stream_read_count(line_stream, &count) < 0
+        || line_stream_end_line(line_stream) < 0) {
+        return NULL;
+    }
+
+    Lava *lava = alloc_lava(arena, count);
+    if (lava == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        lava->rects[i] = create_wavy_rect_from_line_stream(arena, line_stream);
+        if (lava->rects[i] == NULL) {
+            return NULL;
+        }
+    }
+
+    return lava;
 }
 
 /* TODO(#449): lava does not render its id in debug mode */
@@ -126,3 +140,25 @@ void lava_float_rigid_rect(Lava *lava, Rigid_rect *object)
         }
     }
 }
+
+size_t lava_count(const Lava *lava)
+{
+    assert(lava);
+    return lava->rects_count;
+}
+
+int lava_patch(Lava *lava, const Lava *source)
+{
+    assert(lava);
+    assert(source);
+
+    if (lava->rects_count != source->rects_count) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < lava->rects_count; ++i) {
+        wavy_rect_patch(lava->rects[i], source->rects[i]);
+    }
+
+    return 0;
+}
@@ -9,9 +9,10 @@
 typedef struct Lava Lava;
 typedef struct Rigid_rect Rigid_rect;
 typedef struct LineStream LineStream;
+typedef struct Arena Arena;
 
-Lava *create_lava_from_line_stream(LineStream *line_stream);
-void destroy_lava(Lava *lava);
+Lava *create_lava(Arena *arena, const Rect *rects, const Color *colors, size_t count);
+Lava *create_lava_from_line_stream(Arena *arena, LineStream *line_stream);
 
 int lava_render(const Lava *lava,
                 Camera *camera);
@@ -21,4 +22,8 @@ bool lava_overlaps_rect(const Lava *lava, Rect rect);
 
 void lava_float_rigid_rect(Lava *lava, Rigid_rect *rigid_rect);
 
+size_t lava_count(const Lava *lava);
+
+int lava_patch(Lava *lava, const Lava *source);
+
 #endif  // LAVA_H_
@@ -5,68 +5,49 @@
 #include <time.h>
 
 #include "math/pi.h"
-#include "system/error.h"
+#include "system/arena.h"
 #include "system/line_stream.h"
-#include "system/lt.h"
 #include "wavy_rect.h"
 
 #define WAVE_PILLAR_WIDTH 10.0f
 
 struct Wavy_rect
 {
-    Lt *lt;
-
     Rect rect;
     Color color;
     float angle;
 };
 
-Wavy_rect *create_wavy_rect(Rect rect, Color color)
+Wavy_rect *create_wavy_rect(Arena *arena, Rect rect, Color color)
 {
-    Lt *lt = create_lt();
-    if (lt == NULL) {
-        return NULL;
-    }
+    assert(arena);
 
-    Wavy_rect *wavy_rect = PUSH_LT(lt, malloc(sizeof(Wavy_rect)), free);
+    Wavy_rect *wavy_rect = arena_alloc(arena, sizeof(Wavy_rect));
     if (wavy_rect == NULL) {
-        throw_error(ERROR_TYPE_SDL2);
-        RETURN_LT(lt, NULL);
+        return NULL;
     }
 
     wavy_rect->rect = rect;
     wavy_rect->color = color;
     wavy_rect->angle = 0.0f;
-    wavy_rect->lt = lt;
 
     return wavy_rect;
 }
 
-Wavy_rect *create_wavy_rect_from_line_stream(LineStream *line_stream)
+Wavy_rect *create_wavy_rect_from_line_stream(Arena *arena, LineStream *line_stream)
 {
+    assert(arena);
     assert(line_stream);
-    char color_name[7];
     Rect rect;
+    Color color;
 
-    if (sscanf(
-            line_stream_next(line_stream),
-            "%f%f%f%f%6s\n",
-            &rect.x, &rect.y,
-            &rect.w, &rect.h,
-            color_name) < 0) {
-        throw_error(ERROR_TYPE_LIBC);
+    if (line_stream_read_rect(line_stream, &rect) < 0
+        || line_stream_read_color(line_stream, &color) < 0
+        || line_stream_end_line(line_stream) < 0) {
         return NULL;
     }
 
-    Color color = color_from_hexstr(color_name);
-
-    return create_wavy_rect(rect, color);
-}
-
-void destroy_wavy_rect(Wavy_rect *wavy_rect)
-{
-    assert(wavy_rect);
-    RETURN_LT0(wavy_rect->lt);
+    return create_wavy_rect(arena, rect, color);
 }
 
 int wavy_rect_render(const Wavy_rect *wavy_rect,
@@ -110,3 +91,12 @@ Rect wavy_rect_hitbox(const Wavy_rect *wavy_rect)
 {
     return wavy_rect->rect;
 }
+
+void wavy_rect_patch(Wavy_rect *wavy_rect, const Wavy_rect *source)
+{
+    assert(wavy_rect);
+    assert(source);
+
+    wavy_rect->rect = source->rect;
+    wavy_rect->color = source->color;
+}
@@ -9,10 +9,10 @@
 
 typedef struct Wavy_rect Wavy_rect;
 typedef struct LineStream LineStream;
+typedef struct Arena Arena;
 
-Wavy_rect *create_wavy_rect(Rect rect, Color color);
-Wavy_rect *create_wavy_rect_from_line_stream(LineStream *line_stream);
-void destroy_wavy_rect(Wavy_rect *wavy_rect);
+Wavy_rect *create_wavy_rect(Arena *arena, Rect rect, Color color);
+Wavy_rect *create_wavy_rect_from_line_stream(Arena *arena, LineStream *line_stream);
 
 int wavy_rect_render(const Wavy_rect *wavy_rect,
                      Camera *camera);
@@ -21,4 +21,7 @@ int wavy_rect_update(Wavy_rect *wavy_rect,
 
 Rect wavy_rect_hitbox(const Wavy_rect *wavy_rect);
 
+// Takes the shape of source keeping the phase of the wave
+void wavy_rect_patch(Wavy_rect *wavy_rect, const Wavy_rect *source);
+
 #endif  // WAVY_RECT_H_
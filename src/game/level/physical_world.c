@@ -12,6 +12,7 @@
 struct Physical_world
 {
     Lt *lt;
+    Lt_frame solids_frame;
     size_t capacity;
     size_t size;
     Solid_ref *solids;
@@ -32,10 +33,11 @@ Physical_world *create_physical_world(void)
     }
 
     physical_world->solids =
-        PUSH_LT(
+        PUSH_LT_FRAME(
             lt,
             malloc(sizeof(Solid_ref) * PHYSICAL_WORLD_CAPACITY),
-            free);
+            free,
+            &physical_world->solids_frame);
     if (physical_world->solids == NULL) {
         throw_error(ERROR_TYPE_LIBC);
         RETURN_LT(lt, NULL);
@@ -63,15 +65,27 @@ void physical_world_apply_gravity(Physical_world *physical_world)
     }
 }
 
+static void physical_world_collide_platforms(Solid_ref solid,
+                                             Platforms *const *platforms,
+                                             size_t platforms_count)
+{
+    for (size_t k = 0; k < platforms_count; ++k) {
+        solid_collide_with_solid(solid, platforms_as_solid(platforms[k]));
+    }
+}
+
 void physical_world_collide_solids(Physical_world *physical_world,
-                                   Platforms *platforms)
+                                   Platforms *const *platforms,
+                                   size_t platforms_count)
 {
     assert(physical_world);
+    assert(platforms || platforms_count == 0);
 
     for (size_t i = 0; i < physical_world->size; ++i) {
-        solid_collide_with_solid(
+        physical_world_collide_platforms(
             physical_world->solids[i],
-            platforms_as_solid(platforms));
+            platforms,
+            platforms_count);
 
         for (size_t j = 0; j < physical_world->size; ++j) {
             if (i != j) {
@@ -81,9 +95,10 @@ void physical_world_collide_solids(Physical_world *physical_world,
             }
         }
 
-        solid_collide_with_solid(
+        physical_world_collide_platforms(
             physical_world->solids[i],
-            platforms_as_solid(platforms));
+            platforms,
+            platforms_count);
     }
 }
 
@@ -103,9 +118,9 @@ int physical_world_add_solid(Physical_world *physical_world,
         }
 
         physical_world->capacity = new_capacity;
-        physical_world->solids = REPLACE_LT(
+        physical_world->solids = REPLACE_LT_FRAME(
             physical_world->lt,
-            physical_world->solids,
+            physical_world->solids_frame,
             new_solids);
     }
 
@@ -10,7 +10,8 @@ void destroy_physical_world(Physical_world *physical_world);
 
 void physical_world_apply_gravity(Physical_world *physical_world);
 void physical_world_collide_solids(Physical_world *physical_world,
-                                   Platforms *platforms);
+                                   Platforms *const *platforms,
+                                   size_t platforms_count);
 int physical_world_add_solid(Physical_world *physical_world,
                              Solid_ref solid);
 void physical_world_clean(Physical_world *physical_world);
@@ -5,79 +5,81 @@
 #include <string.h>
 
 #include "platforms.h"
+#include "system/arena.h"
 #include "system/error.h"
 #include "system/lt.h"
 #include "system/lt/lt_adapters.h"
 #include "system/line_stream.h"
 
 struct Platforms {
-    Lt *lt;
-
     Rect *rects;
     Color *colors;
     size_t rects_size;
 };
 
-Platforms *create_platforms_from_line_stream(LineStream *line_stream)
+static Platforms *alloc_platforms(Arena *arena, size_t count)
 {
-    assert(line_stream);
+    Platforms *platforms = arena_alloc(arena, sizeof(Platforms));
+    if (platforms == NULL) {
+        return NULL;
+    }
 
-    Lt *const lt = create_lt();
-    if (lt == NULL) {
+    platforms->rects_size = count;
+    platforms->rects = arena_alloc(arena, sizeof(Rect) * count);
+    platforms->colors = arena_alloc(arena, sizeof(Color) * count);
+    if (platforms->rects == NULL || platforms->colors == NULL) {
         return NULL;
     }
 
-    Platforms *platforms = PUSH_LT(lt, malloc(sizeof(Platforms)), free);
+    return platforms;
+}
+
+Platforms *create_platforms(Arena *arena, const Rect *rects, const Color *colors, size_t count)
+{
+    assert(arena);
+    assert(rects || count == 0);
+    assert(colors || count == 0);
+
+    Platforms *platforms = alloc_platforms(arena, count);
     if (platforms == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+        return NULL;
     }
 
-    platforms->rects_size = 0;
-    if (sscanf(
-            line_stream_next(line_stream),
-            "%lu",
-            &platforms->rects_size) == EOF) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    if (count > 0) {
+        memcpy(platforms->rects, rects, sizeof(Rect) * count);
+        memcpy(platforms->colors, colors, sizeof(Color) * count);
     }
 
-    platforms->rects = PUSH_LT(lt, malloc(sizeof(Rect) * platforms->rects_size), free);
-    if (platforms->rects == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    return platforms;
+}
+
+Platforms *create_platforms_from_line_stream(Arena *arena, LineStream *line_stream)
+{
+    assert(arena);
+    assert(line_stream);
+
+    size_t count = 0;
+    if (line_stream_read_count(line_stream, &count) < 0
+        || line_stream_end_line(line_stream) < 0) {
+        return NULL;
     }
 
-    platforms->colors = PUSH_LT(lt, malloc(sizeof(Color) * platforms->rects_size), free);
-    if (platforms->colors == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+    Platforms *platforms = alloc_platforms(arena, count);
+    if (platforms == NULL) {
+        return NULL;
     }
 
-    char color[7];
-    for (size_t i = 0; i < platforms->rects_size; ++i) {
-        if (sscanf(line_stream_next(line_stream),
-                   "%f%f%f%f%6s\n",
-                   &platforms->rects[i].x, &platforms->rects[i].y,
-                   &platforms->rects[i].w, &platforms->rects[i].h,
-                   color) < 0) {
-            throw_error(ERROR_TYPE_LIBC);
-            RETURN_LT(lt, NULL);
+    for (size_t i = 0; i < count; ++i) {
+        if (line_stream_read_rect(line_stream, &platforms->rects[i]) < 0
+            || line_stream_read_color(line_stream, &platforms->colors[i]) < 0
+            || line_stream_end_line(line_stream) < 0) {
+            return NULL;
         }
-        platforms->colors[i] = color_from_hexstr(color);
     }
 
-    platforms->lt = lt;
-
     return platforms;
 }
 
-void destroy_platforms(Platforms *platforms)
-{
-    assert(platforms);
-    RETURN_LT0(platforms->lt);
-}
-
 int platforms_save_to_file(const Platforms *platforms,
                            const char *filename)
 {
@@ -145,3 +147,33 @@ void platforms_touches_rect_sides(const Platforms *platforms,
         rect_object_impact(object, platforms->rects[i], sides);
     }
 }
+
+size_t platforms_count(const Platforms *platforms)
+{
+    assert(platforms);
+    return platforms->rects_size;
+}
+
+Rect platforms_rect(const Platforms *platforms, size_t i)
+{
+    assert(platforms);
+    assert(i < platforms->rects_size);
+    return platforms->rects[i];
+}
+
+int platforms_patch(Platforms *platforms, const Platforms *source)
+{
+    assert(platforms);
+    assert(source);
+
+    if (platforms->rects_size != source->rects_size) {
+        return -1;
+    }
+
+    if (platforms->rects_size > 0) {
+        memcpy(platforms->rects, source->rects, sizeof(Rect) * source->rects_size);
+        memcpy(platforms->colors, source->colors, sizeof(Color) * source->rects_size);
+    }
+
+    return 0;
+}
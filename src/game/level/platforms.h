@@ -9,9 +9,11 @@
 
 typedef struct Platforms Platforms;
 typedef struct LineStream LineStream;
+typedef struct Arena Arena;
 
-Platforms *create_platforms_from_line_stream(LineStream *line_stream);
-void destroy_platforms(Platforms *platforms);
+// Platforms live in the arena and go away together with it
+Platforms *create_platforms(Arena *arena, const Rect *rects, const Color *colors, size_t count);
+Platforms *create_platforms_from_line_stream(Arena *arena, LineStream *line_stream);
 
 Solid_ref platforms_as_solid(Platforms *platforms);
 
@@ -25,4 +27,11 @@ void platforms_touches_rect_sides(const Platforms *platforms,
                                   Rect object,
                                   int sides[RECT_SIDE_N]);
 
+size_t platforms_count(const Platforms *platforms);
+Rect platforms_rect(const Platforms *platforms, size_t i);
+
+// Copies the platforms of source over the live ones in place. Fails
+// without touching anything if the amount of platforms changed.
+int platforms_patch(Platforms *platforms, const Platforms *source);
+
 #endif  // PLATFORMS_H_
@@ -9,6 +9,7 @@
 #include "math/point.h"
 #include "platforms.h"
 #include "player.h"
+#include "system/arena.h"
 #include "system/error.h"
 #include "system/lt.h"
 #include "system/line_stream.h"
@@ -19,6 +20,7 @@
 #define PLAYER_JUMP 32000.0f
 #define PLAYER_DEATH_DURATION 0.75f
 #define PLAYER_MAX_JUMP_COUNT 2
+#define PLAYER_ARENA_SIZE 256
 
 typedef enum Player_state {
     PLAYER_STATE_ALIVE = 0,
@@ -56,13 +58,18 @@ Player *create_player(float x, float y, Color color)
 
     player->state = PLAYER_STATE_ALIVE;
 
-    player->alive_body = PUSH_LT(
-        lt,
-        create_rigid_rect(
-            rect(x, y, PLAYER_WIDTH, PLAYER_HEIGHT),
-            color,
-            "player"),
-        destroy_rigid_rect);
+    /* The player outlives the arena of the level on reloads, so it
+     * has its own */
+    Arena *arena = PUSH_LT(lt, create_arena(PLAYER_ARENA_SIZE), destroy_arena);
+    if (arena == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    player->alive_body = create_rigid_rect(
+        arena,
+        rect(x, y, PLAYER_WIDTH, PLAYER_HEIGHT),
+        color,
+        "player");
     if (player->alive_body == NULL) {
         RETURN_LT(lt, NULL);
     }
@@ -88,18 +95,16 @@ Player *create_player(float x, float y, Color color)
 
 Player *create_player_from_line_stream(LineStream *line_stream)
 {
-    float x = 0.0f, y = 0.0f;
-    char color[7];
+    Point position;
+    Color color;
 
-    if (sscanf(
-            line_stream_next(line_stream),
-            "%f%f%6s",
-            &x, &y, color) == EOF) {
-        throw_error(ERROR_TYPE_LIBC);
+    if (line_stream_read_point(line_stream, &position) < 0
+        || line_stream_read_color(line_stream, &color) < 0
+        || line_stream_end_line(line_stream) < 0) {
         return NULL;
     }
 
-    return create_player(x, y, color_from_hexstr(color));
+    return create_player(position.x, position.y, color);
 }
 
 void destroy_player(Player * player)
@@ -244,6 +249,12 @@ void player_focus_camera(Player *player,
             vec(0.0f, -player_hitbox.h * 0.5f)));
 }
 
+Rect player_hitbox(const Player *player)
+{
+    assert(player);
+    return rigid_rect_hitbox(player->alive_body);
+}
+
 void player_hide_goals(const Player *player,
                        Goals *goals)
 {
@@ -42,6 +42,8 @@ void player_die(Player *player);
 
 void player_focus_camera(Player *player,
                          Camera *camera);
+Rect player_hitbox(const Player *player);
+
 void player_hide_goals(const Player *player,
                        Goals *goal);
 void player_die_from_lava(Player *player,
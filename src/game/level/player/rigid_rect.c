@@ -7,15 +7,11 @@
 #include "game/level/boxes.h"
 #include "game/level/solid.h"
 #include "rigid_rect.h"
-#include "str.h"
-#include "system/error.h"
-#include "system/lt.h"
-#include "system/line_stream.h"
+#include "system/arena.h"
 
 #define RIGID_RECT_MAX_ID_SIZE 36
 
 struct Rigid_rect {
-    Lt *lt;
     char *id;
     Vec position;
     Vec velocity;
@@ -51,27 +47,19 @@ static Vec opposing_force_by_sides(int sides[RECT_SIDE_N])
     return opposing_force;
 }
 
-Rigid_rect *create_rigid_rect(Rect rect, Color color, const char *id)
+Rigid_rect *create_rigid_rect(Arena *arena, Rect rect, Color color, const char *id)
 {
+    assert(arena);
     assert(id);
 
-    Lt *lt = create_lt();
-
-    if (lt == NULL) {
-        return NULL;
-    }
-
-    Rigid_rect *rigid_rect = PUSH_LT(lt, malloc(sizeof(Rigid_rect)), free);
+    Rigid_rect *rigid_rect = arena_alloc(arena, sizeof(Rigid_rect));
     if (rigid_rect == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+        return NULL;
     }
-    rigid_rect->lt = lt;
 
-    rigid_rect->id = malloc(sizeof(char) * RIGID_RECT_MAX_ID_SIZE);
+    rigid_rect->id = arena_alloc(arena, sizeof(char) * RIGID_RECT_MAX_ID_SIZE);
     if (rigid_rect->id == NULL) {
-        throw_error(ERROR_TYPE_LIBC);
-        RETURN_LT(lt, NULL);
+        return NULL;
     }
 
     const size_t _len = strlen(id);
@@ -90,30 +78,15 @@ Rigid_rect *create_rigid_rect(Rect rect, Color color, const char *id)
     return rigid_rect;
 }
 
-Rigid_rect *create_rigid_rect_from_line_stream(LineStream *line_stream)
+void rigid_rect_patch(Rigid_rect *rigid_rect, const Rigid_rect *source)
 {
-    assert(line_stream);
-
-    char color[7];
-    Rect rect;
-    char id[RIGID_RECT_MAX_ID_SIZE];
-
-    if (sscanf(line_stream_next(line_stream),
-               "%" STRINGIFY(RIGID_RECT_MAX_ID_SIZE) "s%f%f%f%f%6s\n",
-               id,
-               &rect.x, &rect.y,
-               &rect.w, &rect.h,
-               color) < 0) {
-        throw_error(ERROR_TYPE_LIBC);
-        return NULL;
-    }
-
-    return create_rigid_rect(rect, color_from_hexstr(color), id);
-}
+    assert(rigid_rect);
+    assert(source);
 
-void destroy_rigid_rect(Rigid_rect *rigid_rect)
-{
-    RETURN_LT0(rigid_rect->lt);
+    char *const id = rigid_rect->id;
+    *rigid_rect = *source;
+    rigid_rect->id = id;
+    memcpy(rigid_rect->id, source->id, RIGID_RECT_MAX_ID_SIZE);
 }
 
 Solid_ref rigid_rect_as_solid(Rigid_rect *rigid_rect)
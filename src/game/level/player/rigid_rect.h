@@ -11,11 +11,11 @@
 
 typedef struct Rigid_rect Rigid_rect;
 typedef struct Boxes Boxes;
-typedef struct LineStream LineStream;
+typedef struct Arena Arena;
 
-Rigid_rect *create_rigid_rect(Rect rect, Color color, const char *id);
-Rigid_rect *create_rigid_rect_from_line_stream(LineStream *line_stream);
-void destroy_rigid_rect(Rigid_rect *rigid_rect);
+Rigid_rect *create_rigid_rect(Arena *arena, Rect rect, Color color, const char *id);
+// Puts the rigid rect into the state of source, keeping its own memory
+void rigid_rect_patch(Rigid_rect *rigid_rect, const Rigid_rect *source);
 
 Solid_ref rigid_rect_as_solid(Rigid_rect *rigid_rect);
 
@@ -1,5 +1,8 @@
 #include <assert.h>
+#include <stdbool.h>
+#include <string.h>
 
+#include "game/camera.h"
 #include "player.h"
 #include "regions.h"
 #include "script.h"
@@ -8,19 +11,260 @@
 #include "ebisp/parser.h"
 #include "ebisp/scope.h"
 #include "str.h"
+#include "system/clock.h"
 #include "system/error.h"
 #include "system/line_stream.h"
 #include "system/lt.h"
 
+/* The regions are indexed by a uniform grid over their bounding
+ * box. Cells are roughly REGIONS_GRID_CELL_SIZE wide, but there are
+ * never more than REGIONS_GRID_MAX_SIDE of them per axis. */
+#define REGIONS_GRID_CELL_SIZE 256.0f
+#define REGIONS_GRID_MAX_SIDE 64
+
+enum RegionEventType
+{
+    REGION_EVENT_ENTER = 0,
+    REGION_EVENT_LEAVE
+};
+
+struct RegionEvent
+{
+    enum RegionEventType type;
+    size_t region;
+};
+
 struct Regions
 {
     Lt *lt;
     size_t count;
     Rect *rects;
     Script **scripts;
+
+    /* Grid. The regions of the cell i are
+     * cell_regions[cell_offsets[i]..cell_offsets[i + 1]) */
+    Rect bounds;
+    size_t cols;
+    size_t rows;
+    float cell_w;
+    float cell_h;
+    size_t *cell_offsets;
+    size_t *cell_regions;
+
+    /* Regions the player is inside of */
+    bool *inside;
+    size_t *inside_list;
+    size_t inside_count;
+    /* Tick of the last overlap with the player of each region */
+    size_t *overlap_tick;
+    size_t tick;
+
+    /* Ring buffer of the events waiting for dispatch */
+    struct RegionEvent *events;
+    size_t events_capacity;
+    size_t events_begin;
+
+    struct RegionsStats stats;
 };
 
-Regions *create_regions_from_line_stream(LineStream *line_stream)
+/* Clamps the coordinate to the grid, including the infinities and
+ * NaNs the huge rects end up with */
+static size_t regions_cell_index(float x, size_t side)
+{
+    if (!(x > 0.0f)) {
+        return 0;
+    }
+
+    return x >= (float) side ? side - 1 : (size_t) x;
+}
+
+static void regions_cell_range(const Regions *regions, Rect rect,
+                               size_t *col0, size_t *row0,
+                               size_t *col1, size_t *row1)
+{
+    const float x0 = (rect.x - regions->bounds.x) / regions->cell_w;
+    const float y0 = (rect.y - regions->bounds.y) / regions->cell_h;
+    const float x1 = (rect.x + rect.w - regions->bounds.x) / regions->cell_w;
+    const float y1 = (rect.y + rect.h - regions->bounds.y) / regions->cell_h;
+
+    *col0 = regions_cell_index(x0, regions->cols);
+    *row0 = regions_cell_index(y0, regions->rows);
+    *col1 = regions_cell_index(x1, regions->cols);
+    *row1 = regions_cell_index(y1, regions->rows);
+}
+
+static size_t regions_grid_side(float size)
+{
+    const float side = size / REGIONS_GRID_CELL_SIZE;
+    if (!(side >= 1.0f)) {
+        return 1;
+    }
+
+    return side >= (float) REGIONS_GRID_MAX_SIDE
+        ? REGIONS_GRID_MAX_SIDE
+        : (size_t) side + 1;
+}
+
+static int regions_build_grid(Regions *regions)
+{
+    float x1 = regions->rects[0].x + regions->rects[0].w;
+    float y1 = regions->rects[0].y + regions->rects[0].h;
+    regions->bounds = regions->rects[0];
+
+    for (size_t i = 1; i < regions->count; ++i) {
+        const Rect r = regions->rects[i];
+        if (r.x < regions->bounds.x) regions->bounds.x = r.x;
+        if (r.y < regions->bounds.y) regions->bounds.y = r.y;
+        if (r.x + r.w > x1) x1 = r.x + r.w;
+        if (r.y + r.h > y1) y1 = r.y + r.h;
+    }
+    regions->bounds.w = x1 - regions->bounds.x;
+    regions->bounds.h = y1 - regions->bounds.y;
+
+    regions->cols = regions_grid_side(regions->bounds.w);
+    regions->rows = regions_grid_side(regions->bounds.h);
+    regions->cell_w = regions->bounds.w > 0.0f ? regions->bounds.w / (float) regions->cols : 1.0f;
+    regions->cell_h = regions->bounds.h > 0.0f ? regions->bounds.h / (float) regions->rows : 1.0f;
+
+    const size_t cells = regions->cols * regions->rows;
+
+    regions->cell_offsets = PUSH_LT(
+        regions->lt,
+        calloc(cells + 1, sizeof(size_t)),
+        free);
+    if (regions->cell_offsets == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    /* Counting sort of the regions into the cells */
+    size_t col0, row0, col1, row1;
+    for (size_t i = 0; i < regions->count; ++i) {
+        regions_cell_range(regions, regions->rects[i], &col0, &row0, &col1, &row1);
+        for (size_t row = row0; row <= row1; ++row) {
+            for (size_t col = col0; col <= col1; ++col) {
+                regions->cell_offsets[row * regions->cols + col + 1]++;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < cells; ++i) {
+        regions->cell_offsets[i + 1] += regions->cell_offsets[i];
+    }
+
+    regions->cell_regions = PUSH_LT(
+        regions->lt,
+        malloc(sizeof(size_t) * (regions->cell_offsets[cells] + 1)),
+        free);
+    if (regions->cell_regions == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    size_t *fill = PUSH_LT(
+        regions->lt,
+        malloc(sizeof(size_t) * cells),
+        free);
+    if (fill == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+    memcpy(fill, regions->cell_offsets, sizeof(size_t) * cells);
+
+    for (size_t i = 0; i < regions->count; ++i) {
+        regions_cell_range(regions, regions->rects[i], &col0, &row0, &col1, &row1);
+        for (size_t row = row0; row <= row1; ++row) {
+            for (size_t col = col0; col <= col1; ++col) {
+                regions->cell_regions[fill[row * regions->cols + col]++] = i;
+            }
+        }
+    }
+
+    free(RELEASE_LT(regions->lt, fill));
+
+    return 0;
+}
+
+/* Prepares the grid and the event queue once the rects and the
+ * scripts are loaded */
+static int regions_init_tracking(Regions *regions)
+{
+    regions->cols = 0;
+    regions->rows = 0;
+    regions->inside_count = 0;
+    regions->tick = 0;
+    regions->events_capacity = regions->count * 2 + 1;
+    regions->events_begin = 0;
+    memset(&regions->stats, 0, sizeof(regions->stats));
+
+    regions->inside = PUSH_LT(regions->lt, calloc(regions->count + 1, sizeof(bool)), free);
+    regions->inside_list = PUSH_LT(regions->lt, malloc(sizeof(size_t) * (regions->count + 1)), free);
+    regions->overlap_tick = PUSH_LT(regions->lt, calloc(regions->count + 1, sizeof(size_t)), free);
+    regions->events = PUSH_LT(
+        regions->lt,
+        malloc(sizeof(struct RegionEvent) * regions->events_capacity),
+        free);
+    if (regions->inside == NULL
+        || regions->inside_list == NULL
+        || regions->overlap_tick == NULL
+        || regions->events == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    if (regions->count > 0 && regions_build_grid(regions) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+Regions *create_regions(const Rect *rects, const char *const *scripts, size_t count,
+                        const char *script_cache_dir)
+{
+    assert(rects || count == 0);
+    assert(scripts || count == 0);
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return NULL;
+    }
+
+    Regions *regions = PUSH_LT(lt, malloc(sizeof(Regions)), free);
+    if (regions == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+    regions->lt = lt;
+    regions->count = count;
+
+    regions->rects = PUSH_LT(lt, malloc(sizeof(Rect) * (count + 1)), free);
+    regions->scripts = PUSH_LT(lt, malloc(sizeof(Script*) * (count + 1)), free);
+    if (regions->rects == NULL || regions->scripts == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        regions->rects[i] = rects[i];
+        regions->scripts[i] = PUSH_LT(
+            lt,
+            create_script_from_string(scripts[i], script_cache_dir),
+            destroy_script);
+        if (regions->scripts[i] == NULL) {
+            RETURN_LT(lt, NULL);
+        }
+    }
+
+    if (regions_init_tracking(regions) < 0) {
+        RETURN_LT(lt, NULL);
+    }
+
+    return regions;
+}
+
+Regions *create_regions_from_line_stream(LineStream *line_stream,
+                                         const char *script_cache_dir)
 {
     assert(line_stream);
 
@@ -39,17 +283,14 @@ Regions *create_regions_from_line_stream(LineStream *line_stream)
     }
     regions->lt = lt;
 
-    if(sscanf(
-           line_stream_next(line_stream),
-           "%lu",
-           &regions->count) < 0) {
-        throw_error(ERROR_TYPE_LIBC);
+    if (line_stream_read_count(line_stream, &regions->count) < 0
+        || line_stream_end_line(line_stream) < 0) {
         RETURN_LT(lt, NULL);
     }
 
     regions->rects = PUSH_LT(
         lt,
-        malloc(sizeof(Rect) * regions->count),
+        malloc(sizeof(Rect) * (regions->count + 1)),
         free);
     if (regions->rects == NULL) {
         throw_error(ERROR_TYPE_LIBC);
@@ -58,7 +299,7 @@ Regions *create_regions_from_line_stream(LineStream *line_stream)
 
     regions->scripts = PUSH_LT(
         lt,
-        malloc(sizeof(Script*) * regions->count),
+        malloc(sizeof(Script*) * (regions->count + 1)),
         free);
     if (regions->scripts == NULL) {
         throw_error(ERROR_TYPE_LIBC);
@@ -68,20 +309,14 @@ Regions *create_regions_from_line_stream(LineStream *line_stream)
     printf("Amount of regions: %lu\n", regions->count);
 
     for (size_t i = 0; i < regions->count; ++i) {
-        if (sscanf(
-                line_stream_next(line_stream),
-                "%f%f%f%f",
-                &regions->rects[i].x,
-                &regions->rects[i].y,
-                &regions->rects[i].w,
-                &regions->rects[i].h) < 0) {
-            throw_error(ERROR_TYPE_LIBC);
+        if (line_stream_read_rect(line_stream, &regions->rects[i]) < 0
+            || line_stream_end_line(line_stream) < 0) {
             RETURN_LT(lt, NULL);
         }
 
         regions->scripts[i] = PUSH_LT(
             lt,
-            create_script_from_line_stream(line_stream),
+            create_script_from_line_stream(line_stream, script_cache_dir),
             destroy_script);
         if (regions->scripts[i] == NULL) {
             RETURN_LT(lt, NULL);
@@ -90,6 +325,10 @@ Regions *create_regions_from_line_stream(LineStream *line_stream)
 
     /* TODO(#456): create_regions_from_line_stream doesn't check if the scripts contain proper callbacks */
 
+    if (regions_init_tracking(regions) < 0) {
+        RETURN_LT(lt, NULL);
+    }
+
     return regions;
 }
 
@@ -99,16 +338,141 @@ void destroy_regions(Regions *regions)
     RETURN_LT0(regions->lt);
 }
 
-void regions_player_enter(Regions *regions, Player *player)
+static void regions_push_event(Regions *regions,
+                               enum RegionEventType type,
+                               size_t region)
+{
+    if (regions->stats.events_pending >= regions->events_capacity) {
+        regions->stats.events_dropped++;
+        return;
+    }
+
+    const size_t i = (regions->events_begin + regions->stats.events_pending) % regions->events_capacity;
+    regions->events[i].type = type;
+    regions->events[i].region = region;
+    regions->stats.events_pending++;
+}
+
+void regions_track_player(Regions *regions, const Player *player)
 {
     assert(regions);
     assert(player);
-    /* TODO(#396): regions_player_enter is not implemented */
+
+    if (regions->count == 0) {
+        return;
+    }
+
+    const Rect hitbox = player_hitbox(player);
+    const size_t tick = ++regions->tick;
+
+    if (rects_overlap(regions->bounds, hitbox)) {
+        size_t col0, row0, col1, row1;
+        regions_cell_range(regions, hitbox, &col0, &row0, &col1, &row1);
+
+        for (size_t row = row0; row <= row1; ++row) {
+            for (size_t col = col0; col <= col1; ++col) {
+                const size_t cell = row * regions->cols + col;
+
+                for (size_t j = regions->cell_offsets[cell];
+                     j < regions->cell_offsets[cell + 1];
+                     ++j) {
+                    const size_t i = regions->cell_regions[j];
+
+                    if (regions->overlap_tick[i] == tick
+                        || !rects_overlap(regions->rects[i], hitbox)) {
+                        continue;
+                    }
+                    regions->overlap_tick[i] = tick;
+
+                    if (!regions->inside[i]) {
+                        regions->inside[i] = true;
+                        regions->inside_list[regions->inside_count++] = i;
+                        regions_push_event(regions, REGION_EVENT_ENTER, i);
+                    }
+                }
+            }
+        }
+    }
+
+    /* Only the regions the player was inside of can be left */
+    for (size_t j = 0; j < regions->inside_count;) {
+        const size_t i = regions->inside_list[j];
+
+        if (regions->overlap_tick[i] == tick) {
+            ++j;
+            continue;
+        }
+
+        regions->inside[i] = false;
+        regions->inside_list[j] = regions->inside_list[--regions->inside_count];
+        regions_push_event(regions, REGION_EVENT_LEAVE, i);
+    }
 }
 
-void regions_player_leave(Regions *regions, Player *player)
+int regions_dispatch_events(Regions *regions)
 {
     assert(regions);
-    assert(player);
-    /* TODO(#397): regions_player_leave is not implemented */
+
+    if (regions->stats.events_pending == 0) {
+        regions->stats.last_dispatch_us = 0;
+        return 0;
+    }
+
+    const int64_t begin_us = clock_now_us();
+
+    for (size_t n = 0;
+         n < REGIONS_MAX_EVENTS_PER_DISPATCH && regions->stats.events_pending > 0;
+         ++n) {
+        const struct RegionEvent event = regions->events[regions->events_begin];
+        regions->events_begin = (regions->events_begin + 1) % regions->events_capacity;
+        regions->stats.events_pending--;
+        regions->stats.events_dispatched++;
+
+        /* Errors of the scripts are reported by script_call and do
+         * not stop the game */
+        script_call(
+            regions->scripts[event.region],
+            event.type == REGION_EVENT_ENTER ? "on-enter" : "on-leave");
+    }
+
+    regions->stats.last_dispatch_us = (long int) (clock_now_us() - begin_us);
+
+    return 0;
+}
+
+size_t regions_count(const Regions *regions)
+{
+    assert(regions);
+    return regions->count;
+}
+
+void regions_stats(const Regions *regions, struct RegionsStats *stats)
+{
+    assert(regions);
+    assert(stats);
+    *stats = regions->stats;
+}
+
+int regions_render(const Regions *regions, Camera *camera)
+{
+    assert(regions);
+    assert(camera);
+
+    char text[64];
+
+    for (size_t i = 0; i < regions->count; ++i) {
+        const struct EvalUsage usage = script_usage(regions->scripts[i]);
+
+        snprintf(text, sizeof(text), "%ld steps %zu allocs %ld us",
+                 usage.steps, usage.allocations, usage.time_us);
+
+        if (camera_render_debug_text(
+                camera,
+                text,
+                vec(regions->rects[i].x, regions->rects[i].y)) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
 }
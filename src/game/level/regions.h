@@ -3,14 +3,42 @@
 
 #include "math/rect.h"
 
+#define REGIONS_MAX_EVENTS_PER_DISPATCH 16
+
 typedef struct Regions Regions;
 typedef struct Player Player;
+typedef struct Camera Camera;
 typedef struct LineStream LineStream;
 
-Regions *create_regions_from_line_stream(LineStream *line_stream);
+struct RegionsStats
+{
+    size_t events_pending;
+    size_t events_dispatched;   // Since the creation of the Regions
+    size_t events_dropped;      // Because the queue was full
+    long int last_dispatch_us;
+};
+
+// scripts are the source codes of the scripts of the regions.
+// script_cache_dir is passed to the scripts as is.
+Regions *create_regions(const Rect *rects, const char *const *scripts, size_t count,
+                        const char *script_cache_dir);
+Regions *create_regions_from_line_stream(LineStream *line_stream,
+                                         const char *script_cache_dir);
 void destroy_regions(Regions *regions);
 
-void regions_player_enter(Regions *regions, Player *player);
-void regions_player_leave(Regions *regions, Player *player);
+// Queues on-enter and on-leave events of the regions the player
+// crossed since the previous call
+void regions_track_player(Regions *regions, const Player *player);
+// Calls the script callbacks of at most
+// REGIONS_MAX_EVENTS_PER_DISPATCH queued events. The rest of them
+// stay in the queue until the next dispatch.
+int regions_dispatch_events(Regions *regions);
+
+size_t regions_count(const Regions *regions);
+
+void regions_stats(const Regions *regions, struct RegionsStats *stats);
+
+// Renders what the scripts of the regions cost in the debug mode
+int regions_render(const Regions *regions, Camera *camera);
 
 #endif  // REGIONS_H_
@@ -1,17 +1,281 @@
 #include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "ebisp/builtins.h"
+#include "ebisp/dump.h"
+#include "ebisp/gc.h"
+#include "ebisp/interpreter.h"
+#include "ebisp/parser.h"
+#include "ebisp/scope.h"
 #include "script.h"
+#include "str.h"
+#include "system/error.h"
 #include "system/line_stream.h"
+#include "system/lt.h"
+
+/* Parsed scripts are dumped into the cache directory of the loader
+ * under the hash of their source, so loading the same level again
+ * skips the tokenizer and the parser. The hash only names the file:
+ * the dump keeps the whole source and is used only if it matches
+ * byte by byte. */
+#define SCRIPT_CACHE_PATH_SIZE 256
+#define SCRIPT_GC_BUDGET_US 100
+
+/* Limits of every top-level form and every callback, so a runaway
+ * script fails instead of freezing the frame */
+#define SCRIPT_MAX_STEPS 100000
+#define SCRIPT_MAX_ALLOCATIONS 100000
+#define SCRIPT_MAX_TIME_US 2000
+
+static const struct EvalBudget script_budget = {
+    .max_steps = SCRIPT_MAX_STEPS,
+    .max_allocations = SCRIPT_MAX_ALLOCATIONS,
+    .max_time_us = SCRIPT_MAX_TIME_US
+};
+
+struct Script
+{
+    Lt *lt;
+    Gc *gc;
+    struct Scope scope;
+    struct EvalUsage usage;
+};
+
+/* FNV-1a */
+static uint64_t script_hash(const char *source_code)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (const char *c = source_code; *c != 0; ++c) {
+        hash = (hash ^ (uint64_t) (unsigned char) *c) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static int script_cache_path(char *path, const char *cache_dir,
+                             uint64_t hash, const char *suffix)
+{
+    const int n = snprintf(path, SCRIPT_CACHE_PATH_SIZE,
+                           "%s/%016" PRIx64 ".ebd%s",
+                           cache_dir, hash, suffix);
+    return n < 0 || n >= SCRIPT_CACHE_PATH_SIZE ? -1 : 0;
+}
+
+static int script_mkdir(const char *dir_path)
+{
+#ifdef _WIN32
+    return _mkdir(dir_path);
+#else
+    return mkdir(dir_path, 0755);
+#endif
+}
+
+/* The cache is best effort: failing to write it only makes the next
+ * load slower. The dump is written into a temporary file first, so a
+ * reader never sees a half written one. */
+static void script_cache_store(const char *cache_dir, uint64_t hash,
+                               const char *source_code, size_t source_size,
+                               struct Expr forms)
+{
+    char path[SCRIPT_CACHE_PATH_SIZE];
+    char tmp_path[SCRIPT_CACHE_PATH_SIZE];
+
+    if (script_cache_path(path, cache_dir, hash, "") < 0
+        || script_cache_path(tmp_path, cache_dir, hash, ".tmp") < 0) {
+        return;
+    }
+
+    if (script_mkdir(cache_dir) < 0 && errno != EEXIST) {
+        return;
+    }
+
+    FILE *stream = fopen(tmp_path, "wb");
+    if (stream == NULL) {
+        return;
+    }
+
+    const int dumped = dump_expr(stream, source_code, source_size, forms);
+
+    if (fclose(stream) != 0 || dumped < 0 || rename(tmp_path, path) < 0) {
+        remove(tmp_path);
+    }
+}
+
+static struct ParseResult script_load_forms(Gc *gc,
+                                            const char *source_code,
+                                            const char *cache_dir)
+{
+    if (cache_dir == NULL) {
+        return read_all_exprs_from_string(gc, source_code);
+    }
+
+    const uint64_t hash = script_hash(source_code);
+    const size_t source_size = strlen(source_code);
+    char path[SCRIPT_CACHE_PATH_SIZE];
 
-/* TODO(#458): script entity is not implemented */
+    if (script_cache_path(path, cache_dir, hash, "") == 0) {
+        struct ParseResult result = load_expr_from_file(gc, path, source_code, source_size);
+        if (!result.is_error) {
+            return result;
+        }
+    }
+
+    /* Cache miss is not an error */
+    reset_error();
+
+    struct ParseResult result = read_all_exprs_from_string(gc, source_code);
+    if (!result.is_error) {
+        script_cache_store(cache_dir, hash, source_code, source_size, result.expr);
+        reset_error();
+    }
+
+    return result;
+}
 
-Script *create_script_from_line_stream(LineStream *line_stream)
+Script *create_script_from_string(const char *source_code, const char *cache_dir)
+{
+    assert(source_code);
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return NULL;
+    }
+
+    Script *script = PUSH_LT(lt, malloc(sizeof(Script)), free);
+    if (script == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+    script->lt = lt;
+    memset(&script->usage, 0, sizeof(script->usage));
+
+    script->gc = PUSH_LT(lt, create_gc(), destroy_gc);
+    if (script->gc == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    script->scope = create_scope(script->gc);
+    if (gc_add_root(script->gc, &script->scope.expr) < 0) {
+        RETURN_LT(lt, NULL);
+    }
+
+    struct ParseResult parse_result = script_load_forms(script->gc, source_code, cache_dir);
+    if (parse_result.is_error) {
+        print_parse_error(stderr, source_code, parse_result);
+        RETURN_LT(lt, NULL);
+    }
+
+    /* Top-level forms define the callbacks of the script in its scope */
+    for (struct Expr forms = parse_result.expr;
+         cons_p(forms);
+         forms = forms.cons->cdr) {
+        struct EvalResult eval_result = eval_with_budget(
+            script->gc,
+            &script->scope,
+            forms.cons->car,
+            &script_budget,
+            &script->usage);
+
+        if (eval_result.is_error) {
+            fprintf(stderr, "Error while evaluating the script: ");
+            print_expr_as_sexpr(stderr, eval_result.expr);
+            fprintf(stderr, "\n");
+            RETURN_LT(lt, NULL);
+        }
+    }
+
+    gc_collect(script->gc);
+
+    return script;
+}
+
+Script *create_script_from_line_stream(LineStream *line_stream, const char *cache_dir)
 {
     assert(line_stream);
-    return NULL;
+
+    size_t n = 0;
+    if (line_stream_read_count(line_stream, &n) < 0
+        || line_stream_end_line(line_stream) < 0) {
+        return NULL;
+    }
+
+    char *source_code = string_duplicate("", NULL);
+    if (source_code == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        const char *line = line_stream_next(line_stream);
+        if (line == NULL) {
+            fprintf(stderr, "Unexpected end of file in the middle of a script\n");
+            errno = EINVAL;
+            throw_error(ERROR_TYPE_LIBC);
+            free(source_code);
+            return NULL;
+        }
+
+        char *new_source_code = string_append(source_code, line);
+        if (new_source_code == NULL) {
+            throw_error(ERROR_TYPE_LIBC);
+            free(source_code);
+            return NULL;
+        }
+        source_code = new_source_code;
+    }
+
+    Script *script = create_script_from_string(source_code, cache_dir);
+    free(source_code);
+
+    return script;
 }
 
 void destroy_script(Script *script)
 {
     assert(script);
+    RETURN_LT0(script->lt);
+}
+
+int script_call(Script *script, const char *name)
+{
+    assert(script);
+    assert(name);
+
+    struct Expr callback = SYMBOL(script->gc, name);
+    if (nil_p(get_scope_value(&script->scope, callback))) {
+        return 0;
+    }
+
+    struct EvalResult result = eval_with_budget(
+        script->gc,
+        &script->scope,
+        CONS(script->gc, callback, NIL(script->gc)),
+        &script_budget,
+        &script->usage);
+
+    if (result.is_error) {
+        fprintf(stderr, "Error in %s: ", name);
+        print_expr_as_sexpr(stderr, result.expr);
+        fprintf(stderr, "\n");
+    }
+
+    gc_step(script->gc, SCRIPT_GC_BUDGET_US);
+
+    return result.is_error ? -1 : 0;
+}
+
+struct EvalUsage script_usage(const Script *script)
+{
+    assert(script);
+    return script->usage;
 }
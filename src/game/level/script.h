@@ -1,10 +1,22 @@
 #ifndef SCRIPT_H_
 #define SCRIPT_H_
 
+#include "ebisp/interpreter.h"
+
 typedef struct Script Script;
 typedef struct LineStream LineStream;
 
-Script *create_script_from_line_stream(LineStream *line_stream);
+// The parsed source is dumped into and loaded from cache_dir. NULL
+// cache_dir disables the cache.
+Script *create_script_from_string(const char *source_code, const char *cache_dir);
+Script *create_script_from_line_stream(LineStream *line_stream, const char *cache_dir);
 void destroy_script(Script *script);
 
+// Calls a callback without arguments defined by the script, e.g.
+// (on-enter). Callbacks that are not defined are silently
+// skipped. Returns -1 if the callback failed.
+int script_call(Script *script, const char *name);
+// What the last evaluation of the script cost
+struct EvalUsage script_usage(const Script *script);
+
 #endif  // SCRIPT_H_
@@ -0,0 +1,690 @@
+#include <SDL2/SDL.h>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "game/level/compiled_level.h"
+#include "game/level/lava.h"
+#include "game/level/platforms.h"
+#include "game/level/world_streamer.h"
+#include "str.h"
+#include "system/arena.h"
+#include "system/error.h"
+#include "system/line_stream.h"
+#include "system/lt.h"
+
+#define WORLD_LINE_MAX_LENGTH 512
+#define WORLD_PATH_MAX 4096
+#define WORLD_TILE_ARENA_CHUNK_SIZE (16 * 1024)
+
+/* Tiles are loaded this many tiles beyond the view, but evicted only
+ * past the evict radius, so walking along a tile border does not load
+ * and evict the same tiles over and over again */
+#define WORLD_LOAD_RADIUS 1
+#define WORLD_EVICT_RADIUS 2
+
+typedef enum WorldTileState
+{
+    WORLD_TILE_ABSENT = 0,
+    WORLD_TILE_QUEUED,
+    WORLD_TILE_LOADING,
+    /* Waits on the done list to become resident */
+    WORLD_TILE_LOADED,
+    WORLD_TILE_RESIDENT,
+    /* Waits on the done list to be reported */
+    WORLD_TILE_FAILED,
+    /* Reported once and never loaded again */
+    WORLD_TILE_BROKEN
+} WorldTileState;
+
+struct WorldTileEntry
+{
+    int x;
+    int y;
+
+    /* Guarded by the mutex */
+    WorldTileState state;
+
+    /* Belong to whoever moved the tile to LOADING until the tile is
+     * LOADED or FAILED */
+    Arena *arena;
+    WorldTile tile;
+    Error_type error;
+    int error_errno;
+};
+
+typedef struct
+{
+    int x0, y0, x1, y1;
+} TileRange;
+
+struct WorldStreamer
+{
+    Lt *lt;
+
+    char *dir;
+    char *global_file;
+    float tile_size;
+    float margin;
+    size_t count;
+    struct WorldTileEntry *entries;
+
+    SDL_mutex *mutex;
+    SDL_cond *requested;
+    SDL_cond *loaded;
+    SDL_Thread *thread;
+
+    /* Guarded by the mutex. A tile is in the queue only while it is
+     * QUEUED and in the done list only while it is LOADED or FAILED,
+     * so neither of them outgrows count. */
+    bool quit;
+    size_t *queue;
+    size_t queue_size;
+    size_t *done;
+    size_t done_size;
+
+    /* Main thread only */
+    size_t resident_count;
+    size_t *resident;
+    Platforms **resident_platforms;
+};
+
+static char *world_path(const char *dir, const char *file_name)
+{
+    char *path = string_duplicate(dir, NULL);
+    if (path == NULL) {
+        return NULL;
+    }
+
+    char *with_slash = string_append(path, "/");
+    if (with_slash == NULL) {
+        free(path);
+        return NULL;
+    }
+
+    char *result = string_append(with_slash, file_name);
+    if (result == NULL) {
+        free(with_slash);
+        return NULL;
+    }
+
+    return result;
+}
+
+/* Worlds are told apart by their index rather than by being a
+ * directory, which has no portable test */
+bool world_file_p(const char *file_name)
+{
+    assert(file_name);
+
+    char *index_file = world_path(file_name, WORLD_INDEX_FILE);
+    if (index_file == NULL) {
+        return false;
+    }
+
+    FILE *index = fopen(index_file, "r");
+    free(index_file);
+    if (index == NULL) {
+        return false;
+    }
+
+    fclose(index);
+
+    return true;
+}
+
+static int world_streamer_read_index(WorldStreamer *world_streamer)
+{
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    char *index_file = PUSH_LT(lt, world_path(world_streamer->dir, WORLD_INDEX_FILE), free);
+    if (index_file == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    LineStream *index = PUSH_LT(
+        lt,
+        create_line_stream(index_file, "r", WORLD_LINE_MAX_LENGTH),
+        destroy_line_stream);
+    if (index == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    if (line_stream_read_float(index, &world_streamer->tile_size) < 0
+        || line_stream_read_float(index, &world_streamer->margin) < 0
+        || line_stream_end_line(index) < 0
+        || line_stream_read_count(index, &world_streamer->count) < 0
+        || line_stream_end_line(index) < 0) {
+        RETURN_LT(lt, -1);
+    }
+
+    if (!(world_streamer->tile_size > 0.0f) || !(world_streamer->margin >= 0.0f)) {
+        fprintf(stderr, "%s: tile size has to be positive and margin non-negative\n", index_file);
+        errno = EINVAL;
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    /* One extra entry keeps calloc from returning NULL for an empty
+     * world */
+    world_streamer->entries = PUSH_LT(
+        world_streamer->lt,
+        calloc(world_streamer->count + 1, sizeof(struct WorldTileEntry)),
+        free);
+    if (world_streamer->entries == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    for (size_t i = 0; i < world_streamer->count; ++i) {
+        struct WorldTileEntry *entry = &world_streamer->entries[i];
+        Point position;
+
+        if (line_stream_read_point(index, &position) < 0
+            || line_stream_end_line(index) < 0) {
+            RETURN_LT(lt, -1);
+        }
+
+        entry->x = (int) position.x;
+        entry->y = (int) position.y;
+        if ((float) entry->x != position.x || (float) entry->y != position.y) {
+            fprintf(stderr, "%s: tile %lu is not on the grid\n", index_file, (unsigned long) i);
+            errno = EINVAL;
+            throw_error(ERROR_TYPE_LIBC);
+            RETURN_LT(lt, -1);
+        }
+
+        /* world_streamer_find relies on the order */
+        if (i > 0) {
+            const struct WorldTileEntry *prev = &world_streamer->entries[i - 1];
+            if (prev->y > entry->y || (prev->y == entry->y && prev->x >= entry->x)) {
+                fprintf(stderr, "%s: tile %lu is out of order\n", index_file, (unsigned long) i);
+                errno = EINVAL;
+                throw_error(ERROR_TYPE_LIBC);
+                RETURN_LT(lt, -1);
+            }
+        }
+    }
+
+    RETURN_LT(lt, 0);
+}
+
+/* The first tile not before (x, y) */
+static size_t world_streamer_find(const WorldStreamer *world_streamer, int x, int y)
+{
+    size_t begin = 0;
+    size_t end = world_streamer->count;
+
+    while (begin < end) {
+        const size_t middle = begin + (end - begin) / 2;
+        const struct WorldTileEntry *entry = &world_streamer->entries[middle];
+
+        if (entry->y < y || (entry->y == y && entry->x < x)) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+
+    return begin;
+}
+
+static int world_tile_coord(float x, float tile_size)
+{
+    const float tile = floorf(x / tile_size);
+
+    /* NaN is clamped explicitly, so converting it to int can never
+     * happen whichever bound of the range it ends up in */
+    if (isnan(tile)) {
+        return INT_MIN / 2;
+    }
+
+    /* Far away views just do not see any tiles */
+    if (tile < (float) (INT_MIN / 2)) {
+        return INT_MIN / 2;
+    }
+    if (tile > (float) (INT_MAX / 2)) {
+        return INT_MAX / 2;
+    }
+
+    return (int) tile;
+}
+
+/* The rects of a tile start inside of it but may reach up to the
+ * margin out of it, so the tiles to the left and above the area are
+ * needed as well */
+static TileRange world_streamer_range(const WorldStreamer *world_streamer,
+                                      Rect area,
+                                      int radius)
+{
+    const float tile_size = world_streamer->tile_size;
+    const float margin = world_streamer->margin;
+
+    TileRange range = {
+        .x0 = world_tile_coord(area.x - margin, tile_size) - radius,
+        .y0 = world_tile_coord(area.y - margin, tile_size) - radius,
+        .x1 = world_tile_coord(area.x + area.w, tile_size) + radius,
+        .y1 = world_tile_coord(area.y + area.h, tile_size) + radius
+    };
+
+    return range;
+}
+
+static bool tile_range_contains(TileRange range, const struct WorldTileEntry *entry)
+{
+    return range.x0 <= entry->x && entry->x <= range.x1
+        && range.y0 <= entry->y && entry->y <= range.y1;
+}
+
+/* Can be called from both of the threads since it touches only the
+ * entry and nothing else in the streamer */
+static int world_tile_load(const WorldStreamer *world_streamer, struct WorldTileEntry *entry)
+{
+    char file_name[WORLD_PATH_MAX];
+    const int n = snprintf(
+        file_name, sizeof(file_name),
+        "%s/" WORLD_TILE_FILE_FORMAT,
+        world_streamer->dir, entry->x, entry->y);
+    if (n < 0 || (size_t) n >= sizeof(file_name)) {
+        errno = ENAMETOOLONG;
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    CompiledLevel *compiled = PUSH_LT(
+        lt,
+        create_compiled_level_from_file(file_name),
+        destroy_compiled_level);
+    if (compiled == NULL) {
+        fprintf(stderr, "%s: could not load the tile\n", file_name);
+        RETURN_LT(lt, -1);
+    }
+
+    Arena *arena = PUSH_LT(lt, create_arena(WORLD_TILE_ARENA_CHUNK_SIZE), destroy_arena);
+    if (arena == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    entry->tile.platforms = create_platforms(
+        arena,
+        compiled_level_rects(compiled, LEVEL_SECTION_PLATFORMS),
+        compiled_level_colors(compiled, LEVEL_SECTION_PLATFORMS),
+        compiled_level_count(compiled, LEVEL_SECTION_PLATFORMS));
+    entry->tile.lava = create_lava(
+        arena,
+        compiled_level_rects(compiled, LEVEL_SECTION_LAVA),
+        compiled_level_colors(compiled, LEVEL_SECTION_LAVA),
+        compiled_level_count(compiled, LEVEL_SECTION_LAVA));
+    entry->tile.back_platforms = create_platforms(
+        arena,
+        compiled_level_rects(compiled, LEVEL_SECTION_BACK_PLATFORMS),
+        compiled_level_colors(compiled, LEVEL_SECTION_BACK_PLATFORMS),
+        compiled_level_count(compiled, LEVEL_SECTION_BACK_PLATFORMS));
+    if (entry->tile.platforms == NULL
+        || entry->tile.lava == NULL
+        || entry->tile.back_platforms == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    entry->arena = RELEASE_LT(lt, arena);
+
+    RETURN_LT(lt, 0);
+}
+
+/* Has to be called with the mutex locked, which is released while
+ * the tile is loading */
+static void world_streamer_load_locked(WorldStreamer *world_streamer, size_t i)
+{
+    struct WorldTileEntry *entry = &world_streamer->entries[i];
+
+    entry->state = WORLD_TILE_LOADING;
+    SDL_UnlockMutex(world_streamer->mutex);
+
+    const int result = world_tile_load(world_streamer, entry);
+    if (result < 0) {
+        entry->error = current_error();
+        entry->error_errno = errno;
+    }
+
+    SDL_LockMutex(world_streamer->mutex);
+    entry->state = result < 0 ? WORLD_TILE_FAILED : WORLD_TILE_LOADED;
+    world_streamer->done[world_streamer->done_size++] = i;
+    SDL_CondBroadcast(world_streamer->loaded);
+}
+
+static int world_streamer_thread(void *data)
+{
+    WorldStreamer *world_streamer = data;
+
+    SDL_LockMutex(world_streamer->mutex);
+    for (;;) {
+        while (!world_streamer->quit && world_streamer->queue_size == 0) {
+            SDL_CondWait(world_streamer->requested, world_streamer->mutex);
+        }
+
+        if (world_streamer->quit) {
+            break;
+        }
+
+        const size_t i = world_streamer->queue[0];
+        world_streamer->queue_size--;
+        memmove(world_streamer->queue,
+                world_streamer->queue + 1,
+                sizeof(size_t) * world_streamer->queue_size);
+
+        world_streamer_load_locked(world_streamer, i);
+    }
+    SDL_UnlockMutex(world_streamer->mutex);
+
+    return 0;
+}
+
+static void destroy_world_tile(struct WorldTileEntry *entry)
+{
+    if (entry->arena != NULL) {
+        destroy_arena(entry->arena);
+        entry->arena = NULL;
+    }
+}
+
+WorldStreamer *create_world_streamer(const char *world_dir)
+{
+    assert(world_dir);
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return NULL;
+    }
+
+    WorldStreamer *world_streamer = PUSH_LT(lt, calloc(1, sizeof(WorldStreamer)), free);
+    if (world_streamer == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+    world_streamer->lt = lt;
+
+    world_streamer->dir = PUSH_LT(lt, string_duplicate(world_dir, NULL), free);
+    if (world_streamer->dir == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+
+    world_streamer->global_file = PUSH_LT(lt, world_path(world_dir, WORLD_GLOBAL_FILE), free);
+    if (world_streamer->global_file == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+
+    if (world_streamer_read_index(world_streamer) < 0) {
+        RETURN_LT(lt, NULL);
+    }
+
+#define WORLD_ARRAY(field)                                              \
+    world_streamer->field = PUSH_LT(                                    \
+        lt,                                                             \
+        malloc(sizeof(*world_streamer->field) * (world_streamer->count + 1)), \
+        free);                                                          \
+    if (world_streamer->field == NULL) {                                \
+        throw_error(ERROR_TYPE_LIBC);                                   \
+        RETURN_LT(lt, NULL);                                            \
+    }
+
+    WORLD_ARRAY(queue)
+    WORLD_ARRAY(done)
+    WORLD_ARRAY(resident)
+    WORLD_ARRAY(resident_platforms)
+
+#undef WORLD_ARRAY
+
+    world_streamer->mutex = PUSH_LT(lt, SDL_CreateMutex(), SDL_DestroyMutex);
+    if (world_streamer->mutex == NULL) {
+        throw_error(ERROR_TYPE_SDL2);
+        RETURN_LT(lt, NULL);
+    }
+
+    world_streamer->requested = PUSH_LT(lt, SDL_CreateCond(), SDL_DestroyCond);
+    if (world_streamer->requested == NULL) {
+        throw_error(ERROR_TYPE_SDL2);
+        RETURN_LT(lt, NULL);
+    }
+
+    world_streamer->loaded = PUSH_LT(lt, SDL_CreateCond(), SDL_DestroyCond);
+    if (world_streamer->loaded == NULL) {
+        throw_error(ERROR_TYPE_SDL2);
+        RETURN_LT(lt, NULL);
+    }
+
+    world_streamer->thread = SDL_CreateThread(world_streamer_thread, "world-streamer", world_streamer);
+    if (world_streamer->thread == NULL) {
+        throw_error(ERROR_TYPE_SDL2);
+        RETURN_LT(lt, NULL);
+    }
+
+    return world_streamer;
+}
+
+void destroy_world_streamer(WorldStreamer *world_streamer)
+{
+    assert(world_streamer);
+
+    SDL_LockMutex(world_streamer->mutex);
+    world_streamer->quit = true;
+    SDL_CondSignal(world_streamer->requested);
+    SDL_UnlockMutex(world_streamer->mutex);
+
+    /* The tile being loaded is finished first and ends up in the done
+     * list, so it is freed below together with the rest */
+    SDL_WaitThread(world_streamer->thread, NULL);
+
+    for (size_t i = 0; i < world_streamer->count; ++i) {
+        destroy_world_tile(&world_streamer->entries[i]);
+    }
+
+    RETURN_LT0(world_streamer->lt);
+}
+
+const char *world_streamer_global_file(const WorldStreamer *world_streamer)
+{
+    assert(world_streamer);
+    return world_streamer->global_file;
+}
+
+/* Moves the tiles finished by either thread out of the done list */
+static int world_streamer_collect(WorldStreamer *world_streamer)
+{
+    int result = 0;
+
+    SDL_LockMutex(world_streamer->mutex);
+    for (size_t j = 0; j < world_streamer->done_size; ++j) {
+        const size_t i = world_streamer->done[j];
+        struct WorldTileEntry *entry = &world_streamer->entries[i];
+
+        if (entry->state == WORLD_TILE_FAILED) {
+            destroy_world_tile(entry);
+            entry->state = WORLD_TILE_BROKEN;
+
+            /* Only the first of the failures is reported */
+            if (result == 0) {
+                errno = entry->error_errno;
+                throw_error(entry->error);
+                result = -1;
+            }
+            continue;
+        }
+
+        assert(entry->state == WORLD_TILE_LOADED);
+        entry->state = WORLD_TILE_RESIDENT;
+        world_streamer->resident_platforms[world_streamer->resident_count] = entry->tile.platforms;
+        world_streamer->resident[world_streamer->resident_count++] = i;
+    }
+    world_streamer->done_size = 0;
+    SDL_UnlockMutex(world_streamer->mutex);
+
+    return result;
+}
+
+int world_streamer_load(WorldStreamer *world_streamer, Rect area)
+{
+    assert(world_streamer);
+
+    const TileRange range = world_streamer_range(world_streamer, area, WORLD_LOAD_RADIUS);
+
+    SDL_LockMutex(world_streamer->mutex);
+    for (int y = range.y0; y <= range.y1; ++y) {
+        for (size_t i = world_streamer_find(world_streamer, range.x0, y);
+             i < world_streamer->count && tile_range_contains(range, &world_streamer->entries[i]);
+             ++i) {
+            struct WorldTileEntry *entry = &world_streamer->entries[i];
+
+            if (entry->state == WORLD_TILE_QUEUED) {
+                /* Taken away from the loading thread */
+                size_t j = 0;
+                while (world_streamer->queue[j] != i) {
+                    ++j;
+                }
+                world_streamer->queue_size--;
+                memmove(world_streamer->queue + j,
+                        world_streamer->queue + j + 1,
+                        sizeof(size_t) * (world_streamer->queue_size - j));
+                entry->state = WORLD_TILE_ABSENT;
+            }
+
+            if (entry->state == WORLD_TILE_ABSENT) {
+                world_streamer_load_locked(world_streamer, i);
+            }
+
+            while (entry->state == WORLD_TILE_LOADING) {
+                SDL_CondWait(world_streamer->loaded, world_streamer->mutex);
+            }
+        }
+    }
+    SDL_UnlockMutex(world_streamer->mutex);
+
+    return world_streamer_collect(world_streamer);
+}
+
+int world_streamer_update(WorldStreamer *world_streamer, Rect view)
+{
+    assert(world_streamer);
+
+    const int result = world_streamer_collect(world_streamer);
+
+    const TileRange evict_range = world_streamer_range(world_streamer, view, WORLD_EVICT_RADIUS);
+    for (size_t j = 0; j < world_streamer->resident_count;) {
+        struct WorldTileEntry *entry = &world_streamer->entries[world_streamer->resident[j]];
+
+        if (tile_range_contains(evict_range, entry)) {
+            ++j;
+            continue;
+        }
+
+        destroy_world_tile(entry);
+
+        world_streamer->resident_count--;
+        world_streamer->resident[j] = world_streamer->resident[world_streamer->resident_count];
+        world_streamer->resident_platforms[j] = world_streamer->resident_platforms[world_streamer->resident_count];
+
+        SDL_LockMutex(world_streamer->mutex);
+        entry->state = WORLD_TILE_ABSENT;
+        SDL_UnlockMutex(world_streamer->mutex);
+    }
+
+    const TileRange load_range = world_streamer_range(world_streamer, view, WORLD_LOAD_RADIUS);
+    bool requested = false;
+
+    SDL_LockMutex(world_streamer->mutex);
+    for (int y = load_range.y0; y <= load_range.y1; ++y) {
+        for (size_t i = world_streamer_find(world_streamer, load_range.x0, y);
+             i < world_streamer->count && tile_range_contains(load_range, &world_streamer->entries[i]);
+             ++i) {
+            if (world_streamer->entries[i].state == WORLD_TILE_ABSENT) {
+                world_streamer->entries[i].state = WORLD_TILE_QUEUED;
+                world_streamer->queue[world_streamer->queue_size++] = i;
+                requested = true;
+            }
+        }
+    }
+
+    if (requested) {
+        SDL_CondSignal(world_streamer->requested);
+    }
+    SDL_UnlockMutex(world_streamer->mutex);
+
+    return result;
+}
+
+int world_streamer_check(const WorldStreamer *world_streamer)
+{
+    assert(world_streamer);
+
+    for (size_t i = 0; i < world_streamer->count; ++i) {
+        /* A copy keeps the check away from the tiles the loading
+         * thread may be working on */
+        struct WorldTileEntry entry = world_streamer->entries[i];
+        entry.arena = NULL;
+
+        if (world_tile_load(world_streamer, &entry) < 0) {
+            return -1;
+        }
+
+        destroy_world_tile(&entry);
+    }
+
+    return 0;
+}
+
+bool world_streamer_resident_p(const WorldStreamer *world_streamer, Rect area)
+{
+    assert(world_streamer);
+
+    /* The neighbour tiles are checked too, since the body may move
+     * into them during the tick */
+    const TileRange range = world_streamer_range(world_streamer, area, WORLD_LOAD_RADIUS);
+    bool resident = true;
+
+    SDL_LockMutex(world_streamer->mutex);
+    for (int y = range.y0; resident && y <= range.y1; ++y) {
+        for (size_t i = world_streamer_find(world_streamer, range.x0, y);
+             i < world_streamer->count && tile_range_contains(range, &world_streamer->entries[i]);
+             ++i) {
+            if (world_streamer->entries[i].state != WORLD_TILE_RESIDENT) {
+                resident = false;
+                break;
+            }
+        }
+    }
+    SDL_UnlockMutex(world_streamer->mutex);
+
+    return resident;
+}
+
+size_t world_streamer_count(const WorldStreamer *world_streamer)
+{
+    assert(world_streamer);
+    return world_streamer->resident_count;
+}
+
+const WorldTile *world_streamer_tile(const WorldStreamer *world_streamer, size_t i)
+{
+    assert(world_streamer);
+    assert(i < world_streamer->resident_count);
+    return &world_streamer->entries[world_streamer->resident[i]].tile;
+}
+
+Platforms *const *world_streamer_platforms(const WorldStreamer *world_streamer)
+{
+    assert(world_streamer);
+    return world_streamer->resident_platforms;
+}
@@ -0,0 +1,54 @@
+#ifndef WORLD_STREAMER_H_
+#define WORLD_STREAMER_H_
+
+#include <stdbool.h>
+
+#include "math/rect.h"
+
+// WorldStreamer keeps the terrain tiles of a compiled world (see
+// compiled_level.h) resident around the camera. The tiles are loaded
+// from disk on a background thread and evicted once they are far
+// enough from the camera, so the memory taken by the terrain depends
+// on the size of the screen instead of the size of the world.
+
+typedef struct WorldStreamer WorldStreamer;
+typedef struct Platforms Platforms;
+typedef struct Lava Lava;
+
+typedef struct WorldTile
+{
+    Platforms *platforms;
+    Lava *lava;
+    Platforms *back_platforms;
+} WorldTile;
+
+bool world_file_p(const char *file_name);
+
+WorldStreamer *create_world_streamer(const char *world_dir);
+void destroy_world_streamer(WorldStreamer *world_streamer);
+
+// The compiled level with everything but the terrain
+const char *world_streamer_global_file(const WorldStreamer *world_streamer);
+
+// Loads the tiles in range of the area right away. Meant for the
+// places the player appears at, where waiting for the background
+// thread would drop the player through the floor.
+int world_streamer_load(WorldStreamer *world_streamer, Rect area);
+// Makes the loaded tiles resident, requests the tiles in range of
+// the view and evicts the ones that are out of range
+int world_streamer_update(WorldStreamer *world_streamer, Rect view);
+
+// Loads every tile of the world one by one, throwing each of them
+// away right after. Meant for the tools validating worlds.
+int world_streamer_check(const WorldStreamer *world_streamer);
+
+// Whether all of the terrain a body in the area can touch during a
+// tick is resident
+bool world_streamer_resident_p(const WorldStreamer *world_streamer, Rect area);
+
+size_t world_streamer_count(const WorldStreamer *world_streamer);
+const WorldTile *world_streamer_tile(const WorldStreamer *world_streamer, size_t i);
+// The platforms of all of the resident tiles
+Platforms *const *world_streamer_platforms(const WorldStreamer *world_streamer);
+
+#endif  // WORLD_STREAMER_H_
@@ -0,0 +1,144 @@
+#include <SDL2/SDL.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "game/level_loader.h"
+#include "str.h"
+#include "system/error.h"
+#include "system/lt.h"
+
+#define LEVEL_LOADER_SDL_ERROR_SIZE 256
+
+struct LevelLoader
+{
+    Lt *lt;
+    char *file_name;
+    char *script_cache_dir;
+    SDL_Thread *thread;
+
+    SDL_atomic_t progress;
+    SDL_atomic_t done;
+
+    /* Written by the loading thread before done is set and read by
+     * the main thread only after it observed done */
+    Level *level;
+    Error_type error;
+    int error_errno;
+    /* SDL_GetError() is per thread, so the message of the loading
+     * thread is copied out before the thread finishes */
+    char sdl_error[LEVEL_LOADER_SDL_ERROR_SIZE];
+};
+
+static int level_loader_thread(void *data)
+{
+    LevelLoader *loader = data;
+
+    loader->level = create_level_from_file_with_progress(
+        loader->file_name,
+        loader->script_cache_dir,
+        &loader->progress);
+    if (loader->level == NULL) {
+        loader->error = current_error();
+        loader->error_errno = errno;
+        SDL_strlcpy(loader->sdl_error, SDL_GetError(), sizeof(loader->sdl_error));
+    }
+
+    SDL_AtomicSet(&loader->done, 1);
+
+    return 0;
+}
+
+LevelLoader *create_level_loader(const char *file_name, const char *script_cache_dir)
+{
+    assert(file_name);
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return NULL;
+    }
+
+    LevelLoader *loader = PUSH_LT(lt, malloc(sizeof(LevelLoader)), free);
+    if (loader == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+    loader->lt = lt;
+    loader->level = NULL;
+    loader->error = ERROR_TYPE_OK;
+    loader->error_errno = 0;
+    loader->sdl_error[0] = 0;
+    SDL_AtomicSet(&loader->progress, 0);
+    SDL_AtomicSet(&loader->done, 0);
+
+    loader->file_name = PUSH_LT(lt, string_duplicate(file_name, NULL), free);
+    if (loader->file_name == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+
+    loader->script_cache_dir = NULL;
+    if (script_cache_dir != NULL) {
+        loader->script_cache_dir = PUSH_LT(lt, string_duplicate(script_cache_dir, NULL), free);
+        if (loader->script_cache_dir == NULL) {
+            throw_error(ERROR_TYPE_LIBC);
+            RETURN_LT(lt, NULL);
+        }
+    }
+
+    loader->thread = SDL_CreateThread(level_loader_thread, "level-loader", loader);
+    if (loader->thread == NULL) {
+        throw_error(ERROR_TYPE_SDL2);
+        RETURN_LT(lt, NULL);
+    }
+
+    return loader;
+}
+
+void destroy_level_loader(LevelLoader *loader)
+{
+    assert(loader);
+
+    SDL_WaitThread(loader->thread, NULL);
+
+    if (loader->level != NULL) {
+        destroy_level(loader->level);
+    }
+
+    RETURN_LT0(loader->lt);
+}
+
+int level_loader_poll(LevelLoader *loader)
+{
+    assert(loader);
+
+    if (!SDL_AtomicGet(&loader->done)) {
+        return 0;
+    }
+
+    if (loader->level == NULL) {
+        /* SDL2_mixer reports its errors through SDL_SetError as well */
+        SDL_SetError("%s", loader->sdl_error);
+        errno = loader->error_errno;
+        throw_error(loader->error);
+        return -1;
+    }
+
+    return 1;
+}
+
+float level_loader_progress(LevelLoader *loader)
+{
+    assert(loader);
+    return (float) SDL_AtomicGet(&loader->progress) / (float) LEVEL_LOAD_STAGES;
+}
+
+Level *level_loader_take(LevelLoader *loader)
+{
+    assert(loader);
+    assert(SDL_AtomicGet(&loader->done));
+
+    Level *level = loader->level;
+    loader->level = NULL;
+
+    return level;
+}
@@ -0,0 +1,27 @@
+#ifndef LEVEL_LOADER_H_
+#define LEVEL_LOADER_H_
+
+#include "game/level.h"
+
+// LevelLoader builds a Level on a background thread so the game keeps
+// rendering while the level is being parsed. The level is handed over
+// to the main thread only after it is completely built.
+
+typedef struct LevelLoader LevelLoader;
+
+// script_cache_dir is passed to create_level_from_file_with_progress
+LevelLoader *create_level_loader(const char *file_name, const char *script_cache_dir);
+// Waits for the loading thread and destroys the level unless it was
+// taken
+void destroy_level_loader(LevelLoader *loader);
+
+// Returns 0 while the level is being loaded, 1 when it can be taken
+// and -1 if the loading failed. In the latter case the error of the
+// loading thread is rethrown on the calling one.
+int level_loader_poll(LevelLoader *loader);
+// From 0.0f to 1.0f
+float level_loader_progress(LevelLoader *loader);
+// Transfers the ownership of the loaded level to the caller
+Level *level_loader_take(LevelLoader *loader);
+
+#endif  // LEVEL_LOADER_H_
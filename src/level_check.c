@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "game/level.h"
+#include "game/level/world_streamer.h"
+#include "system/error.h"
+
+/* Loads the levels exactly the way the game does and reports the
+ * first problem of every one of them. The loaders print the position
+ * of the malformed input themselves. */
+
+static void print_usage(FILE *stream)
+{
+    fprintf(stream, "Usage: level_check <level>...\n");
+    fprintf(stream, "    <level> is a level text file, a compiled level or a compiled world directory\n");
+}
+
+static int check_world(const char *world_dir)
+{
+    WorldStreamer *world = create_world_streamer(world_dir);
+    if (world == NULL) {
+        return -1;
+    }
+
+    /* Loading the level touches only the tiles around the player */
+    const int result = world_streamer_check(world);
+    destroy_world_streamer(world);
+
+    return result;
+}
+
+static int check_level(const char *file_name)
+{
+    /* Checking a level must not leave script dumps behind */
+    Level *level = create_level_from_file(file_name, NULL);
+    if (level == NULL) {
+        return -1;
+    }
+    destroy_level(level);
+
+    if (world_file_p(file_name) && check_world(file_name) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        print_usage(stderr);
+        return -1;
+    }
+
+    int failures = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (check_level(argv[i]) < 0) {
+            print_current_error_msg(argv[i]);
+            failures++;
+            continue;
+        }
+
+        printf("%s: OK\n", argv[i]);
+    }
+
+    return failures == 0 ? 0 : -1;
+}
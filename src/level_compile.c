@@ -0,0 +1,706 @@
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "game/level/compiled_level.h"
+#include "system/error.h"
+#include "system/line_stream.h"
+#include "system/lt.h"
+#include "system/lt/lt_adapters.h"
+
+#define LEVEL_LINE_MAX_LENGTH 512
+
+struct Section
+{
+    size_t count;
+    Point *points;
+    Rect *rects;
+    Color *colors;
+    uint32_t *strings;
+};
+
+typedef struct
+{
+    Lt *lt;
+    const char *file_name;
+    LineStream *stream;
+
+    struct Section sections[LEVEL_SECTION_N];
+
+    char *strings;
+    size_t strings_size;
+    size_t strings_capacity;
+} LevelCompiler;
+
+static void print_usage(FILE *stream)
+{
+    fprintf(stream, "Usage: level-compile [--tile-size <size>] <level.txt> <output>\n");
+    fprintf(stream, "    --tile-size <size>  cut the terrain into tiles and write a world directory\n");
+}
+
+static void compiler_error(const LevelCompiler *compiler, const char *message)
+{
+    fprintf(stderr, "%s: %s\n", compiler->file_name, message);
+}
+
+static const char *compiler_next_line(LevelCompiler *compiler)
+{
+    const char *line = line_stream_next(compiler->stream);
+
+    if (line == NULL) {
+        compiler_error(compiler, "unexpected end of file");
+    }
+
+    return line;
+}
+
+static int compiler_reserve_strings(LevelCompiler *compiler, size_t size)
+{
+    if (compiler->strings_size + size <= compiler->strings_capacity) {
+        return 0;
+    }
+
+    size_t capacity = compiler->strings_capacity;
+    while (capacity < compiler->strings_size + size) {
+        capacity *= 2;
+    }
+
+    char *strings = realloc(compiler->strings, capacity);
+    if (strings == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    compiler->strings = REPLACE_LT(compiler->lt, compiler->strings, strings);
+    compiler->strings_capacity = capacity;
+
+    return 0;
+}
+
+/* Appends the text to the string table without terminating it, so
+ * multi-line texts can be built up from several calls */
+static int compiler_append_string(LevelCompiler *compiler, const char *text, size_t len)
+{
+    if (compiler_reserve_strings(compiler, len) < 0) {
+        return -1;
+    }
+
+    memcpy(compiler->strings + compiler->strings_size, text, len);
+    compiler->strings_size += len;
+
+    return 0;
+}
+
+static int compiler_begin_string(LevelCompiler *compiler, uint32_t *offset)
+{
+    if (compiler->strings_size > UINT32_MAX) {
+        compiler_error(compiler, "string table is too big");
+        return -1;
+    }
+
+    *offset = (uint32_t) compiler->strings_size;
+
+    return 0;
+}
+
+static int compiler_end_string(LevelCompiler *compiler)
+{
+    return compiler_append_string(compiler, "", 1);
+}
+
+static int compiler_add_string(LevelCompiler *compiler, const char *text, uint32_t *offset)
+{
+    if (compiler_begin_string(compiler, offset) < 0
+        || compiler_append_string(compiler, text, strlen(text)) < 0) {
+        return -1;
+    }
+
+    return compiler_end_string(compiler);
+}
+
+static struct Section *compiler_begin_section(LevelCompiler *compiler,
+                                              LevelSection section_id,
+                                              size_t count)
+{
+    struct Section *section = &compiler->sections[section_id];
+    const unsigned int arrays = level_section_arrays(section_id);
+
+    section->count = count;
+
+    /* One extra record keeps malloc from returning NULL for empty
+     * sections, which PUSH_LT can't tell from a failure */
+#define SECTION_ARRAY(ARRAY, field)                                     \
+    if (arrays & (ARRAY)) {                                             \
+        section->field = PUSH_LT(                                       \
+            compiler->lt,                                               \
+            malloc(sizeof(*section->field) * (count + 1)),              \
+            free);                                                      \
+        if (section->field == NULL) {                                   \
+            throw_error(ERROR_TYPE_LIBC);                               \
+            return NULL;                                                \
+        }                                                               \
+    }
+
+    SECTION_ARRAY(LEVEL_ARRAY_POINTS, points)
+    SECTION_ARRAY(LEVEL_ARRAY_RECTS, rects)
+    SECTION_ARRAY(LEVEL_ARRAY_COLORS, colors)
+    SECTION_ARRAY(LEVEL_ARRAY_STRINGS, strings)
+
+#undef SECTION_ARRAY
+
+    return section;
+}
+
+static struct Section *compiler_counted_section(LevelCompiler *compiler, LevelSection section_id)
+{
+    size_t count = 0;
+    if (line_stream_read_count(compiler->stream, &count) < 0
+        || line_stream_end_line(compiler->stream) < 0) {
+        return NULL;
+    }
+
+    return compiler_begin_section(compiler, section_id, count);
+}
+
+static int compile_background(LevelCompiler *compiler)
+{
+    struct Section *section = compiler_begin_section(compiler, LEVEL_SECTION_BACKGROUND, 1);
+    if (section == NULL
+        || line_stream_read_color(compiler->stream, &section->colors[0]) < 0
+        || line_stream_end_line(compiler->stream) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int compile_player(LevelCompiler *compiler)
+{
+    struct Section *section = compiler_begin_section(compiler, LEVEL_SECTION_PLAYER, 1);
+    if (section == NULL
+        || line_stream_read_point(compiler->stream, &section->points[0]) < 0
+        || line_stream_read_color(compiler->stream, &section->colors[0]) < 0
+        || line_stream_end_line(compiler->stream) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Platforms, lava and back platforms */
+static int compile_colored_rects(LevelCompiler *compiler, LevelSection section_id)
+{
+    struct Section *section = compiler_counted_section(compiler, section_id);
+    if (section == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < section->count; ++i) {
+        if (line_stream_read_rect(compiler->stream, &section->rects[i]) < 0
+            || line_stream_read_color(compiler->stream, &section->colors[i]) < 0
+            || line_stream_end_line(compiler->stream) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int compile_goals(LevelCompiler *compiler)
+{
+    struct Section *section = compiler_counted_section(compiler, LEVEL_SECTION_GOALS);
+    if (section == NULL) {
+        return -1;
+    }
+
+    char id[LEVEL_LINE_MAX_LENGTH];
+    for (size_t i = 0; i < section->count; ++i) {
+        if (line_stream_read_word(compiler->stream, id, sizeof(id)) < 0
+            || line_stream_read_point(compiler->stream, &section->points[i]) < 0
+            || line_stream_read_rect(compiler->stream, &section->rects[i]) < 0
+            || line_stream_read_color(compiler->stream, &section->colors[i]) < 0
+            || line_stream_end_line(compiler->stream) < 0
+            || compiler_add_string(compiler, id, &section->strings[i]) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int compile_boxes(LevelCompiler *compiler)
+{
+    struct Section *section = compiler_counted_section(compiler, LEVEL_SECTION_BOXES);
+    if (section == NULL) {
+        return -1;
+    }
+
+    char id[LEVEL_LINE_MAX_LENGTH];
+    for (size_t i = 0; i < section->count; ++i) {
+        if (line_stream_read_word(compiler->stream, id, sizeof(id)) < 0
+            || line_stream_read_rect(compiler->stream, &section->rects[i]) < 0
+            || line_stream_read_color(compiler->stream, &section->colors[i]) < 0
+            || line_stream_end_line(compiler->stream) < 0
+            || compiler_add_string(compiler, id, &section->strings[i]) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int compile_labels(LevelCompiler *compiler)
+{
+    struct Section *section = compiler_counted_section(compiler, LEVEL_SECTION_LABELS);
+    if (section == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < section->count; ++i) {
+        if (line_stream_read_point(compiler->stream, &section->points[i]) < 0
+            || line_stream_read_color(compiler->stream, &section->colors[i]) < 0
+            || line_stream_end_line(compiler->stream) < 0) {
+            return -1;
+        }
+
+        const char *line = compiler_next_line(compiler);
+        if (line == NULL) {
+            return -1;
+        }
+
+        size_t len = strlen(line);
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+            len--;
+        }
+
+        if (compiler_begin_string(compiler, &section->strings[i]) < 0
+            || compiler_append_string(compiler, line, len) < 0
+            || compiler_end_string(compiler) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int compile_regions(LevelCompiler *compiler)
+{
+    struct Section *section = compiler_counted_section(compiler, LEVEL_SECTION_REGIONS);
+    if (section == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < section->count; ++i) {
+        size_t script_lines = 0;
+
+        if (line_stream_read_rect(compiler->stream, &section->rects[i]) < 0
+            || line_stream_end_line(compiler->stream) < 0
+            || line_stream_read_count(compiler->stream, &script_lines) < 0
+            || line_stream_end_line(compiler->stream) < 0) {
+            return -1;
+        }
+
+        /* The script is stored exactly as create_script_from_line_stream
+         * would have glued it together */
+        if (compiler_begin_string(compiler, &section->strings[i]) < 0) {
+            return -1;
+        }
+
+        for (size_t j = 0; j < script_lines; ++j) {
+            const char *line = compiler_next_line(compiler);
+            if (line == NULL
+                || compiler_append_string(compiler, line, strlen(line)) < 0) {
+                return -1;
+            }
+        }
+
+        if (compiler_end_string(compiler) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int compile_level(LevelCompiler *compiler)
+{
+    if (compile_background(compiler) < 0
+        || compile_player(compiler) < 0
+        || compile_colored_rects(compiler, LEVEL_SECTION_PLATFORMS) < 0
+        || compile_goals(compiler) < 0
+        || compile_colored_rects(compiler, LEVEL_SECTION_LAVA) < 0
+        || compile_colored_rects(compiler, LEVEL_SECTION_BACK_PLATFORMS) < 0
+        || compile_boxes(compiler) < 0
+        || compile_labels(compiler) < 0
+        || compile_regions(compiler) < 0
+        || line_stream_end_file(compiler->stream) < 0) {
+        return -1;
+    }
+
+    compiler->sections[LEVEL_SECTION_STRINGS].count = compiler->strings_size;
+
+    return 0;
+}
+
+static size_t align_offset(size_t offset)
+{
+    return (offset + LEVEL_FORMAT_ALIGNMENT - 1) / LEVEL_FORMAT_ALIGNMENT * LEVEL_FORMAT_ALIGNMENT;
+}
+
+static int write_padding(FILE *stream, size_t *offset, size_t aligned_offset)
+{
+    static const char zeros[LEVEL_FORMAT_ALIGNMENT] = {0};
+
+    assert(aligned_offset - *offset <= LEVEL_FORMAT_ALIGNMENT);
+
+    const size_t n = aligned_offset - *offset;
+    if (fwrite(zeros, 1, n, stream) != n) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+    *offset = aligned_offset;
+
+    return 0;
+}
+
+static int write_array(FILE *stream, size_t *offset, const void *data, size_t size)
+{
+    if (size > 0 && fwrite(data, 1, size, stream) != size) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+    *offset += size;
+
+    return 0;
+}
+
+static int write_compiled_level(const LevelCompiler *compiler, FILE *stream)
+{
+    struct LevelFormatHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LEVEL_FORMAT_MAGIC, LEVEL_FORMAT_MAGIC_SIZE);
+    header.version = LEVEL_FORMAT_VERSION;
+    header.section_count = LEVEL_SECTION_N;
+
+    size_t offset = align_offset(sizeof(header));
+    for (size_t i = 0; i < LEVEL_SECTION_N; ++i) {
+        const size_t count = compiler->sections[i].count;
+        header.sections[i].offset = offset;
+        header.sections[i].count = count;
+        offset = align_offset(offset + level_section_record_size((LevelSection) i) * count);
+    }
+
+    offset = 0;
+    if (write_array(stream, &offset, &header, sizeof(header)) < 0) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < LEVEL_SECTION_N; ++i) {
+        const struct Section *section = &compiler->sections[i];
+        const size_t count = section->count;
+
+        if (write_padding(stream, &offset, (size_t) header.sections[i].offset) < 0) {
+            return -1;
+        }
+
+        if (i == LEVEL_SECTION_STRINGS) {
+            if (write_array(stream, &offset, compiler->strings, compiler->strings_size) < 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        if ((section->points && write_array(stream, &offset, section->points, sizeof(Point) * count) < 0)
+            || (section->rects && write_array(stream, &offset, section->rects, sizeof(Rect) * count) < 0)
+            || (section->colors && write_array(stream, &offset, section->colors, sizeof(Color) * count) < 0)
+            || (section->strings && write_array(stream, &offset, section->strings, sizeof(uint32_t) * count) < 0)) {
+            return -1;
+        }
+    }
+
+    return write_padding(stream, &offset, align_offset(offset));
+}
+
+static int write_compiled_level_file(const LevelCompiler *compiler, const char *file_name)
+{
+    FILE *output = fopen(file_name, "wb");
+    if (output == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    if (write_compiled_level(compiler, output) < 0) {
+        fclose(output);
+        return -1;
+    }
+
+    if (fclose(output) != 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    return 0;
+}
+
+static const LevelSection terrain_sections[] = {
+    LEVEL_SECTION_PLATFORMS,
+    LEVEL_SECTION_LAVA,
+    LEVEL_SECTION_BACK_PLATFORMS
+};
+#define TERRAIN_SECTIONS_N (sizeof(terrain_sections) / sizeof(terrain_sections[0]))
+
+struct TileRect
+{
+    int x;
+    int y;
+    LevelSection section;
+    size_t index;
+};
+
+static int compare_tile_rects(const void *a, const void *b)
+{
+    const struct TileRect *r1 = a;
+    const struct TileRect *r2 = b;
+
+#define COMPARE(field) if (r1->field != r2->field) { return r1->field < r2->field ? -1 : 1; }
+    COMPARE(y)
+    COMPARE(x)
+    COMPARE(section)
+    COMPARE(index)
+#undef COMPARE
+
+    return 0;
+}
+
+static int tile_coord(const LevelCompiler *compiler, float x, float tile_size, int *result)
+{
+    const float tile = floorf(x / tile_size);
+
+    if (!(tile >= -1e6f && tile <= 1e6f)) {
+        compiler_error(compiler, "the level is too big for the tile size");
+        return -1;
+    }
+
+    *result = (int) tile;
+
+    return 0;
+}
+
+static int write_world_path(char *path, size_t size, const char *world_dir, const char *file_name)
+{
+    const int n = snprintf(path, size, "%s/%s", world_dir, file_name);
+    if (n < 0 || (size_t) n >= size) {
+        errno = ENAMETOOLONG;
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* See compiled_level.h for the layout of the world directory */
+static int write_compiled_world(LevelCompiler *compiler, const char *world_dir, float tile_size)
+{
+    size_t rects_count = 0;
+    for (size_t k = 0; k < TERRAIN_SECTIONS_N; ++k) {
+        rects_count += compiler->sections[terrain_sections[k]].count;
+    }
+
+    struct TileRect *tile_rects = PUSH_LT(
+        compiler->lt,
+        malloc(sizeof(struct TileRect) * (rects_count + 1)),
+        free);
+    if (tile_rects == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    float margin = 0.0f;
+    size_t n = 0;
+    for (size_t k = 0; k < TERRAIN_SECTIONS_N; ++k) {
+        const struct Section *section = &compiler->sections[terrain_sections[k]];
+
+        for (size_t i = 0; i < section->count; ++i) {
+            const Rect rect = section->rects[i];
+
+            if (tile_coord(compiler, rect.x, tile_size, &tile_rects[n].x) < 0
+                || tile_coord(compiler, rect.y, tile_size, &tile_rects[n].y) < 0) {
+                return -1;
+            }
+            tile_rects[n].section = terrain_sections[k];
+            tile_rects[n].index = i;
+            n++;
+
+            margin = fmaxf(margin, fmaxf(rect.w, rect.h));
+        }
+    }
+    qsort(tile_rects, rects_count, sizeof(struct TileRect), compare_tile_rects);
+
+    if (mkdir(world_dir, 0755) < 0 && errno != EEXIST) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    char path[4096];
+
+    /* The global level is the whole level without the terrain */
+    LevelCompiler global = *compiler;
+    for (size_t k = 0; k < TERRAIN_SECTIONS_N; ++k) {
+        global.sections[terrain_sections[k]].count = 0;
+    }
+    if (write_world_path(path, sizeof(path), world_dir, WORLD_GLOBAL_FILE) < 0
+        || write_compiled_level_file(&global, path) < 0) {
+        return -1;
+    }
+
+    /* Every tile is a level with an empty string table and nothing
+     * but the terrain, except for the background and the player,
+     * which every compiled level has to have */
+    LevelCompiler tile;
+    memset(&tile, 0, sizeof(tile));
+    tile.sections[LEVEL_SECTION_BACKGROUND] = compiler->sections[LEVEL_SECTION_BACKGROUND];
+    tile.sections[LEVEL_SECTION_PLAYER] = compiler->sections[LEVEL_SECTION_PLAYER];
+    for (size_t k = 0; k < TERRAIN_SECTIONS_N; ++k) {
+        const size_t count = compiler->sections[terrain_sections[k]].count;
+        struct Section *section = &tile.sections[terrain_sections[k]];
+
+        section->rects = PUSH_LT(compiler->lt, malloc(sizeof(Rect) * (count + 1)), free);
+        section->colors = PUSH_LT(compiler->lt, malloc(sizeof(Color) * (count + 1)), free);
+        if (section->rects == NULL || section->colors == NULL) {
+            throw_error(ERROR_TYPE_LIBC);
+            return -1;
+        }
+    }
+
+    size_t tiles_count = 0;
+    for (size_t i = 0; i < rects_count; i++) {
+        tiles_count += i == 0
+            || tile_rects[i].x != tile_rects[i - 1].x
+            || tile_rects[i].y != tile_rects[i - 1].y;
+    }
+
+    if (write_world_path(path, sizeof(path), world_dir, WORLD_INDEX_FILE) < 0) {
+        return -1;
+    }
+
+    FILE *index = PUSH_LT(compiler->lt, fopen(path, "w"), fclose_lt);
+    if (index == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    fprintf(index, "%.9g %.9g\n", (double) tile_size, (double) margin);
+    fprintf(index, "%lu\n", (unsigned long) tiles_count);
+
+    for (size_t begin = 0, end = 0; begin < rects_count; begin = end) {
+        for (size_t k = 0; k < TERRAIN_SECTIONS_N; ++k) {
+            tile.sections[terrain_sections[k]].count = 0;
+        }
+
+        while (end < rects_count
+               && tile_rects[end].x == tile_rects[begin].x
+               && tile_rects[end].y == tile_rects[begin].y) {
+            const struct TileRect *tile_rect = &tile_rects[end];
+            const struct Section *source = &compiler->sections[tile_rect->section];
+            struct Section *section = &tile.sections[tile_rect->section];
+
+            section->rects[section->count] = source->rects[tile_rect->index];
+            section->colors[section->count] = source->colors[tile_rect->index];
+            section->count++;
+            end++;
+        }
+
+        char tile_file[64];
+        snprintf(tile_file, sizeof(tile_file), WORLD_TILE_FILE_FORMAT, tile_rects[begin].x, tile_rects[begin].y);
+        if (write_world_path(path, sizeof(path), world_dir, tile_file) < 0
+            || write_compiled_level_file(&tile, path) < 0) {
+            return -1;
+        }
+
+        fprintf(index, "%d %d\n", tile_rects[begin].x, tile_rects[begin].y);
+    }
+
+    if (fclose(RELEASE_LT(compiler->lt, index)) != 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    float tile_size = 0.0f;
+
+    if (argc >= 3 && strcmp(argv[1], "--tile-size") == 0) {
+        char *end = NULL;
+        tile_size = strtof(argv[2], &end);
+        if (end == argv[2] || *end != '\0' || !(tile_size > 0.0f)) {
+            fprintf(stderr, "Tile size has to be a positive number\n");
+            return -1;
+        }
+
+        argc -= 2;
+        argv += 2;
+    }
+
+    if (argc < 3) {
+        print_usage(stderr);
+        return -1;
+    }
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    LevelCompiler *compiler = PUSH_LT(lt, calloc(1, sizeof(LevelCompiler)), free);
+    if (compiler == NULL) {
+        print_current_error_msg("Could not allocate the compiler");
+        RETURN_LT(lt, -1);
+    }
+    compiler->lt = lt;
+    compiler->file_name = argv[1];
+
+    compiler->strings = PUSH_LT(lt, malloc(1), free);
+    if (compiler->strings == NULL) {
+        print_current_error_msg("Could not allocate the string table");
+        RETURN_LT(lt, -1);
+    }
+    compiler->strings_capacity = 1;
+
+    compiler->stream = PUSH_LT(
+        lt,
+        create_line_stream(argv[1], "r", LEVEL_LINE_MAX_LENGTH),
+        destroy_line_stream);
+    if (compiler->stream == NULL) {
+        print_current_error_msg("Could not open the level");
+        RETURN_LT(lt, -1);
+    }
+
+    if (compile_level(compiler) < 0) {
+        print_current_error_msg("Could not compile the level");
+        RETURN_LT(lt, -1);
+    }
+
+    if (tile_size > 0.0f) {
+        if (write_compiled_world(compiler, argv[2], tile_size) < 0) {
+            print_current_error_msg("Could not write the compiled world");
+            RETURN_LT(lt, -1);
+        }
+
+        RETURN_LT(lt, 0);
+    }
+
+    if (write_compiled_level_file(compiler, argv[2]) < 0) {
+        print_current_error_msg("Could not write the compiled level");
+        RETURN_LT(lt, -1);
+    }
+
+    RETURN_LT(lt, 0);
+}
@@ -0,0 +1,448 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game/level.h"
+#include "system/error.h"
+#include "system/lt.h"
+
+/* Reports what a level costs before anybody runs it: how many
+ * entities it has, how densely its platforms are packed, how many of
+ * them a player sized rect can touch at once and how many rect tests
+ * the physics of level_update makes every tick. */
+
+#define STATS_DEFAULT_CELL_SIZE 256.0f
+/* The cells grow until the grid fits */
+#define STATS_MAX_CELLS (1 << 22)
+#define STATS_HISTOGRAM_SIZE 32
+
+static void print_usage(FILE *stream)
+{
+    fprintf(stream, "Usage: level_stats [--cell-size <size>] <level>...\n");
+    fprintf(stream, "    <level> is a level text file, a compiled level or a compiled world directory\n");
+    fprintf(stream, "    --cell-size <size>  size of the cells of the density histogram (default %.0f)\n",
+            STATS_DEFAULT_CELL_SIZE);
+}
+
+static bool rect_finite_p(Rect r)
+{
+    return isfinite(r.x) && isfinite(r.y) && isfinite(r.x + r.w) && isfinite(r.y + r.h);
+}
+
+/* Copies the rects of all of the platforms the solids collide with.
+ * The rects that do not fit into the float range cannot touch
+ * anything and are left out. */
+static Rect *collect_platform_rects(const Level *level, size_t *count)
+{
+    size_t platforms_size = 0;
+    Platforms *const *platforms = level_platforms(level, &platforms_size);
+
+    size_t capacity = 0;
+    for (size_t i = 0; i < platforms_size; ++i) {
+        capacity += platforms_count(platforms[i]);
+    }
+
+    Rect *rects = malloc(sizeof(Rect) * (capacity + 1));
+    if (rects == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return NULL;
+    }
+
+    *count = 0;
+    for (size_t i = 0; i < platforms_size; ++i) {
+        const size_t n = platforms_count(platforms[i]);
+        for (size_t j = 0; j < n; ++j) {
+            const Rect r = platforms_rect(platforms[i], j);
+            if (rect_finite_p(r)) {
+                rects[(*count)++] = r;
+            }
+        }
+    }
+
+    return rects;
+}
+
+static size_t cell_index(float x, size_t side)
+{
+    if (!(x > 0.0f)) {
+        return 0;
+    }
+
+    return x >= (float) side ? side - 1 : (size_t) x;
+}
+
+/* Bucket 0 is for the empty cells, bucket k > 0 is for the cells with
+ * [2^(k - 1), 2^k) rects */
+static size_t histogram_bucket(size_t n)
+{
+    size_t bucket = 0;
+    while (n > 0 && bucket < STATS_HISTOGRAM_SIZE - 1) {
+        n >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static int print_density(const Rect *rects, size_t count, float cell_size)
+{
+    if (count == 0) {
+        printf("  Platform density: no platforms\n");
+        return 0;
+    }
+
+    float x0 = rects[0].x, y0 = rects[0].y;
+    float x1 = rects[0].x + rects[0].w, y1 = rects[0].y + rects[0].h;
+    for (size_t i = 1; i < count; ++i) {
+        x0 = fminf(x0, rects[i].x);
+        y0 = fminf(y0, rects[i].y);
+        x1 = fmaxf(x1, rects[i].x + rects[i].w);
+        y1 = fmaxf(y1, rects[i].y + rects[i].h);
+    }
+
+    size_t cols = 0, rows = 0;
+    for (;;) {
+        cols = (size_t) ceilf(fmaxf((x1 - x0) / cell_size, 1.0f));
+        rows = (size_t) ceilf(fmaxf((y1 - y0) / cell_size, 1.0f));
+        if ((double) cols * (double) rows <= STATS_MAX_CELLS) {
+            break;
+        }
+        cell_size *= 2.0f;
+    }
+
+    /* Every rect adds itself to the corners of the cells it covers
+     * and the prefix sums spread it over the cells in between */
+    long int *cells = calloc((cols + 1) * (rows + 1), sizeof(long int));
+    if (cells == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    const size_t stride = cols + 1;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t cx0 = cell_index((rects[i].x - x0) / cell_size, cols);
+        const size_t cy0 = cell_index((rects[i].y - y0) / cell_size, rows);
+        const size_t cx1 = cell_index((rects[i].x + rects[i].w - x0) / cell_size, cols) + 1;
+        const size_t cy1 = cell_index((rects[i].y + rects[i].h - y0) / cell_size, rows) + 1;
+
+        cells[cy0 * stride + cx0] += 1;
+        cells[cy0 * stride + cx1] -= 1;
+        cells[cy1 * stride + cx0] -= 1;
+        cells[cy1 * stride + cx1] += 1;
+    }
+
+    for (size_t y = 0; y < rows; ++y) {
+        for (size_t x = 1; x < cols; ++x) {
+            cells[y * stride + x] += cells[y * stride + x - 1];
+        }
+    }
+    for (size_t y = 1; y < rows; ++y) {
+        for (size_t x = 0; x < cols; ++x) {
+            cells[y * stride + x] += cells[(y - 1) * stride + x];
+        }
+    }
+
+    size_t histogram[STATS_HISTOGRAM_SIZE] = { 0 };
+    size_t densest = 0;
+    for (size_t y = 0; y < rows; ++y) {
+        for (size_t x = 0; x < cols; ++x) {
+            const size_t n = (size_t) cells[y * stride + x];
+            histogram[histogram_bucket(n)]++;
+            if (n > (size_t) cells[densest]) {
+                densest = y * stride + x;
+            }
+        }
+    }
+
+    printf("  Platform density, %.0fx%.0f cells over %.0fx%.0f:\n",
+           cell_size, cell_size, x1 - x0, y1 - y0);
+    printf("    %-16s %s\n", "rects in a cell", "cells");
+    for (size_t k = 0; k < STATS_HISTOGRAM_SIZE; ++k) {
+        if (histogram[k] == 0) {
+            continue;
+        }
+
+        char bucket[32];
+        if (k <= 1) {
+            snprintf(bucket, sizeof(bucket), "%zu", k);
+        } else {
+            snprintf(bucket, sizeof(bucket), "%zu-%zu",
+                     (size_t) 1 << (k - 1),
+                     ((size_t) 1 << k) - 1);
+        }
+        printf("    %-16s %zu\n", bucket, histogram[k]);
+    }
+    printf("    the densest cell has %ld rects at (%.0f, %.0f)\n",
+           cells[densest],
+           x0 + (float) (densest % stride) * cell_size,
+           y0 + (float) (densest / stride) * cell_size);
+
+    free(cells);
+
+    return 0;
+}
+
+/* A window of size w x h with its top-left corner at (x, y) overlaps
+ * a rect r when x is in (r.x - w, r.x + r.w) and y is in (r.y - h,
+ * r.y + r.h). The worst window is the deepest point of those
+ * intervals, found by sweeping over x with a segment tree of the
+ * amount of intervals covering every piece of y. */
+
+struct Interval
+{
+    float x;
+    int delta;
+    size_t y0, y1;
+};
+
+struct Sweep
+{
+    size_t size;
+    long int *max;
+    long int *add;
+};
+
+static int compare_floats(const void *a, const void *b)
+{
+    const float fa = *(const float *) a;
+    const float fb = *(const float *) b;
+    return (fa > fb) - (fa < fb);
+}
+
+static int compare_intervals(const void *a, const void *b)
+{
+    const struct Interval *ia = a;
+    const struct Interval *ib = b;
+
+    if (ia->x != ib->x) {
+        return ia->x < ib->x ? -1 : 1;
+    }
+
+    /* The intervals are open, so the ones that end at x do not
+     * overlap the ones that start there */
+    return ia->delta - ib->delta;
+}
+
+static size_t find_float(const float *ys, size_t count, float y)
+{
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (ys[mid] < y) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void sweep_add(struct Sweep *sweep, size_t node,
+                      size_t lo, size_t hi,
+                      size_t y0, size_t y1,
+                      int delta)
+{
+    if (y1 <= lo || hi <= y0) {
+        return;
+    }
+
+    if (y0 <= lo && hi <= y1) {
+        sweep->add[node] += delta;
+        sweep->max[node] += delta;
+        return;
+    }
+
+    const size_t mid = lo + (hi - lo) / 2;
+    sweep_add(sweep, node * 2, lo, mid, y0, y1, delta);
+    sweep_add(sweep, node * 2 + 1, mid, hi, y0, y1, delta);
+
+    const long int children = sweep->max[node * 2] > sweep->max[node * 2 + 1]
+        ? sweep->max[node * 2]
+        : sweep->max[node * 2 + 1];
+    sweep->max[node] = children + sweep->add[node];
+}
+
+static size_t sweep_argmax(const struct Sweep *sweep)
+{
+    size_t node = 1, lo = 0, hi = sweep->size;
+    while (hi - lo > 1) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (sweep->max[node * 2] >= sweep->max[node * 2 + 1]) {
+            node = node * 2;
+            hi = mid;
+        } else {
+            node = node * 2 + 1;
+            lo = mid;
+        }
+    }
+    return lo;
+}
+
+static int print_worst_window(const Rect *rects, size_t count, Rect player)
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    float *ys = PUSH_LT(lt, malloc(sizeof(float) * count * 2), free);
+    struct Interval *intervals = PUSH_LT(lt, malloc(sizeof(struct Interval) * count * 2), free);
+    if (ys == NULL || intervals == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        ys[i * 2] = rects[i].y - player.h;
+        ys[i * 2 + 1] = rects[i].y + rects[i].h;
+    }
+    qsort(ys, count * 2, sizeof(float), compare_floats);
+
+    size_t ys_count = 0;
+    for (size_t i = 0; i < count * 2; ++i) {
+        if (ys_count == 0 || ys[ys_count - 1] != ys[i]) {
+            ys[ys_count++] = ys[i];
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t y0 = find_float(ys, ys_count, rects[i].y - player.h);
+        const size_t y1 = find_float(ys, ys_count, rects[i].y + rects[i].h);
+        intervals[i * 2] = (struct Interval) { rects[i].x - player.w, 1, y0, y1 };
+        intervals[i * 2 + 1] = (struct Interval) { rects[i].x + rects[i].w, -1, y0, y1 };
+    }
+    qsort(intervals, count * 2, sizeof(struct Interval), compare_intervals);
+
+    struct Sweep sweep;
+    sweep.size = ys_count;
+    sweep.max = PUSH_LT(lt, calloc(ys_count * 4, sizeof(long int)), free);
+    sweep.add = PUSH_LT(lt, calloc(ys_count * 4, sizeof(long int)), free);
+    if (sweep.max == NULL || sweep.add == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, -1);
+    }
+
+    long int worst = 0;
+    float worst_x = 0.0f, worst_y = 0.0f;
+    for (size_t i = 0; i < count * 2;) {
+        const float x = intervals[i].x;
+        for (; i < count * 2 && intervals[i].x == x; ++i) {
+            sweep_add(&sweep, 1, 0, sweep.size,
+                      intervals[i].y0, intervals[i].y1,
+                      intervals[i].delta);
+        }
+
+        if (sweep.max[1] > worst) {
+            worst = sweep.max[1];
+            worst_x = x;
+            worst_y = ys[sweep_argmax(&sweep)];
+        }
+    }
+
+    printf("  The worst %.0fx%.0f rect touches %ld platform rects at (%.0f, %.0f)\n",
+           player.w, player.h, worst, worst_x, worst_y);
+
+    RETURN_LT(lt, 0);
+}
+
+/* Mirrors the physics of level_update: every solid is tested against
+ * every platform rect before and after it is tested against the
+ * other solids, and every solid is tested against every lava rect. */
+static void print_collision_cost(const struct LevelStats *stats)
+{
+    const size_t solids = stats->boxes + 1;
+    const size_t platforms = 2 * solids * stats->platforms;
+    const size_t each_other = solids * (solids - 1);
+    const size_t lava = solids * stats->lava;
+
+    printf("  Rect tests per tick:\n");
+    printf("    %-20s %zu\n", "solids vs platforms", platforms);
+    printf("    %-20s %zu\n", "solids vs solids", each_other);
+    printf("    %-20s %zu\n", "solids vs lava", lava);
+    printf("    %-20s %zu\n", "total", platforms + each_other + lava);
+}
+
+static int print_level_stats(const char *file_name, float cell_size)
+{
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    Level *level = PUSH_LT(lt, create_level_from_file(file_name, NULL), destroy_level);
+    if (level == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    struct LevelStats stats;
+    level_stats(level, &stats);
+
+    size_t rects_count = 0;
+    Rect *rects = PUSH_LT(lt, collect_platform_rects(level, &rects_count), free);
+    if (rects == NULL) {
+        RETURN_LT(lt, -1);
+    }
+
+    printf("%s\n", file_name);
+    if (stats.tiles > 0) {
+        /* Only the terrain around the player is resident, which is
+         * also all the physics ever sees at once */
+        printf("  Terrain of %zu resident tiles around the player\n", stats.tiles);
+    }
+    printf("  Entities:\n");
+    printf("    %-16s %zu\n", "platforms", stats.platforms);
+    printf("    %-16s %zu\n", "back platforms", stats.back_platforms);
+    printf("    %-16s %zu\n", "lava", stats.lava);
+    printf("    %-16s %zu\n", "goals", stats.goals);
+    printf("    %-16s %zu\n", "boxes", stats.boxes);
+    printf("    %-16s %zu\n", "labels", stats.labels);
+    printf("    %-16s %zu\n", "regions", stats.regions);
+
+    if (print_density(rects, rects_count, cell_size) < 0
+        || print_worst_window(rects, rects_count, stats.player) < 0) {
+        RETURN_LT(lt, -1);
+    }
+
+    print_collision_cost(&stats);
+
+    RETURN_LT(lt, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    float cell_size = STATS_DEFAULT_CELL_SIZE;
+
+    if (argc >= 3 && strcmp(argv[1], "--cell-size") == 0) {
+        char *end = NULL;
+        cell_size = strtof(argv[2], &end);
+        if (end == argv[2] || *end != '\0' || !(cell_size > 0.0f) || !isfinite(cell_size)) {
+            fprintf(stderr, "Cell size has to be a positive number\n");
+            return -1;
+        }
+
+        argc -= 2;
+        argv += 2;
+    }
+
+    if (argc < 2) {
+        print_usage(stderr);
+        return -1;
+    }
+
+    int failures = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (print_level_stats(argv[i], cell_size) < 0) {
+            print_current_error_msg(argv[i]);
+            failures++;
+        }
+    }
+
+    return failures == 0 ? 0 : -1;
+}
@@ -0,0 +1,1002 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "system/arena.h"
+#include "system/error.h"
+#include "system/lt.h"
+#include "system/lt/lt_adapters.h"
+
+/* Compiles an Inkscape SVG into the level text file in one pass over
+ * the XML. There is no document tree: the rects and texts the level
+ * is made of are picked up as their tags go by and appended to the
+ * lists of their sections, everything else is skipped. See the
+ * Objects Reference in README.md for the ids the entities are
+ * recognized by. */
+
+#define SVG_ARENA_CHUNK_SIZE (64 * 1024)
+
+typedef enum SvgEntityType {
+    SVG_ENTITY_BACKGROUND = 0,
+    SVG_ENTITY_PLAYER,
+    SVG_ENTITY_PLATFORM,
+    SVG_ENTITY_GOAL,
+    SVG_ENTITY_LAVA,
+    SVG_ENTITY_BACK_PLATFORM,
+    SVG_ENTITY_BOX,
+    SVG_ENTITY_LABEL,
+    SVG_ENTITY_SCRIPT,
+    /* Hides the goal with the same id, see svg_resolve_goals */
+    SVG_ENTITY_REGION,
+
+    SVG_ENTITY_N
+} SvgEntityType;
+
+enum SvgAttribute {
+    SVG_ATTR_ID = 0,
+    SVG_ATTR_X,
+    SVG_ATTR_Y,
+    SVG_ATTR_WIDTH,
+    SVG_ATTR_HEIGHT,
+    SVG_ATTR_STYLE,
+
+    SVG_ATTR_N
+};
+
+static const char *const attribute_names[SVG_ATTR_N] = {
+    [SVG_ATTR_ID] = "id",
+    [SVG_ATTR_X] = "x",
+    [SVG_ATTR_Y] = "y",
+    [SVG_ATTR_WIDTH] = "width",
+    [SVG_ATTR_HEIGHT] = "height",
+    [SVG_ATTR_STYLE] = "style"
+};
+
+#define ATTR(name) (1u << SVG_ATTR_ ## name)
+#define POINT_ATTRS (ATTR(X) | ATTR(Y))
+#define RECT_ATTRS (ATTR(X) | ATTR(Y) | ATTR(WIDTH) | ATTR(HEIGHT))
+
+/* The attributes every entity is written with */
+static const unsigned int required_attributes[SVG_ENTITY_N] = {
+    [SVG_ENTITY_BACKGROUND] = ATTR(STYLE),
+    [SVG_ENTITY_PLAYER] = POINT_ATTRS | ATTR(STYLE),
+    [SVG_ENTITY_PLATFORM] = RECT_ATTRS | ATTR(STYLE),
+    [SVG_ENTITY_GOAL] = POINT_ATTRS | ATTR(STYLE),
+    [SVG_ENTITY_LAVA] = RECT_ATTRS | ATTR(STYLE),
+    [SVG_ENTITY_BACK_PLATFORM] = RECT_ATTRS | ATTR(STYLE),
+    [SVG_ENTITY_BOX] = RECT_ATTRS | ATTR(STYLE),
+    [SVG_ENTITY_LABEL] = POINT_ATTRS | ATTR(STYLE),
+    [SVG_ENTITY_SCRIPT] = RECT_ATTRS,
+    [SVG_ENTITY_REGION] = RECT_ATTRS
+};
+
+typedef struct SvgEntity SvgEntity;
+
+struct SvgEntity
+{
+    SvgEntity *next;
+    /* Where the tag starts, for the error messages */
+    const char *position;
+
+    const char *attrs[SVG_ATTR_N];
+    char color[7];
+
+    /* Label: the texts of the children joined by spaces.
+     * Script: the text of the first child, the file with the source
+     * code of the script. */
+    char *text;
+    /* Script: the contents of that file */
+    const char *source;
+    size_t source_size;
+    /* Goal: the region hiding it */
+    const SvgEntity *region;
+};
+
+struct SvgList
+{
+    SvgEntity *first;
+    SvgEntity **last;
+    size_t count;
+};
+
+typedef struct
+{
+    Lt *lt;
+    Arena *arena;
+    const char *file_name;
+
+    const char *source;
+    const char *end;
+    const char *cursor;
+
+    struct SvgList entities[SVG_ENTITY_N];
+
+    /* The element of the current label or script and how deep it is.
+     * The texts of its direct children are collected into it. */
+    SvgEntity *owner;
+    SvgEntityType owner_type;
+    size_t owner_depth;
+    size_t depth;
+    /* The character data right after the start tag of a direct child
+     * of the owner is its text */
+    bool text_pending;
+} SvgParser;
+
+static void print_usage(FILE *stream)
+{
+    fprintf(stream, "Usage: svg2level <level.svg> <level.txt>\n");
+}
+
+static size_t svg_line(const SvgParser *parser, const char *position)
+{
+    size_t line = 1;
+    for (const char *s = parser->source; s < position; ++s) {
+        if (*s == '\n') {
+            line++;
+        }
+    }
+    return line;
+}
+
+static void svg_error(const SvgParser *parser, const char *position, const char *message)
+{
+    fprintf(stderr, "%s:%zu: %s\n",
+            parser->file_name,
+            svg_line(parser, position),
+            message);
+}
+
+static void svg_entity_error(const SvgParser *parser, const SvgEntity *entity, const char *message)
+{
+    fprintf(stderr, "%s:%zu: %s: %s\n",
+            parser->file_name,
+            svg_line(parser, entity->position),
+            entity->attrs[SVG_ATTR_ID],
+            message);
+}
+
+static bool svg_space_p(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool svg_skip_prefix(SvgParser *parser, const char *prefix)
+{
+    const size_t n = strlen(prefix);
+    if ((size_t) (parser->end - parser->cursor) >= n
+        && memcmp(parser->cursor, prefix, n) == 0) {
+        parser->cursor += n;
+        return true;
+    }
+    return false;
+}
+
+/* Moves the cursor right past the terminator */
+static int svg_skip_past(SvgParser *parser, const char *terminator, const char *what)
+{
+    const char *start = parser->cursor;
+    const size_t n = strlen(terminator);
+
+    for (; (size_t) (parser->end - parser->cursor) >= n; parser->cursor++) {
+        if (memcmp(parser->cursor, terminator, n) == 0) {
+            parser->cursor += n;
+            return 0;
+        }
+    }
+
+    svg_error(parser, start, what);
+    return -1;
+}
+
+static void svg_put_utf8(char **out, unsigned long code)
+{
+    char *s = *out;
+
+    if (code < 0x80) {
+        *s++ = (char) code;
+    } else if (code < 0x800) {
+        *s++ = (char) (0xC0 | (code >> 6));
+        *s++ = (char) (0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        *s++ = (char) (0xE0 | (code >> 12));
+        *s++ = (char) (0x80 | ((code >> 6) & 0x3F));
+        *s++ = (char) (0x80 | (code & 0x3F));
+    } else {
+        *s++ = (char) (0xF0 | (code >> 18));
+        *s++ = (char) (0x80 | ((code >> 12) & 0x3F));
+        *s++ = (char) (0x80 | ((code >> 6) & 0x3F));
+        *s++ = (char) (0x80 | (code & 0x3F));
+    }
+
+    *out = s;
+}
+
+/* Copies [begin, end) into the arena replacing the references with
+ * the characters they stand for. The attribute values also get their
+ * line breaks and tabs turned into spaces, like any XML parser
+ * does. */
+static char *svg_decode(SvgParser *parser, const char *begin, const char *end, bool attribute)
+{
+    /* A reference is never shorter than what it decodes to */
+    char *result = arena_alloc(parser->arena, (size_t) (end - begin) + 1);
+    if (result == NULL) {
+        return NULL;
+    }
+
+    char *out = result;
+    for (const char *s = begin; s < end;) {
+        if (*s != '&') {
+            *out++ = attribute && svg_space_p(*s) ? ' ' : *s;
+            s++;
+            continue;
+        }
+
+        const char *semicolon = memchr(s, ';', (size_t) (end - s));
+        if (semicolon == NULL) {
+            svg_error(parser, s, "unterminated reference");
+            return NULL;
+        }
+
+        const char *name = s + 1;
+        const size_t len = (size_t) (semicolon - name);
+        if (len == 2 && memcmp(name, "lt", 2) == 0) {
+            *out++ = '<';
+        } else if (len == 2 && memcmp(name, "gt", 2) == 0) {
+            *out++ = '>';
+        } else if (len == 3 && memcmp(name, "amp", 3) == 0) {
+            *out++ = '&';
+        } else if (len == 4 && memcmp(name, "quot", 4) == 0) {
+            *out++ = '"';
+        } else if (len == 4 && memcmp(name, "apos", 4) == 0) {
+            *out++ = '\'';
+        } else if (len >= 2 && name[0] == '#') {
+            const bool hex = name[1] == 'x';
+            char *digits_end = NULL;
+            const unsigned long code = strtoul(name + (hex ? 2 : 1), &digits_end, hex ? 16 : 10);
+            if (digits_end != semicolon || code == 0 || code > 0x10FFFF) {
+                svg_error(parser, s, "invalid character reference");
+                return NULL;
+            }
+            svg_put_utf8(&out, code);
+        } else {
+            svg_error(parser, s, "unknown entity");
+            return NULL;
+        }
+
+        s = semicolon + 1;
+    }
+    *out = '\0';
+
+    return result;
+}
+
+static char *svg_join_text(SvgParser *parser, const char *prefix, const char *text)
+{
+    const size_t prefix_len = strlen(prefix);
+    const size_t text_len = strlen(text);
+
+    char *result = arena_alloc(parser->arena, prefix_len + text_len + 2);
+    if (result == NULL) {
+        return NULL;
+    }
+
+    memcpy(result, prefix, prefix_len);
+    result[prefix_len] = ' ';
+    memcpy(result + prefix_len + 1, text, text_len + 1);
+
+    return result;
+}
+
+/* Text of a direct child of the current label or script */
+static int svg_owner_append(SvgParser *parser, char *text)
+{
+    SvgEntity *owner = parser->owner;
+    if (owner->text == NULL) {
+        owner->text = text;
+    } else if (parser->owner_type == SVG_ENTITY_LABEL) {
+        owner->text = svg_join_text(parser, owner->text, text);
+        if (owner->text == NULL) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Character data, with its references decoded */
+static int svg_owner_text(SvgParser *parser, const char *begin, const char *end)
+{
+    char *text = svg_decode(parser, begin, end, false);
+    if (text == NULL) {
+        return -1;
+    }
+
+    return svg_owner_append(parser, text);
+}
+
+/* A CDATA section, taken verbatim: `&` means nothing special in it */
+static int svg_owner_raw_text(SvgParser *parser, const char *begin, const char *end)
+{
+    const size_t n = (size_t) (end - begin);
+    char *text = arena_alloc(parser->arena, n + 1);
+    if (text == NULL) {
+        return -1;
+    }
+
+    memcpy(text, begin, n);
+    text[n] = '\0';
+
+    return svg_owner_append(parser, text);
+}
+
+static void svg_child_started(SvgParser *parser)
+{
+    if (parser->owner != NULL && parser->depth == parser->owner_depth) {
+        /* A child without any text contributes an empty one, so it
+         * still gets its separator in a label */
+        parser->text_pending = true;
+    }
+}
+
+static int svg_flush_pending_text(SvgParser *parser)
+{
+    if (parser->text_pending) {
+        parser->text_pending = false;
+        if (svg_owner_text(parser, parser->cursor, parser->cursor) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Picks the last fill:#rrggbb of the style */
+static int svg_color_from_style(const char *style, char color[7])
+{
+    bool found = false;
+
+    for (const char *s = strstr(style, "fill:#"); s != NULL; s = strstr(s + 1, "fill:#")) {
+        const char *hex = s + strlen("fill:#");
+        size_t n = 0;
+        while (n < 6 && ((hex[n] >= '0' && hex[n] <= '9') || (hex[n] >= 'a' && hex[n] <= 'z'))) {
+            n++;
+        }
+
+        if (n == 6) {
+            memcpy(color, hex, 6);
+            color[6] = '\0';
+            found = true;
+        }
+    }
+
+    return found ? 0 : -1;
+}
+
+static bool svg_id_p(const char *id, const char *name)
+{
+    return id != NULL && strcmp(id, name) == 0;
+}
+
+static bool svg_id_prefix_p(const char *id, const char *prefix)
+{
+    return id != NULL && strncmp(id, prefix, strlen(prefix)) == 0;
+}
+
+static SvgEntityType svg_rect_type(const char *id)
+{
+    if (svg_id_p(id, "background")) {
+        return SVG_ENTITY_BACKGROUND;
+    } else if (svg_id_p(id, "player")) {
+        return SVG_ENTITY_PLAYER;
+    } else if (svg_id_prefix_p(id, "rect")) {
+        return SVG_ENTITY_PLATFORM;
+    } else if (svg_id_prefix_p(id, "goal")) {
+        return SVG_ENTITY_GOAL;
+    } else if (svg_id_prefix_p(id, "lava")) {
+        return SVG_ENTITY_LAVA;
+    } else if (svg_id_prefix_p(id, "backrect")) {
+        return SVG_ENTITY_BACK_PLATFORM;
+    } else if (svg_id_prefix_p(id, "box")) {
+        return SVG_ENTITY_BOX;
+    } else if (svg_id_prefix_p(id, "script")) {
+        return SVG_ENTITY_SCRIPT;
+    } else if (svg_id_prefix_p(id, "region")) {
+        return SVG_ENTITY_REGION;
+    }
+
+    return SVG_ENTITY_N;
+}
+
+/* Name of an element of the SVG namespace without the svg: prefix,
+ * NULL for the elements of the other namespaces */
+static const char *svg_local_name(const char *name, size_t len, size_t *local_len)
+{
+    const char *colon = memchr(name, ':', len);
+    if (colon == NULL) {
+        *local_len = len;
+        return name;
+    }
+
+    if (colon - name == 3 && memcmp(name, "svg", 3) == 0) {
+        *local_len = len - 4;
+        return colon + 1;
+    }
+
+    return NULL;
+}
+
+static bool svg_name_p(const char *name, size_t len, const char *expected)
+{
+    return name != NULL && len == strlen(expected) && memcmp(name, expected, len) == 0;
+}
+
+static const char *svg_scan_name(SvgParser *parser)
+{
+    const char *name = parser->cursor;
+    while (parser->cursor < parser->end
+           && !svg_space_p(*parser->cursor)
+           && *parser->cursor != '='
+           && *parser->cursor != '/'
+           && *parser->cursor != '>') {
+        parser->cursor++;
+    }
+    return name;
+}
+
+static void svg_skip_spaces(SvgParser *parser)
+{
+    while (parser->cursor < parser->end && svg_space_p(*parser->cursor)) {
+        parser->cursor++;
+    }
+}
+
+/* Parses the attributes of the start tag up to and including its
+ * closing bracket. The values of the attributes the level uses are
+ * decoded into attrs when attrs is not NULL. */
+static int svg_parse_attributes(SvgParser *parser,
+                                const char *attrs[SVG_ATTR_N],
+                                bool *empty)
+{
+    for (;;) {
+        svg_skip_spaces(parser);
+
+        if (parser->cursor >= parser->end) {
+            svg_error(parser, parser->cursor, "unexpected end of file in a tag");
+            return -1;
+        }
+
+        if (*parser->cursor == '>') {
+            parser->cursor++;
+            *empty = false;
+            return 0;
+        }
+
+        if (svg_skip_prefix(parser, "/>")) {
+            *empty = true;
+            return 0;
+        }
+
+        const char *name = svg_scan_name(parser);
+        const size_t name_len = (size_t) (parser->cursor - name);
+        svg_skip_spaces(parser);
+
+        if (name_len == 0 || !svg_skip_prefix(parser, "=")) {
+            svg_error(parser, name, "expected an attribute");
+            return -1;
+        }
+        svg_skip_spaces(parser);
+
+        if (parser->cursor >= parser->end
+            || (*parser->cursor != '"' && *parser->cursor != '\'')) {
+            svg_error(parser, parser->cursor, "expected a quoted attribute value");
+            return -1;
+        }
+
+        const char quote = *parser->cursor++;
+        const char *value = parser->cursor;
+        const char *value_end = memchr(value, quote, (size_t) (parser->end - value));
+        if (value_end == NULL) {
+            svg_error(parser, value, "unterminated attribute value");
+            return -1;
+        }
+        parser->cursor = value_end + 1;
+
+        if (attrs == NULL) {
+            continue;
+        }
+
+        for (size_t i = 0; i < SVG_ATTR_N; ++i) {
+            if (name_len == strlen(attribute_names[i])
+                && memcmp(name, attribute_names[i], name_len) == 0) {
+                attrs[i] = svg_decode(parser, value, value_end, true);
+                if (attrs[i] == NULL) {
+                    return -1;
+                }
+                break;
+            }
+        }
+    }
+}
+
+static SvgEntity *svg_add_entity(SvgParser *parser,
+                                 SvgEntityType type,
+                                 const char *position,
+                                 const char *const attrs[SVG_ATTR_N])
+{
+    SvgEntity *entity = arena_alloc(parser->arena, sizeof(SvgEntity));
+    if (entity == NULL) {
+        return NULL;
+    }
+    memset(entity, 0, sizeof(SvgEntity));
+
+    entity->position = position;
+    memcpy(entity->attrs, attrs, sizeof(entity->attrs));
+
+    for (size_t i = 0; i < SVG_ATTR_N; ++i) {
+        if ((required_attributes[type] & (1u << i)) && attrs[i] == NULL) {
+            char message[64];
+            snprintf(message, sizeof(message), "missing attribute `%s`", attribute_names[i]);
+            svg_entity_error(parser, entity, message);
+            return NULL;
+        }
+    }
+
+    if ((required_attributes[type] & ATTR(STYLE))
+        && svg_color_from_style(attrs[SVG_ATTR_STYLE], entity->color) < 0) {
+        svg_entity_error(parser, entity, "style has no fill:#rrggbb color");
+        return NULL;
+    }
+
+    struct SvgList *list = &parser->entities[type];
+    *list->last = entity;
+    list->last = &entity->next;
+    list->count++;
+
+    return entity;
+}
+
+static int svg_parse_start_tag(SvgParser *parser)
+{
+    const char *position = parser->cursor - 1;
+    const char *name = svg_scan_name(parser);
+    const size_t name_len = (size_t) (parser->cursor - name);
+    if (name_len == 0) {
+        svg_error(parser, position, "expected a tag name");
+        return -1;
+    }
+
+    size_t local_len = 0;
+    const char *local = svg_local_name(name, name_len, &local_len);
+    const bool rect = svg_name_p(local, local_len, "rect");
+    const bool text = svg_name_p(local, local_len, "text");
+
+    const char *attrs[SVG_ATTR_N] = { NULL };
+    bool empty = false;
+    if (svg_parse_attributes(parser, rect || text ? attrs : NULL, &empty) < 0) {
+        return -1;
+    }
+
+    /* The child got a child before any text */
+    if (svg_flush_pending_text(parser) < 0) {
+        return -1;
+    }
+    svg_child_started(parser);
+    if (empty && svg_flush_pending_text(parser) < 0) {
+        return -1;
+    }
+
+    SvgEntityType type = SVG_ENTITY_N;
+    if (rect) {
+        type = svg_rect_type(attrs[SVG_ATTR_ID]);
+    } else if (text && svg_id_prefix_p(attrs[SVG_ATTR_ID], "label")) {
+        type = SVG_ENTITY_LABEL;
+    }
+
+    if (type != SVG_ENTITY_N) {
+        SvgEntity *entity = svg_add_entity(parser, type, position, attrs);
+        if (entity == NULL) {
+            return -1;
+        }
+
+        if ((type == SVG_ENTITY_LABEL || type == SVG_ENTITY_SCRIPT)
+            && !empty && parser->owner == NULL) {
+            parser->owner = entity;
+            parser->owner_type = type;
+            parser->owner_depth = parser->depth + 1;
+        }
+    }
+
+    if (!empty) {
+        parser->depth++;
+    }
+
+    return 0;
+}
+
+static int svg_parse_end_tag(SvgParser *parser)
+{
+    const char *position = parser->cursor - 2;
+
+    if (svg_skip_past(parser, ">", "unterminated end tag") < 0) {
+        return -1;
+    }
+
+    if (parser->depth == 0) {
+        svg_error(parser, position, "end tag without a start tag");
+        return -1;
+    }
+
+    if (svg_flush_pending_text(parser) < 0) {
+        return -1;
+    }
+
+    if (parser->owner != NULL && parser->depth == parser->owner_depth) {
+        parser->owner = NULL;
+    }
+    parser->depth--;
+
+    return 0;
+}
+
+static int svg_parse_text(SvgParser *parser)
+{
+    const char *begin = parser->cursor;
+    const char *end = memchr(begin, '<', (size_t) (parser->end - begin));
+    if (end == NULL) {
+        end = parser->end;
+    }
+    parser->cursor = end;
+
+    if (parser->text_pending) {
+        parser->text_pending = false;
+        return svg_owner_text(parser, begin, end);
+    }
+
+    return 0;
+}
+
+static int svg_parse(SvgParser *parser)
+{
+    /* UTF-8 byte order mark */
+    svg_skip_prefix(parser, "\xEF\xBB\xBF");
+
+    while (parser->cursor < parser->end) {
+        if (*parser->cursor != '<') {
+            if (svg_parse_text(parser) < 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        const char *position = parser->cursor;
+        if (svg_skip_prefix(parser, "<!--")) {
+            if (svg_skip_past(parser, "-->", "unterminated comment") < 0) {
+                return -1;
+            }
+        } else if (svg_skip_prefix(parser, "<![CDATA[")) {
+            const char *begin = parser->cursor;
+            if (svg_skip_past(parser, "]]>", "unterminated CDATA section") < 0) {
+                return -1;
+            }
+
+            if (parser->text_pending) {
+                parser->text_pending = false;
+                if (svg_owner_raw_text(parser, begin, parser->cursor - strlen("]]>")) < 0) {
+                    return -1;
+                }
+            }
+        } else if (svg_skip_prefix(parser, "<?")) {
+            if (svg_skip_past(parser, "?>", "unterminated processing instruction") < 0) {
+                return -1;
+            }
+        } else if (svg_skip_prefix(parser, "<!")) {
+            /* DOCTYPE, possibly with an internal subset in brackets */
+            int brackets = 0;
+            for (; parser->cursor < parser->end; parser->cursor++) {
+                if (*parser->cursor == '[') {
+                    brackets++;
+                } else if (*parser->cursor == ']') {
+                    brackets--;
+                } else if (*parser->cursor == '>' && brackets <= 0) {
+                    break;
+                }
+            }
+            if (parser->cursor >= parser->end) {
+                svg_error(parser, position, "unterminated declaration");
+                return -1;
+            }
+            parser->cursor++;
+        } else if (svg_skip_prefix(parser, "</")) {
+            if (svg_parse_end_tag(parser) < 0) {
+                return -1;
+            }
+        } else {
+            parser->cursor++;
+            if (svg_parse_start_tag(parser) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    if (parser->depth > 0) {
+        svg_error(parser, parser->end, "unexpected end of file, some of the tags are not closed");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int svg_expect_one(const SvgParser *parser, SvgEntityType type, const char *id)
+{
+    if (parser->entities[type].count != 1) {
+        fprintf(stderr, "%s: expected exactly one rect with id `%s`, found %zu\n",
+                parser->file_name, id, parser->entities[type].count);
+        return -1;
+    }
+    return 0;
+}
+
+static int svg_resolve_goals(SvgParser *parser)
+{
+    for (SvgEntity *goal = parser->entities[SVG_ENTITY_GOAL].first;
+         goal != NULL;
+         goal = goal->next) {
+        const char *goal_id = goal->attrs[SVG_ATTR_ID] + strlen("goal");
+
+        for (const SvgEntity *region = parser->entities[SVG_ENTITY_REGION].first;
+             region != NULL;
+             region = region->next) {
+            if (strcmp(region->attrs[SVG_ATTR_ID] + strlen("region"), goal_id) != 0) {
+                continue;
+            }
+
+            if (goal->region != NULL) {
+                svg_entity_error(parser, region, "more than one region for the goal");
+                return -1;
+            }
+            goal->region = region;
+        }
+
+        if (goal->region == NULL) {
+            svg_entity_error(parser, goal, "no region for the goal");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static char *read_whole_file(Lt *lt, const char *file_name, size_t *size)
+{
+    FILE *file = PUSH_LT(lt, fopen(file_name, "rb"), fclose_lt);
+    if (file == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return NULL;
+    }
+
+    if (fseek(file, 0, SEEK_END) < 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        return NULL;
+    }
+
+    const long int file_size = ftell(file);
+    if (file_size < 0 || fseek(file, 0, SEEK_SET) < 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        return NULL;
+    }
+
+    char *data = PUSH_LT(lt, malloc((size_t) file_size + 1), free);
+    if (data == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return NULL;
+    }
+
+    if (fread(data, 1, (size_t) file_size, file) != (size_t) file_size) {
+        throw_error(ERROR_TYPE_LIBC);
+        return NULL;
+    }
+    data[file_size] = '\0';
+
+    *size = (size_t) file_size;
+
+    return data;
+}
+
+static int svg_read_scripts(SvgParser *parser)
+{
+    for (SvgEntity *script = parser->entities[SVG_ENTITY_SCRIPT].first;
+         script != NULL;
+         script = script->next) {
+        if (script->text == NULL) {
+            svg_entity_error(parser, script, "no title with the file name of the script");
+            return -1;
+        }
+
+        char *source = read_whole_file(parser->lt, script->text, &script->source_size);
+        if (source == NULL) {
+            print_current_error_msg(script->text);
+            return -1;
+        }
+        script->source = source;
+    }
+
+    return 0;
+}
+
+static void write_rect(FILE *output, const SvgEntity *entity)
+{
+    fprintf(output, "%s %s %s %s",
+            entity->attrs[SVG_ATTR_X],
+            entity->attrs[SVG_ATTR_Y],
+            entity->attrs[SVG_ATTR_WIDTH],
+            entity->attrs[SVG_ATTR_HEIGHT]);
+}
+
+static void write_colored_rects(FILE *output, const struct SvgList *list)
+{
+    fprintf(output, "%zu\n", list->count);
+    for (const SvgEntity *entity = list->first; entity != NULL; entity = entity->next) {
+        write_rect(output, entity);
+        fprintf(output, " %s\n", entity->color);
+    }
+}
+
+/* The amount of lines of the script followed by the lines with any
+ * of the line endings turned into \n */
+static void write_script_source(FILE *output, const SvgEntity *script)
+{
+    const char *source = script->source;
+    const size_t size = script->source_size;
+
+    size_t lines = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (source[i] == '\n' || (source[i] == '\r' && (i + 1 >= size || source[i + 1] != '\n'))) {
+            lines++;
+        }
+    }
+    if (size > 0 && source[size - 1] != '\n' && source[size - 1] != '\r') {
+        lines++;
+    }
+
+    fprintf(output, "%zu\n", lines);
+
+    for (size_t i = 0; i < size; ++i) {
+        if (source[i] == '\r') {
+            if (i + 1 >= size || source[i + 1] != '\n') {
+                fputc('\n', output);
+            }
+            continue;
+        }
+        fputc(source[i], output);
+    }
+    if (size > 0 && source[size - 1] != '\n' && source[size - 1] != '\r') {
+        fputc('\n', output);
+    }
+}
+
+/* Sections go in the order the level loader reads them */
+static void write_level(const SvgParser *parser, FILE *output)
+{
+    const SvgEntity *background = parser->entities[SVG_ENTITY_BACKGROUND].first;
+    fprintf(output, "%s\n", background->color);
+
+    const SvgEntity *player = parser->entities[SVG_ENTITY_PLAYER].first;
+    fprintf(output, "%s %s %s\n",
+            player->attrs[SVG_ATTR_X],
+            player->attrs[SVG_ATTR_Y],
+            player->color);
+
+    write_colored_rects(output, &parser->entities[SVG_ENTITY_PLATFORM]);
+
+    fprintf(output, "%zu\n", parser->entities[SVG_ENTITY_GOAL].count);
+    for (const SvgEntity *goal = parser->entities[SVG_ENTITY_GOAL].first;
+         goal != NULL;
+         goal = goal->next) {
+        fprintf(output, "%s %s %s ",
+                goal->attrs[SVG_ATTR_ID],
+                goal->attrs[SVG_ATTR_X],
+                goal->attrs[SVG_ATTR_Y]);
+        write_rect(output, goal->region);
+        fprintf(output, " %s\n", goal->color);
+    }
+
+    write_colored_rects(output, &parser->entities[SVG_ENTITY_LAVA]);
+    write_colored_rects(output, &parser->entities[SVG_ENTITY_BACK_PLATFORM]);
+
+    fprintf(output, "%zu\n", parser->entities[SVG_ENTITY_BOX].count);
+    for (const SvgEntity *box = parser->entities[SVG_ENTITY_BOX].first;
+         box != NULL;
+         box = box->next) {
+        fprintf(output, "%s ", box->attrs[SVG_ATTR_ID]);
+        write_rect(output, box);
+        fprintf(output, " %s\n", box->color);
+    }
+
+    fprintf(output, "%zu\n", parser->entities[SVG_ENTITY_LABEL].count);
+    for (const SvgEntity *label = parser->entities[SVG_ENTITY_LABEL].first;
+         label != NULL;
+         label = label->next) {
+        /* TODO(#432): svg2level doesn't handle newlines in labels */
+        fprintf(output, "%s %s %s\n%s\n",
+                label->attrs[SVG_ATTR_X],
+                label->attrs[SVG_ATTR_Y],
+                label->color,
+                label->text != NULL ? label->text : "");
+    }
+
+    fprintf(output, "%zu\n", parser->entities[SVG_ENTITY_SCRIPT].count);
+    for (const SvgEntity *script = parser->entities[SVG_ENTITY_SCRIPT].first;
+         script != NULL;
+         script = script->next) {
+        write_rect(output, script);
+        fprintf(output, "\n");
+        write_script_source(output, script);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        print_usage(stderr);
+        return -1;
+    }
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return -1;
+    }
+
+    SvgParser *parser = PUSH_LT(lt, calloc(1, sizeof(SvgParser)), free);
+    if (parser == NULL) {
+        print_current_error_msg("Could not allocate the parser");
+        RETURN_LT(lt, -1);
+    }
+    parser->lt = lt;
+    parser->file_name = argv[1];
+
+    for (size_t i = 0; i < SVG_ENTITY_N; ++i) {
+        parser->entities[i].last = &parser->entities[i].first;
+    }
+
+    parser->arena = PUSH_LT(lt, create_arena(SVG_ARENA_CHUNK_SIZE), destroy_arena);
+    if (parser->arena == NULL) {
+        print_current_error_msg("Could not allocate the arena");
+        RETURN_LT(lt, -1);
+    }
+
+    size_t size = 0;
+    parser->source = read_whole_file(lt, argv[1], &size);
+    if (parser->source == NULL) {
+        print_current_error_msg(argv[1]);
+        RETURN_LT(lt, -1);
+    }
+    parser->cursor = parser->source;
+    parser->end = parser->source + size;
+
+    if (svg_parse(parser) < 0
+        || svg_expect_one(parser, SVG_ENTITY_BACKGROUND, "background") < 0
+        || svg_expect_one(parser, SVG_ENTITY_PLAYER, "player") < 0
+        || svg_resolve_goals(parser) < 0
+        || svg_read_scripts(parser) < 0) {
+        RETURN_LT(lt, -1);
+    }
+
+    /* The level is written only when the whole SVG made sense, so a
+     * broken save in the middle of editing does not clobber it */
+    FILE *output = PUSH_LT(lt, fopen(argv[2], "w"), fclose_lt);
+    if (output == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        print_current_error_msg(argv[2]);
+        RETURN_LT(lt, -1);
+    }
+
+    write_level(parser, output);
+
+    if (ferror(output) != 0 || fflush(output) != 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        print_current_error_msg(argv[2]);
+        RETURN_LT(lt, -1);
+    }
+
+    RETURN_LT(lt, 0);
+}
@@ -0,0 +1,123 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "system/error.h"
+
+#define ARENA_ALIGNMENT _Alignof(max_align_t)
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+typedef struct Arena_chunk Arena_chunk;
+
+struct Arena_chunk
+{
+    Arena_chunk *next;
+    size_t capacity;
+    size_t size;
+};
+
+struct Arena
+{
+    /* The chunk being filled, the full ones follow it */
+    Arena_chunk *chunks;
+    size_t chunk_size;
+};
+
+static Arena_chunk *create_arena_chunk(size_t capacity, Arena_chunk *next)
+{
+    Arena_chunk *chunk = malloc(ARENA_ALIGN(sizeof(Arena_chunk)) + capacity);
+    if (chunk == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return NULL;
+    }
+
+    chunk->next = next;
+    chunk->capacity = capacity;
+    chunk->size = 0;
+
+    return chunk;
+}
+
+static char *arena_chunk_data(Arena_chunk *chunk)
+{
+    return (char*) chunk + ARENA_ALIGN(sizeof(Arena_chunk));
+}
+
+Arena *create_arena(size_t chunk_size)
+{
+    Arena *arena = malloc(sizeof(Arena));
+    if (arena == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        return NULL;
+    }
+
+    arena->chunk_size = ARENA_ALIGN(chunk_size);
+    arena->chunks = create_arena_chunk(arena->chunk_size, NULL);
+    if (arena->chunks == NULL) {
+        free(arena);
+        return NULL;
+    }
+
+    return arena;
+}
+
+void destroy_arena(Arena *arena)
+{
+    assert(arena);
+
+    while (arena->chunks != NULL) {
+        Arena_chunk *next = arena->chunks->next;
+        free(arena->chunks);
+        arena->chunks = next;
+    }
+
+    free(arena);
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+    assert(arena);
+
+    size = ARENA_ALIGN(size);
+
+    Arena_chunk *chunk = arena->chunks;
+    if (chunk->capacity - chunk->size < size) {
+        if (size > arena->chunk_size) {
+            /* Keep filling the current chunk after this one */
+            chunk = create_arena_chunk(size, chunk->next);
+            if (chunk == NULL) {
+                return NULL;
+            }
+            arena->chunks->next = chunk;
+        } else {
+            chunk = create_arena_chunk(arena->chunk_size, chunk);
+            if (chunk == NULL) {
+                return NULL;
+            }
+            arena->chunks = chunk;
+        }
+    }
+
+    void *result = arena_chunk_data(chunk) + chunk->size;
+    chunk->size += size;
+
+    return result;
+}
+
+char *arena_string_duplicate(Arena *arena, const char *str)
+{
+    assert(arena);
+    assert(str);
+
+    const size_t n = strlen(str) + 1;
+    char *result = arena_alloc(arena, n);
+    if (result == NULL) {
+        return NULL;
+    }
+
+    memcpy(result, str, n);
+
+    return result;
+}
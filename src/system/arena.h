@@ -0,0 +1,21 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stdlib.h>
+
+// Arena hands out memory from a few big chunks and frees all of it at
+// once. Nothing allocated from an arena is freed individually, so the
+// objects living in it have no destroy functions of their own.
+
+typedef struct Arena Arena;
+
+// chunk_size is the size of a regular chunk. Bigger allocations get a
+// chunk of their own.
+Arena *create_arena(size_t chunk_size);
+void destroy_arena(Arena *arena);
+
+// Memory is aligned for any type. Never returns NULL for size 0.
+void *arena_alloc(Arena *arena, size_t size);
+char *arena_string_duplicate(Arena *arena, const char *str);
+
+#endif  // ARENA_H_
@@ -0,0 +1,25 @@
+#include <SDL2/SDL.h>
+
+#include "clock.h"
+
+static int64_t clock_now(Uint64 units_per_second)
+{
+    const Uint64 counter = SDL_GetPerformanceCounter();
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    /* counter * units_per_second overflows after a few seconds of
+     * uptime on a nanosecond counter, so the whole seconds and the
+     * remainder are scaled separately */
+    return (int64_t) ((counter / frequency) * units_per_second
+                      + (counter % frequency) * units_per_second / frequency);
+}
+
+int64_t clock_now_us(void)
+{
+    return clock_now(1000000);
+}
+
+int64_t clock_now_ns(void)
+{
+    return clock_now(1000000000);
+}
@@ -0,0 +1,12 @@
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <stdint.h>
+
+// Monotonic time since an unspecified point, for measuring how long
+// something took. Not affected by changes of the wall clock.
+
+int64_t clock_now_us(void);
+int64_t clock_now_ns(void);
+
+#endif  // CLOCK_H_
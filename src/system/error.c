@@ -7,7 +7,15 @@
 
 #include "error.h"
 
-static Error_type current_error_type = ERROR_TYPE_OK;
+/* MSVC does not support C11 _Thread_local */
+#ifdef _MSC_VER
+#define ERROR_THREAD_LOCAL __declspec(thread)
+#else
+#define ERROR_THREAD_LOCAL _Thread_local
+#endif
+
+/* Every thread has its own error, the same way it has its own errno */
+static ERROR_THREAD_LOCAL Error_type current_error_type = ERROR_TYPE_OK;
 
 Error_type current_error(void)
 {
@@ -0,0 +1,170 @@
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <sys/stat.h>
+#include <time.h>
+#endif
+
+#include "error.h"
+#include "file_watcher.h"
+#include "lt.h"
+#include "str.h"
+
+#ifdef __linux__
+#define FILE_WATCHER_BUFFER_SIZE 4096
+#endif
+
+struct FileWatcher
+{
+    Lt *lt;
+    char *file_name;
+#ifdef __linux__
+    int fd;
+    /* Points into file_name */
+    const char *base_name;
+#else
+    time_t modified;
+#endif
+};
+
+#ifdef __linux__
+static void close_fd_lt(void *fd)
+{
+    close(*(int*) fd);
+}
+#else
+static int file_watcher_modified(const char *file_name, time_t *modified)
+{
+    struct stat file_stat;
+    if (stat(file_name, &file_stat) < 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        return -1;
+    }
+
+    *modified = file_stat.st_mtime;
+
+    return 0;
+}
+#endif
+
+FileWatcher *create_file_watcher(const char *file_name)
+{
+    assert(file_name);
+
+    Lt *lt = create_lt();
+    if (lt == NULL) {
+        return NULL;
+    }
+
+    FileWatcher *file_watcher = PUSH_LT(lt, malloc(sizeof(FileWatcher)), free);
+    if (file_watcher == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+    file_watcher->lt = lt;
+
+    file_watcher->file_name = PUSH_LT(lt, string_duplicate(file_name, NULL), free);
+    if (file_watcher->file_name == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+
+#ifdef __linux__
+    file_watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (file_watcher->fd < 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+    PUSH_LT(lt, &file_watcher->fd, close_fd_lt);
+
+    char *slash = strrchr(file_watcher->file_name, '/');
+    char *dir_name = slash == NULL
+        ? string_duplicate(".", NULL)
+        : string_duplicate(file_watcher->file_name, slash == file_watcher->file_name ? slash + 1 : slash);
+    if (dir_name == NULL) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+    file_watcher->base_name = slash == NULL ? file_watcher->file_name : slash + 1;
+
+    /* Watching the directory instead of the file survives the file
+     * being replaced */
+    const int wd = inotify_add_watch(
+        file_watcher->fd,
+        dir_name,
+        IN_CLOSE_WRITE | IN_MOVED_TO);
+    free(dir_name);
+    if (wd < 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+#else
+    if (file_watcher_modified(file_name, &file_watcher->modified) < 0) {
+        RETURN_LT(lt, NULL);
+    }
+#endif
+
+    return file_watcher;
+}
+
+void destroy_file_watcher(FileWatcher *file_watcher)
+{
+    assert(file_watcher);
+    RETURN_LT0(file_watcher->lt);
+}
+
+int file_watcher_changed(FileWatcher *file_watcher)
+{
+    assert(file_watcher);
+
+#ifdef __linux__
+    _Alignas(struct inotify_event) char buffer[FILE_WATCHER_BUFFER_SIZE];
+    int changed = 0;
+
+    /* Several events per frame are squashed into a single change */
+    for (;;) {
+        const ssize_t n = read(file_watcher->fd, buffer, sizeof(buffer));
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+
+            throw_error(ERROR_TYPE_LIBC);
+            return -1;
+        }
+
+        for (ssize_t i = 0; i < n;) {
+            const struct inotify_event *event = (const void *) (buffer + i);
+
+            if (event->len > 0 && strcmp(event->name, file_watcher->base_name) == 0) {
+                changed = 1;
+            }
+
+            i += (ssize_t) (sizeof(struct inotify_event) + event->len);
+        }
+    }
+
+    return changed;
+#else
+    time_t modified = 0;
+    if (file_watcher_modified(file_watcher->file_name, &modified) < 0) {
+        return -1;
+    }
+
+    if (modified == file_watcher->modified) {
+        return 0;
+    }
+
+    file_watcher->modified = modified;
+
+    return 1;
+#endif
+}
@@ -0,0 +1,18 @@
+#ifndef FILE_WATCHER_H_
+#define FILE_WATCHER_H_
+
+// FileWatcher notices modifications of a single file. On Linux it
+// uses inotify on the directory of the file, so the editors that save
+// by renaming a temporary file over the original one are noticed as
+// well. Elsewhere it falls back to polling the modification time.
+
+typedef struct FileWatcher FileWatcher;
+
+FileWatcher *create_file_watcher(const char *file_name);
+void destroy_file_watcher(FileWatcher *file_watcher);
+
+// Never blocks. Returns 1 if the file was modified since the previous
+// call, 0 if it was not and -1 on error.
+int file_watcher_changed(FileWatcher *file_watcher);
+
+#endif  // FILE_WATCHER_H_
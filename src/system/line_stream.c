@@ -1,26 +1,84 @@
 #include <assert.h>
+#include <errno.h>
+#include <float.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "error.h"
 #include "line_stream.h"
 #include "lt.h"
-#include "lt/lt_adapters.h"
+#include "str.h"
+
+/* Digits beyond that do not fit into the uint64_t mantissa and are
+ * way past the precision of float anyway */
+#define MAX_MANTISSA_DIGITS 19
+#define MAX_EXPONENT 400
 
 struct LineStream
 {
     Lt *lt;
-    FILE *stream;
+    char *filename;
+
+    char *text;
+    const char *cursor;
+    const char *end;
+
+    size_t line;
+    const char *line_begin;
+
     char *buffer;
     size_t capacity;
 };
 
+static int read_whole_file(LineStream *line_stream, const char *filename, const char *mode)
+{
+    FILE *stream = fopen(filename, mode);
+    if (stream == NULL) {
+        return -1;
+    }
+
+    if (fseek(stream, 0, SEEK_END) < 0) {
+        fclose(stream);
+        return -1;
+    }
+
+    const long size = ftell(stream);
+    if (size < 0 || fseek(stream, 0, SEEK_SET) < 0) {
+        fclose(stream);
+        return -1;
+    }
+
+    line_stream->text = PUSH_LT(line_stream->lt, malloc((size_t) size + 1), free);
+    if (line_stream->text == NULL) {
+        fclose(stream);
+        return -1;
+    }
+
+    /* The text mode may shrink the file on reading */
+    const size_t n = fread(line_stream->text, 1, (size_t) size, stream);
+    if (ferror(stream)) {
+        fclose(stream);
+        return -1;
+    }
+    fclose(stream);
+
+    line_stream->text[n] = '\0';
+    line_stream->cursor = line_stream->text;
+    line_stream->end = line_stream->text + n;
+
+    return 0;
+}
+
 LineStream *create_line_stream(const char *filename,
                                const char *mode,
                                size_t capacity)
 {
     assert(filename);
     assert(mode);
+    assert(capacity > 0);
 
     Lt *lt = create_lt();
     if (lt == NULL) {
@@ -37,15 +95,23 @@ LineStream *create_line_stream(const char *filename,
     }
     line_stream->lt = lt;
 
-    line_stream->stream = PUSH_LT(
+    line_stream->filename = PUSH_LT(
         lt,
-        fopen(filename, mode),
-        fclose_lt);
-    if (line_stream->stream == NULL) {
+        string_duplicate(filename, NULL),
+        free);
+    if (line_stream->filename == NULL) {
         throw_error(ERROR_TYPE_LIBC);
         RETURN_LT(lt, NULL);
     }
 
+    if (read_whole_file(line_stream, filename, mode) < 0) {
+        throw_error(ERROR_TYPE_LIBC);
+        RETURN_LT(lt, NULL);
+    }
+
+    line_stream->line = 1;
+    line_stream->line_begin = line_stream->text;
+
     line_stream->buffer = PUSH_LT(
         lt,
         malloc(sizeof(char) * capacity),
@@ -67,10 +133,439 @@ void destroy_line_stream(LineStream *line_stream)
     RETURN_LT0(line_stream->lt);
 }
 
+static int line_stream_error(LineStream *line_stream, const char *where, const char *message)
+{
+    fprintf(stderr, "%s:%lu:%lu: %s\n",
+            line_stream->filename,
+            (unsigned long) line_stream->line,
+            (unsigned long) (where - line_stream->line_begin + 1),
+            message);
+    errno = EINVAL;
+    throw_error(ERROR_TYPE_LIBC);
+    return -1;
+}
+
+static void line_stream_new_line(LineStream *line_stream)
+{
+    line_stream->line++;
+    line_stream->line_begin = line_stream->cursor;
+}
+
 const char *line_stream_next(LineStream *line_stream)
 {
     assert(line_stream);
-    return fgets(line_stream->buffer,
-                 (int) line_stream->capacity,
-                 line_stream->stream);
+
+    if (line_stream->cursor >= line_stream->end) {
+        return NULL;
+    }
+
+    const char *begin = line_stream->cursor;
+    const char *newline = memchr(begin, '\n', (size_t) (line_stream->end - begin));
+    const char *line_end = newline != NULL ? newline + 1 : line_stream->end;
+
+    size_t n = (size_t) (line_end - begin);
+    if (n > line_stream->capacity - 1) {
+        n = line_stream->capacity - 1;
+    }
+
+    memcpy(line_stream->buffer, begin, n);
+    line_stream->buffer[n] = '\0';
+    line_stream->cursor = begin + n;
+
+    if (line_stream->cursor == line_end && newline != NULL) {
+        line_stream_new_line(line_stream);
+    }
+
+    return line_stream->buffer;
+}
+
+int line_stream_skip_lines(LineStream *line_stream, size_t n)
+{
+    assert(line_stream);
+
+    for (size_t i = 0; i < n; ++i) {
+        if (line_stream->cursor >= line_stream->end) {
+            return line_stream_error(line_stream, line_stream->cursor, "unexpected end of file");
+        }
+
+        const char *newline = memchr(
+            line_stream->cursor,
+            '\n',
+            (size_t) (line_stream->end - line_stream->cursor));
+        if (newline == NULL) {
+            line_stream->cursor = line_stream->end;
+        } else {
+            line_stream->cursor = newline + 1;
+            line_stream_new_line(line_stream);
+        }
+    }
+
+    return 0;
+}
+
+static bool is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool is_token_end(const LineStream *line_stream, const char *p)
+{
+    return p >= line_stream->end || is_blank(*p) || *p == '\n';
+}
+
+static bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/* Returns the beginning of the next token of the current line or NULL
+ * if the line is over */
+static const char *line_stream_token(LineStream *line_stream)
+{
+    while (line_stream->cursor < line_stream->end && is_blank(*line_stream->cursor)) {
+        line_stream->cursor++;
+    }
+
+    if (line_stream->cursor >= line_stream->end || *line_stream->cursor == '\n') {
+        return NULL;
+    }
+
+    return line_stream->cursor;
+}
+
+int line_stream_read_size(LineStream *line_stream, size_t *result)
+{
+    assert(line_stream);
+    assert(result);
+
+    const char *begin = line_stream_token(line_stream);
+    if (begin == NULL) {
+        return line_stream_error(line_stream, line_stream->cursor, "expected a number");
+    }
+
+    const char *p = begin;
+    size_t value = 0;
+
+    while (p < line_stream->end && is_digit(*p)) {
+        const size_t digit = (size_t) (*p - '0');
+        if (value > (SIZE_MAX - digit) / 10) {
+            return line_stream_error(line_stream, begin, "number is too big");
+        }
+        value = value * 10 + digit;
+        p++;
+    }
+
+    if (p == begin || !is_token_end(line_stream, p)) {
+        return line_stream_error(line_stream, begin, "expected a number");
+    }
+
+    line_stream->cursor = p;
+    *result = value;
+
+    return 0;
+}
+
+int line_stream_read_count(LineStream *line_stream, size_t *result)
+{
+    assert(line_stream);
+    assert(result);
+
+    const char *begin = line_stream_token(line_stream);
+    if (line_stream_read_size(line_stream, result) < 0) {
+        return -1;
+    }
+
+    /* Every record takes at least a byte of the file, which keeps a
+     * corrupted count from turning into a huge or overflowing
+     * allocation */
+    if (*result > (size_t) (line_stream->end - line_stream->cursor)) {
+        return line_stream_error(line_stream, begin, "the rest of the file is too short for that many records");
+    }
+
+    return 0;
+}
+
+static const double powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define POWERS_OF_TEN_COUNT (sizeof(powers_of_ten) / sizeof(powers_of_ten[0]))
+
+static double scale_by_power_of_ten(double value, long exponent)
+{
+    const bool negative = exponent < 0;
+    unsigned long n = (unsigned long) (negative ? -exponent : exponent);
+
+    while (n > 0 && value != 0.0) {
+        const unsigned long step = n < POWERS_OF_TEN_COUNT ? n : POWERS_OF_TEN_COUNT - 1;
+        value = negative ? value / powers_of_ten[step] : value * powers_of_ten[step];
+        n -= step;
+    }
+
+    return value;
+}
+
+int line_stream_read_float(LineStream *line_stream, float *result)
+{
+    assert(line_stream);
+    assert(result);
+
+    const char *begin = line_stream_token(line_stream);
+    if (begin == NULL) {
+        return line_stream_error(line_stream, line_stream->cursor, "expected a number");
+    }
+
+    const char *p = begin;
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    size_t mantissa_digits = 0;
+    size_t digits = 0;
+    long exponent = 0;
+
+    for (; p < line_stream->end && is_digit(*p); ++p, ++digits) {
+        if (mantissa_digits < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+            mantissa_digits += mantissa != 0;
+        } else {
+            exponent++;
+        }
+    }
+
+    if (p < line_stream->end && *p == '.') {
+        for (++p; p < line_stream->end && is_digit(*p); ++p, ++digits) {
+            if (mantissa_digits < MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+                mantissa_digits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+
+    if (digits == 0) {
+        return line_stream_error(line_stream, begin, "expected a number");
+    }
+
+    if (p < line_stream->end && (*p == 'e' || *p == 'E')) {
+        p++;
+
+        bool negative_exponent = false;
+        if (p < line_stream->end && (*p == '-' || *p == '+')) {
+            negative_exponent = *p == '-';
+            p++;
+        }
+
+        if (p >= line_stream->end || !is_digit(*p)) {
+            return line_stream_error(line_stream, begin, "expected an exponent");
+        }
+
+        long explicit_exponent = 0;
+        for (; p < line_stream->end && is_digit(*p); ++p) {
+            if (explicit_exponent < MAX_EXPONENT) {
+                explicit_exponent = explicit_exponent * 10 + (*p - '0');
+            }
+        }
+
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    if (!is_token_end(line_stream, p)) {
+        return line_stream_error(line_stream, begin, "expected a number");
+    }
+
+    const double value = scale_by_power_of_ten((double) mantissa, exponent);
+    if (value > FLT_MAX) {
+        return line_stream_error(line_stream, begin, "number does not fit into a float");
+    }
+
+    line_stream->cursor = p;
+    *result = (float) (negative ? -value : value);
+
+    return 0;
+}
+
+int line_stream_read_point(LineStream *line_stream, Point *result)
+{
+    assert(result);
+
+    if (line_stream_read_float(line_stream, &result->x) < 0
+        || line_stream_read_float(line_stream, &result->y) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int line_stream_read_rect(LineStream *line_stream, Rect *result)
+{
+    assert(result);
+
+    if (line_stream_read_float(line_stream, &result->x) < 0
+        || line_stream_read_float(line_stream, &result->y) < 0
+        || line_stream_read_float(line_stream, &result->w) < 0
+        || line_stream_read_float(line_stream, &result->h) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+
+    if (c >= 'a' && c <= 'f') {
+        return 10 + c - 'a';
+    }
+
+    if (c >= 'A' && c <= 'F') {
+        return 10 + c - 'A';
+    }
+
+    return -1;
+}
+
+int line_stream_read_color(LineStream *line_stream, Color *result)
+{
+    assert(line_stream);
+    assert(result);
+
+    const char *begin = line_stream_token(line_stream);
+    if (begin == NULL) {
+        return line_stream_error(line_stream, line_stream->cursor, "expected a color");
+    }
+
+    Uint8 components[3];
+    const char *p = begin;
+
+    for (size_t i = 0; i < 3; ++i) {
+        const int high = p < line_stream->end ? hex_digit(*p++) : -1;
+        const int low = p < line_stream->end ? hex_digit(*p++) : -1;
+
+        if (high < 0 || low < 0) {
+            return line_stream_error(line_stream, begin, "expected a color in RRGGBB format");
+        }
+
+        components[i] = (Uint8) (high * 16 + low);
+    }
+
+    if (!is_token_end(line_stream, p)) {
+        return line_stream_error(line_stream, begin, "expected a color in RRGGBB format");
+    }
+
+    line_stream->cursor = p;
+    *result = color256(components[0], components[1], components[2], 255);
+
+    return 0;
+}
+
+int line_stream_read_word(LineStream *line_stream, char *word, size_t size)
+{
+    assert(line_stream);
+    assert(word);
+    assert(size > 0);
+
+    const char *begin = line_stream_token(line_stream);
+    if (begin == NULL) {
+        return line_stream_error(line_stream, line_stream->cursor, "expected a word");
+    }
+
+    const char *p = begin;
+    while (!is_token_end(line_stream, p)) {
+        p++;
+    }
+
+    const size_t n = (size_t) (p - begin);
+    if (n >= size) {
+        return line_stream_error(line_stream, begin, "word is too long");
+    }
+
+    memcpy(word, begin, n);
+    word[n] = '\0';
+    line_stream->cursor = p;
+
+    return 0;
+}
+
+int line_stream_end_line(LineStream *line_stream)
+{
+    assert(line_stream);
+
+    const char *garbage = line_stream_token(line_stream);
+    if (garbage != NULL) {
+        return line_stream_error(line_stream, garbage, "unexpected characters at the end of the line");
+    }
+
+    if (line_stream->cursor < line_stream->end) {
+        line_stream->cursor++;
+        line_stream_new_line(line_stream);
+    }
+
+    return 0;
+}
+
+int line_stream_end_file(LineStream *line_stream)
+{
+    assert(line_stream);
+
+    while (line_stream->cursor < line_stream->end) {
+        const char *garbage = line_stream_token(line_stream);
+        if (garbage != NULL) {
+            return line_stream_error(line_stream, garbage, "unexpected characters at the end of the file");
+        }
+
+        if (line_stream_end_line(line_stream) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+LineStreamPosition line_stream_position(const LineStream *line_stream)
+{
+    assert(line_stream);
+
+    const LineStreamPosition position = {
+        .offset = (size_t) (line_stream->cursor - line_stream->text),
+        .line = line_stream->line
+    };
+
+    return position;
+}
+
+void line_stream_seek(LineStream *line_stream, LineStreamPosition position)
+{
+    assert(line_stream);
+    assert(line_stream->text + position.offset <= line_stream->end);
+
+    line_stream->cursor = line_stream->text + position.offset;
+    line_stream->line = position.line;
+
+    line_stream->line_begin = line_stream->cursor;
+    while (line_stream->line_begin > line_stream->text && *(line_stream->line_begin - 1) != '\n') {
+        line_stream->line_begin--;
+    }
+}
+
+/* FNV-1a */
+uint64_t line_stream_hash(const LineStream *line_stream, LineStreamPosition begin)
+{
+    assert(line_stream);
+    assert(line_stream->text + begin.offset <= line_stream->cursor);
+
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (const char *c = line_stream->text + begin.offset; c < line_stream->cursor; ++c) {
+        hash = (hash ^ (uint64_t) (unsigned char) *c) * 1099511628211ULL;
+    }
+
+    return hash;
 }
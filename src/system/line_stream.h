@@ -1,15 +1,61 @@
 #ifndef LINE_STREAM_H_
 #define LINE_STREAM_H_
 
+#include <stdint.h>
 #include <stdlib.h>
 
+#include "color.h"
+#include "math/point.h"
+#include "math/rect.h"
+
+// LineStream reads the whole file into memory once and then hands out
+// either whole lines or tokens of the current line. The token readers
+// do not allocate and do not depend on the locale.
+//
+// All of the readers return -1 on malformed input, printing the error
+// with the line and column to stderr.
+
 typedef struct LineStream LineStream;
 
+typedef struct LineStreamPosition
+{
+    size_t offset;
+    size_t line;
+} LineStreamPosition;
+
 LineStream *create_line_stream(const char *filename,
                                const char *mode,
                                size_t capacity);
 void destroy_line_stream(LineStream *line_stream);
 
+// Returns the rest of the current line including the newline, at most
+// capacity - 1 characters of it, and moves to the next line
 const char *line_stream_next(LineStream *line_stream);
 
+// Moves past n whole lines without copying them anywhere
+int line_stream_skip_lines(LineStream *line_stream, size_t n);
+
+int line_stream_read_size(LineStream *line_stream, size_t *result);
+// Amount of the records that follow. Fails if the rest of the file
+// could not possibly hold that many of them.
+int line_stream_read_count(LineStream *line_stream, size_t *result);
+int line_stream_read_float(LineStream *line_stream, float *result);
+int line_stream_read_point(LineStream *line_stream, Point *result);
+// x y w h
+int line_stream_read_rect(LineStream *line_stream, Rect *result);
+// RRGGBB
+int line_stream_read_color(LineStream *line_stream, Color *result);
+// Copies a whitespace separated word into the buffer, fails if it
+// does not fit
+int line_stream_read_word(LineStream *line_stream, char *word, size_t size);
+// Fails if anything but whitespace is left on the current line
+int line_stream_end_line(LineStream *line_stream);
+// Fails if anything but whitespace is left in the file
+int line_stream_end_file(LineStream *line_stream);
+
+LineStreamPosition line_stream_position(const LineStream *line_stream);
+void line_stream_seek(LineStream *line_stream, LineStreamPosition position);
+// Hash of the text between the position and the current one
+uint64_t line_stream_hash(const LineStream *line_stream, LineStreamPosition begin);
+
 #endif  // LINE_STREAM_H_
@@ -1,43 +1,155 @@
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "lt.h"
-#include "lt/lt_slot.h"
 #include "system/error.h"
 
-#define INITIAL_FRAME_BUFFER_SIZE 16
+#define INITIAL_FRAME_BUFFER_SIZE 8
+/* Up to this amount of frames a resource is looked up by scanning
+ * the frames. Past it the LT builds an index. */
+#define LT_INDEX_THRESHOLD 16
+#define LT_NOT_FOUND ((size_t) -1)
+
+typedef struct Lt_slot
+{
+    /* NULL if the frame was released */
+    void *resource;
+    Lt_destroy resource_destroy;
+} Lt_slot;
 
 struct Lt
 {
-    Lt_slot **frames;
+    Lt_slot *frames;
     size_t capacity;
     size_t size;
+
+    /* Open addressing table from resources to their frames. Has
+     * LT_NOT_FOUND in the empty buckets. NULL until the LT grows
+     * past LT_INDEX_THRESHOLD frames. */
+    size_t *index;
+    size_t index_capacity;
+
+    Lt_slot initial_frames[INITIAL_FRAME_BUFFER_SIZE];
 };
 
-Lt *create_lt()
+static size_t lt_index_bucket(const Lt *lt, const void *resource)
 {
-    Lt *lt = malloc(sizeof(Lt));
-    if(lt == NULL) {
+    /* Fibonacci hashing of the address, the low bits are mostly
+     * zeros because of the alignment */
+    const uint64_t h = (uint64_t) (uintptr_t) resource * 11400714819323198485ULL;
+    return (size_t) (h >> 32) & (lt->index_capacity - 1);
+}
+
+static void lt_index_insert(Lt *lt, Lt_frame frame)
+{
+    const void *resource = lt->frames[frame].resource;
+    size_t i = lt_index_bucket(lt, resource);
+
+    while (lt->index[i] != LT_NOT_FOUND) {
+        /* The first frame of a resource pushed twice wins, just like
+         * with the linear scan */
+        if (lt->frames[lt->index[i]].resource == resource) {
+            return;
+        }
+        i = (i + 1) & (lt->index_capacity - 1);
+    }
+
+    lt->index[i] = frame;
+}
+
+static void lt_index_remove(Lt *lt, Lt_frame frame)
+{
+    if (lt->index == NULL) {
+        return;
+    }
+
+    const size_t mask = lt->index_capacity - 1;
+    size_t i = lt_index_bucket(lt, lt->frames[frame].resource);
+
+    while (lt->index[i] != frame) {
+        if (lt->index[i] == LT_NOT_FOUND) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    /* Backward shift deletion keeps the probe sequences unbroken
+     * without tombstones */
+    for (size_t j = (i + 1) & mask; lt->index[j] != LT_NOT_FOUND; j = (j + 1) & mask) {
+        const size_t home = lt_index_bucket(lt, lt->frames[lt->index[j]].resource);
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            lt->index[i] = lt->index[j];
+            i = j;
+        }
+    }
+
+    lt->index[i] = LT_NOT_FOUND;
+}
+
+static int lt_index_rebuild(Lt *lt, size_t index_capacity)
+{
+    size_t *index = malloc(sizeof(size_t) * index_capacity);
+    if (index == NULL) {
         throw_error(ERROR_TYPE_LIBC);
-        goto malloc_lt_fail;
+        return -1;
+    }
+
+    free(lt->index);
+    lt->index = index;
+    lt->index_capacity = index_capacity;
+    memset(lt->index, 0xff, sizeof(size_t) * index_capacity);
+
+    for (Lt_frame frame = 0; frame < lt->size; ++frame) {
+        if (lt->frames[frame].resource != NULL) {
+            lt_index_insert(lt, frame);
+        }
     }
 
-    lt->frames = malloc(sizeof(Lt_slot*) * INITIAL_FRAME_BUFFER_SIZE);
-    if (lt->frames == NULL) {
+    return 0;
+}
+
+static size_t lt_find_frame(const Lt *lt, void *resource)
+{
+    if (lt->index != NULL) {
+        const size_t mask = lt->index_capacity - 1;
+        for (size_t i = lt_index_bucket(lt, resource);
+             lt->index[i] != LT_NOT_FOUND;
+             i = (i + 1) & mask) {
+            if (lt->frames[lt->index[i]].resource == resource) {
+                return lt->index[i];
+            }
+        }
+    }
+
+    /* Also finds the second frame of a resource pushed twice after
+     * the first one was released */
+    for (Lt_frame frame = 0; frame < lt->size; ++frame) {
+        if (lt->frames[frame].resource == resource) {
+            return frame;
+        }
+    }
+
+    return LT_NOT_FOUND;
+}
+
+Lt *create_lt()
+{
+    Lt *lt = malloc(sizeof(Lt));
+    if(lt == NULL) {
         throw_error(ERROR_TYPE_LIBC);
-        goto malloc_lt_slots_fail;
+        return NULL;
     }
 
+    lt->frames = lt->initial_frames;
     lt->capacity = INITIAL_FRAME_BUFFER_SIZE;
     lt->size = 0;
+    lt->index = NULL;
+    lt->index_capacity = 0;
 
     return lt;
-
-malloc_lt_slots_fail:
-    free(lt);
-malloc_lt_fail:
-    return NULL;
 }
 
 void destroy_lt(Lt *lt)
@@ -45,16 +157,19 @@ void destroy_lt(Lt *lt)
     assert(lt);
 
     while (lt->size-- > 0) {
-        if (lt->frames[lt->size]) {
-            destroy_lt_slot(lt->frames[lt->size]);
+        if (lt->frames[lt->size].resource) {
+            lt->frames[lt->size].resource_destroy(lt->frames[lt->size].resource);
         }
     }
 
-    free(lt->frames);
+    if (lt->frames != lt->initial_frames) {
+        free(lt->frames);
+    }
+    free(lt->index);
     free(lt);
 }
 
-void *lt_push(Lt *lt, void *resource, Lt_destroy resource_destroy)
+void *lt_push_frame(Lt *lt, void *resource, Lt_destroy resource_destroy, Lt_frame *frame)
 {
     assert(lt);
     assert(resource_destroy);
@@ -65,17 +180,87 @@ void *lt_push(Lt *lt, void *resource, Lt_destroy resource_destroy)
     }
 
     if (lt->size >= lt->capacity) {
-        lt->capacity *= 2;
-        if ((lt->frames = realloc(lt->frames, sizeof(Lt_slot*) * lt->capacity)) == NULL) {
+        const size_t capacity = lt->capacity * 2;
+        Lt_slot *frames = lt->frames == lt->initial_frames
+            ? malloc(sizeof(Lt_slot) * capacity)
+            : realloc(lt->frames, sizeof(Lt_slot) * capacity);
+        if (frames == NULL) {
             throw_error(ERROR_TYPE_LIBC);
             return NULL;
         }
+
+        if (lt->frames == lt->initial_frames) {
+            memcpy(frames, lt->initial_frames, sizeof(Lt_slot) * lt->size);
+        }
+
+        lt->frames = frames;
+        lt->capacity = capacity;
     }
 
-    if ((lt->frames[lt->size++] = create_lt_slot(resource, resource_destroy)) == NULL) {
-        return NULL;
+    if (lt->index == NULL ? lt->size >= LT_INDEX_THRESHOLD : (lt->size + 1) * 2 > lt->index_capacity) {
+        if (lt_index_rebuild(lt, lt->index == NULL ? LT_INDEX_THRESHOLD * 4 : lt->index_capacity * 2) < 0) {
+            return NULL;
+        }
+    }
+
+    const Lt_frame new_frame = lt->size++;
+    lt->frames[new_frame].resource = resource;
+    lt->frames[new_frame].resource_destroy = resource_destroy;
+
+    if (lt->index != NULL) {
+        lt_index_insert(lt, new_frame);
+    }
+
+    if (frame != NULL) {
+        *frame = new_frame;
+    }
+
+    return resource;
+}
+
+void *lt_push(Lt *lt, void *resource, Lt_destroy resource_destroy)
+{
+    return lt_push_frame(lt, resource, resource_destroy, NULL);
+}
+
+void *lt_replace_frame(Lt *lt, Lt_frame frame, void *new_resource)
+{
+    assert(lt);
+    assert(frame < lt->size);
+    assert(lt->frames[frame].resource);
+    assert(new_resource);
+
+    lt_index_remove(lt, frame);
+    lt->frames[frame].resource = new_resource;
+    if (lt->index != NULL) {
+        lt_index_insert(lt, frame);
     }
 
+    return new_resource;
+}
+
+void *lt_reset_frame(Lt *lt, Lt_frame frame, void *new_resource)
+{
+    assert(lt);
+    assert(frame < lt->size);
+    assert(lt->frames[frame].resource);
+    assert(lt->frames[frame].resource != new_resource);
+
+    lt->frames[frame].resource_destroy(lt->frames[frame].resource);
+
+    return lt_replace_frame(lt, frame, new_resource);
+}
+
+void *lt_release_frame(Lt *lt, Lt_frame frame)
+{
+    assert(lt);
+    assert(frame < lt->size);
+    assert(lt->frames[frame].resource);
+
+    void *resource = lt->frames[frame].resource;
+    lt_index_remove(lt, frame);
+    lt->frames[frame].resource = NULL;
+
     return resource;
 }
 
@@ -86,14 +271,12 @@ void* lt_reset(Lt *lt, void *old_resource, void *new_resource)
     assert(new_resource);
     assert(old_resource != new_resource);
 
-    for (size_t i = 0; i < lt->size; ++i) {
-        if (lt->frames[i] && lt_slot_contains_resource(lt->frames[i], old_resource)) {
-            lt_slot_reset_resource(lt->frames[i], new_resource);
-            return new_resource;
-        }
+    const size_t frame = lt_find_frame(lt, old_resource);
+    if (frame == LT_NOT_FOUND) {
+        return old_resource;
     }
 
-    return old_resource;
+    return lt_reset_frame(lt, frame, new_resource);
 }
 
 void *lt_release(Lt *lt, void *resource)
@@ -101,15 +284,12 @@ void *lt_release(Lt *lt, void *resource)
     assert(lt);
     assert(resource);
 
-    for (size_t i = 0; i < lt->size; ++i) {
-        if (lt->frames[i] && lt_slot_contains_resource(lt->frames[i], resource)) {
-            release_lt_slot(lt->frames[i]);
-            lt->frames[i] = NULL;
-            return resource;
-        }
+    const size_t frame = lt_find_frame(lt, resource);
+    if (frame == LT_NOT_FOUND) {
+        return resource;
     }
 
-    return resource;
+    return lt_release_frame(lt, frame);
 }
 
 void *lt_replace(Lt *lt, void *old_resource, void *new_resource)
@@ -118,12 +298,10 @@ void *lt_replace(Lt *lt, void *old_resource, void *new_resource)
     assert(old_resource);
     assert(new_resource);
 
-    for (size_t i = 0; i < lt->size; ++i) {
-        if (lt->frames[i] && lt_slot_contains_resource(lt->frames[i], old_resource)) {
-            lt_slot_replace_resource(lt->frames[i], new_resource);
-            return new_resource;
-        }
+    const size_t frame = lt_find_frame(lt, old_resource);
+    if (frame == LT_NOT_FOUND) {
+        return old_resource;
     }
 
-    return old_resource;
+    return lt_replace_frame(lt, frame, new_resource);
 }
@@ -1,6 +1,8 @@
 #ifndef LT_H_
 #define LT_H_
 
+#include <stddef.h>
+
 #define PUSH_LT(lt, resource, resource_destroy) \
     lt_push(lt, (void*)resource, (Lt_destroy)resource_destroy)
 
@@ -13,6 +15,18 @@
 #define RELEASE_LT(lt, resource)                \
     lt_release(lt, (void*) resource)
 
+#define PUSH_LT_FRAME(lt, resource, resource_destroy, frame)            \
+    lt_push_frame(lt, (void*)resource, (Lt_destroy)resource_destroy, frame)
+
+#define RESET_LT_FRAME(lt, frame, new_resource) \
+    lt_reset_frame(lt, frame, (void*)new_resource)
+
+#define REPLACE_LT_FRAME(lt, frame, new_resource)       \
+    lt_replace_frame(lt, frame, (void*)new_resource)
+
+#define RELEASE_LT_FRAME(lt, frame)             \
+    lt_release_frame(lt, frame)
+
 #define RETURN_LT(lt, result)               \
     do {                                    \
         destroy_lt(lt);                     \
@@ -28,6 +42,10 @@
 typedef struct Lt Lt;
 typedef void (*Lt_destroy)(void*);
 
+/** \brief Handle of an LT frame. Stays valid until the frame is released or the LT is destroyed.
+ */
+typedef size_t Lt_frame;
+
 Lt *create_lt(void);
 void destroy_lt(Lt *lt);
 
@@ -47,4 +65,14 @@ void *lt_replace(Lt *lt, void *old_resource, void *new_resource);
  */
 void *lt_release(Lt *lt, void *resource);
 
+/** \brief Same as lt_push but also returns the handle of the new LT frame.
+ */
+void *lt_push_frame(Lt *lt, void *resource, Lt_destroy resource_destroy, Lt_frame *frame);
+
+/** \brief Same as lt_reset, lt_replace and lt_release but without looking the frame up.
+ */
+void *lt_reset_frame(Lt *lt, Lt_frame frame, void *new_resource);
+void *lt_replace_frame(Lt *lt, Lt_frame frame, void *new_resource);
+void *lt_release_frame(Lt *lt, Lt_frame frame);
+
 #endif  // LT_H_
@@ -7,6 +7,7 @@
 #include "ebisp/parser.h"
 #include "ebisp/scope.h"
 #include "sdl/renderer.h"
+#include "str.h"
 #include "system/error.h"
 #include "system/lt.h"
 #include "ui/console.h"
@@ -26,13 +27,25 @@
 
 #define SLIDE_DOWN_TIME 0.4f
 
+/* Time the console spends on collecting garbage every frame */
+#define CONSOLE_GC_BUDGET_US 500
+
+/* Limits of a single expression typed into the console */
+#define CONSOLE_MAX_STEPS 1000000
+#define CONSOLE_MAX_ALLOCATIONS 1000000
+#define CONSOLE_MAX_TIME_US 100000
+
+static const struct EvalBudget console_budget = {
+    .max_steps = CONSOLE_MAX_STEPS,
+    .max_allocations = CONSOLE_MAX_ALLOCATIONS,
+    .max_time_us = CONSOLE_MAX_TIME_US
+};
+
 #define CONSOLE_ALPHA (0.80f)
 #define CONSOLE_BACKGROUND (color(0.20f, 0.20f, 0.20f, CONSOLE_ALPHA))
 #define CONSOLE_FOREGROUND (color(0.80f, 0.80f, 0.80f, CONSOLE_ALPHA))
 #define CONSOLE_ERROR (color(0.80f, 0.50f, 0.50f, CONSOLE_ALPHA))
 
-#define CONSOLE_EVAL_RESULT_SIZE 256
-
 struct Console
 {
     Lt *lt;
@@ -43,12 +56,10 @@ struct Console
     Level *level;
     History *history;
     float a;
-    char *eval_result;
 };
 
 /* TODO(#355): Console does not support Emacs keybindings */
 /* TODO(#356): Console does not support autocompletion */
-/* TODO(#357): Console does not show the state of the GC of the script */
 /* TODO(#358): Console does not support copy, cut, paste operations */
 
 static struct EvalResult rect_apply_force(void *param, Gc *gc, struct Scope *scope, struct Expr args)
@@ -60,10 +71,14 @@ static struct EvalResult rect_apply_force(void *param, Gc *gc, struct Scope *sco
     /* TODO(#401): rect_apply_force doesn't sanitize it's input */
 
     Level *level = (Level*) param;
-    const char *rect_id = CAR(args).atom->str;
+    struct Atom *rect_id_atom = CAR(args).atom;
+    char *rect_id = string_duplicate(rect_id_atom->str, rect_id_atom->str + rect_id_atom->len);
+    if (rect_id == NULL) {
+        return eval_failure(CONS(gc, SYMBOL(gc, "out-of-memory"), CAR(args)));
+    }
     struct Expr vector_force_expr = CAR(CDR(args));
-    const float force_x = (float) CAR(vector_force_expr).atom->num;
-    const float force_y = (float) CDR(vector_force_expr).atom->num;
+    const float force_x = (float) number_as_real(CAR(vector_force_expr));
+    const float force_y = (float) number_as_real(CDR(vector_force_expr));
 
     print_expr_as_sexpr(stdout, args); printf("\n");
 
@@ -76,6 +91,8 @@ static struct EvalResult rect_apply_force(void *param, Gc *gc, struct Scope *sco
         fprintf(stderr, "Couldn't find rigid_rect `%s`", rect_id);
     }
 
+    free(rect_id);
+
     return eval_success(NIL(gc));
 }
 
@@ -103,6 +120,9 @@ Console *create_console(Level *level,
     console->scope.expr = CONS(console->gc,
                                NIL(console->gc),
                                NIL(console->gc));
+    if (gc_add_root(console->gc, &console->scope.expr) < 0) {
+        RETURN_LT(lt, NULL);
+    }
     set_scope_value(
         console->gc,
         &console->scope,
@@ -131,15 +151,6 @@ Console *create_console(Level *level,
     console->level = level;
     console->a = 0;
 
-    console->eval_result = PUSH_LT(
-        lt,
-        malloc(sizeof(char) * CONSOLE_EVAL_RESULT_SIZE),
-        free);
-    if (console->eval_result == NULL) {
-        RETURN_LT(lt, NULL);
-    }
-    memset(console->eval_result, 0, sizeof(char) * CONSOLE_EVAL_RESULT_SIZE);
-
     console->history = PUSH_LT(
         lt,
         create_history(HISTORY_CAPACITY),
@@ -184,30 +195,32 @@ static int console_eval_input(Console *console)
             return 0;
         }
 
-        struct EvalResult eval_result = eval(
+        struct EvalResult eval_result = eval_with_budget(
             console->gc,
             &console->scope,
-            parse_result.expr);
+            parse_result.expr,
+            &console_budget,
+            NULL);
 
-        if (expr_as_sexpr(
-                eval_result.expr,
-                console->eval_result,
-                CONSOLE_EVAL_RESULT_SIZE) < 0) {
+        char *eval_result_text = expr_as_sexpr(eval_result.expr);
+        if (eval_result_text == NULL) {
             return -1;
         }
 
         if (log_push_line(console->log,
-                          console->eval_result,
+                          eval_result_text,
                           eval_result.is_error ?
                           CONSOLE_ERROR :
                           CONSOLE_FOREGROUND)) {
+            free(eval_result_text);
             return -1;
         }
 
+        free(eval_result_text);
+
         source_code = next_token(parse_result.end).begin;
     }
 
-    gc_collect(console->gc, console->scope.expr);
     edit_field_clean(console->edit_field);
 
     return 0;
@@ -279,6 +292,11 @@ int console_update(Console *console, float delta_time)
 {
     assert(console);
 
+    if (gc_step(console->gc, CONSOLE_GC_BUDGET_US) < 0) {
+        /* The cycle is restarted on the next frame */
+        log_push_line(console->log, "Not enough memory to finish GC cycle", CONSOLE_ERROR);
+    }
+
     /* TODO(#366): console slide down animation doesn't have any easing */
     if (console->a < 1.0f) {
         console->a += 1.0f / SLIDE_DOWN_TIME * delta_time;
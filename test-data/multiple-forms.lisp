@@ -0,0 +1,4 @@
+; Several top-level forms
+(set x "hello")
+(+ 1 2)
+foo
@@ -0,0 +1,84 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "system/clock.h"
+
+// Every benchmark is run BENCH_RUNS times and reported as a single
+// JSON line on stdout:
+//
+//     {"bench": "name", "runs": 5, "ops": 1000, "bytes": 0,
+//      "min_ns": 123, "median_ns": 130, "ns_per_op": 0.123, "mb_per_s": 0.0}
+//
+// ops and bytes are the amount of work of a single run. Inputs are
+// generated deterministically so the runs are comparable between
+// builds.
+
+#define BENCH_RUNS 5
+
+struct BenchResult
+{
+    size_t ops;
+    size_t bytes;
+    long int ns;
+};
+
+#define BENCH(name)                                     \
+    static int name(struct BenchResult *result)
+
+#define BENCH_RUN(name)                                 \
+    if (bench_run(#name, name) < 0) {                   \
+        return -1;                                      \
+    }
+
+#define BENCH_SUITE(name)                       \
+    static int name(void)
+
+#define BENCH_RUN_SUITE(name)                   \
+    if (name() < 0) {                           \
+        return -1;                              \
+    }
+
+static int bench_compare_ns(const void *a, const void *b)
+{
+    const long int x = *(const long int*) a;
+    const long int y = *(const long int*) b;
+    return (x > y) - (x < y);
+}
+
+static inline int bench_run(const char *name,
+                            int (*bench)(struct BenchResult *result))
+{
+    long int ns[BENCH_RUNS];
+    struct BenchResult result = {0, 0, 0};
+
+    for (size_t i = 0; i < BENCH_RUNS; ++i) {
+        result.ops = 0;
+        result.bytes = 0;
+        result.ns = 0;
+
+        if (bench(&result) < 0) {
+            fprintf(stderr, "%s: benchmark failed\n", name);
+            return -1;
+        }
+
+        ns[i] = result.ns;
+    }
+
+    qsort(ns, BENCH_RUNS, sizeof(long int), bench_compare_ns);
+
+    const double seconds = (double) ns[0] * 1e-9;
+
+    printf("{\"bench\": \"%s\", \"runs\": %d, \"ops\": %zu, \"bytes\": %zu, "
+           "\"min_ns\": %ld, \"median_ns\": %ld, \"ns_per_op\": %.3f, \"mb_per_s\": %.1f}\n",
+           name, BENCH_RUNS, result.ops, result.bytes,
+           ns[0], ns[BENCH_RUNS / 2],
+           result.ops > 0 ? (double) ns[0] / (double) result.ops : 0.0,
+           seconds > 0.0 ? (double) result.bytes / (1024.0 * 1024.0) / seconds : 0.0);
+
+    return 0;
+}
+
+#endif  // BENCH_H_
@@ -0,0 +1,15 @@
+#include "bench.h"
+#include "tokenizer_bench.h"
+#include "parser_bench.h"
+#include "interpreter_bench.h"
+#include "gc_bench.h"
+
+int main(void)
+{
+    BENCH_RUN_SUITE(tokenizer_bench);
+    BENCH_RUN_SUITE(parser_bench);
+    BENCH_RUN_SUITE(interpreter_bench);
+    BENCH_RUN_SUITE(gc_bench);
+
+    return 0;
+}
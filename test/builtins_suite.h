@@ -1,8 +1,14 @@
 #ifndef BUILTINS_SUITE_H_
 #define BUILTINS_SUITE_H_
 
+#include <limits.h>
+
 #include "test.h"
+#include "ebisp/builtins.h"
 #include "ebisp/gc.h"
+#include "ebisp/interpreter.h"
+#include "ebisp/parser.h"
+#include "ebisp/scope.h"
 
 TEST(lambda_p_test)
 {
@@ -31,9 +37,120 @@ TEST(lambda_p_test)
     return 0;
 }
 
+static struct EvalResult eval_arithmetic(Gc *gc, struct Scope *scope, const char *str)
+{
+    struct ParseResult parse_result = read_expr_from_string(gc, str);
+    if (parse_result.is_error) {
+        return eval_failure(SYMBOL(gc, "parse-error"));
+    }
+
+    return eval(gc, scope, parse_result.expr);
+}
+
+TEST(arithmetic_boundaries_test)
+{
+    Gc *gc = create_gc();
+    struct Scope scope = create_scope(gc);
+
+    /* Every operator promotes an overflowing integer to a real, / too */
+    struct EvalResult result = eval_arithmetic(gc, &scope, "(/ -9223372036854775808 -1)");
+    ASSERT_FALSE(result.is_error, "LONG_MIN / -1 failed");
+    ASSERT_INTEQ(EXPR_REAL, result.expr.type);
+    ASSERT_TRUE(result.expr.real > 9.2e18, "LONG_MIN / -1 lost the magnitude");
+
+    /* Only the integer division by zero is an error */
+    result = eval_arithmetic(gc, &scope, "(/ 1 0)");
+    ASSERT_TRUE(result.is_error, "1 / 0 did not fail");
+    ASSERT_TRUE(cons_p(result.expr)
+                && symbol_p(result.expr.cons->car)
+                && atom_text_equal(result.expr.cons->car.atom, "arith-error"),
+                "1 / 0 is not an arith-error");
+
+    result = eval_arithmetic(gc, &scope, "(/ -9223372036854775808 1)");
+    ASSERT_FALSE(result.is_error, "LONG_MIN / 1 failed");
+    ASSERT_LONGINTEQ(LONG_MIN, result.expr.integer);
+
+    result = eval_arithmetic(gc, &scope, "(+ 9223372036854775807 1)");
+    ASSERT_FALSE(result.is_error, "Overflowing + failed");
+    ASSERT_INTEQ(EXPR_REAL, result.expr.type);
+    ASSERT_TRUE(result.expr.real > 9.2e18, "Overflowing + lost the magnitude");
+
+    result = eval_arithmetic(gc, &scope, "(- -9223372036854775808 1)");
+    ASSERT_FALSE(result.is_error, "Overflowing - failed");
+    ASSERT_INTEQ(EXPR_REAL, result.expr.type);
+    ASSERT_TRUE(result.expr.real < -9.2e18, "Overflowing - lost the magnitude");
+
+    result = eval_arithmetic(gc, &scope, "(- -9223372036854775808)");
+    ASSERT_FALSE(result.is_error, "Overflowing negation failed");
+    ASSERT_INTEQ(EXPR_REAL, result.expr.type);
+
+    result = eval_arithmetic(gc, &scope, "(* 4611686018427387904 2 1)");
+    ASSERT_FALSE(result.is_error, "Overflowing * failed");
+    ASSERT_INTEQ(EXPR_REAL, result.expr.type);
+    ASSERT_TRUE(result.expr.real > 9.2e18, "Overflowing * lost the magnitude");
+
+    result = eval_arithmetic(gc, &scope, "(* -9223372036854775808 -1)");
+    ASSERT_FALSE(result.is_error, "Overflowing negative * failed");
+    ASSERT_INTEQ(EXPR_REAL, result.expr.type);
+    ASSERT_TRUE(result.expr.real > 9.2e18, "Overflowing negative * lost the magnitude");
+
+    result = eval_arithmetic(gc, &scope, "(* -4611686018427387904 2)");
+    ASSERT_FALSE(result.is_error, "Multiplication down to LONG_MIN failed");
+    ASSERT_LONGINTEQ(LONG_MIN, result.expr.integer);
+
+    result = eval_arithmetic(gc, &scope, "(* 4611686018427387903 2)");
+    ASSERT_FALSE(result.is_error, "Multiplication failed");
+    ASSERT_LONGINTEQ(9223372036854775806L, result.expr.integer);
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+/* Nested in the cars, so walking the cdrs in a loop does not help */
+static struct Expr nested_cars(Gc *gc, size_t depth, struct Expr leaf)
+{
+    struct Expr expr = leaf;
+
+    for (size_t i = 0; i < depth; ++i) {
+        expr = CONS(gc, expr, NIL(gc));
+    }
+
+    return expr;
+}
+
+TEST(equal_deeply_nested_test)
+{
+    Gc *gc = create_gc();
+
+    const size_t depth = 300000;
+
+    ASSERT_TRUE(equal(nested_cars(gc, depth, NUMBER(gc, 42)),
+                      nested_cars(gc, depth, NUMBER(gc, 42))),
+                "Equal deeply nested lists are not equal");
+    ASSERT_FALSE(equal(nested_cars(gc, depth, NUMBER(gc, 42)),
+                       nested_cars(gc, depth, NUMBER(gc, 43))),
+                 "Deeply nested lists with different leaves are equal");
+    ASSERT_FALSE(equal(nested_cars(gc, depth, NUMBER(gc, 42)),
+                       nested_cars(gc, depth - 1, NUMBER(gc, 42))),
+                 "Lists of different depth are equal");
+    ASSERT_TRUE(equal(list(gc, 3, NUMBER(gc, 1), list(gc, 1, STRING(gc, "a")), REAL(gc, 2.5)),
+                      list(gc, 3, NUMBER(gc, 1), list(gc, 1, STRING(gc, "a")), REAL(gc, 2.5))),
+                "Equal lists are not equal");
+    ASSERT_FALSE(equal(list(gc, 2, NUMBER(gc, 1), NUMBER(gc, 2)),
+                       list(gc, 3, NUMBER(gc, 1), NUMBER(gc, 2), NUMBER(gc, 3))),
+                 "Lists of different length are equal");
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
 TEST_SUITE(builtins_suite)
 {
     TEST_RUN(lambda_p_test);
+    TEST_RUN(arithmetic_boundaries_test);
+    TEST_RUN(equal_deeply_nested_test);
 
     return 0;
 }
@@ -0,0 +1,79 @@
+#ifndef DUMP_SUITE_H_
+#define DUMP_SUITE_H_
+
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "ebisp/builtins.h"
+#include "ebisp/dump.h"
+#include "ebisp/gc.h"
+#include "ebisp/parser.h"
+
+#define DUMP_SUITE_FILE "dump_suite.ebd"
+
+TEST(dump_load_roundtrip_test)
+{
+    Gc *gc = create_gc();
+
+    const char *source_code =
+        "(set f (lambda (x) \"hello\" (+ x 42 -1 3.5)))\n"
+        "(a . b)\n"
+        "nil";
+    const size_t source_size = strlen(source_code);
+
+    struct ParseResult parse_result = read_all_exprs_from_string(gc, source_code);
+    ASSERT_FALSE(parse_result.is_error, "Could not parse the forms");
+
+    FILE *stream = fopen(DUMP_SUITE_FILE, "wb");
+    ASSERT_TRUE(stream != NULL, "Could not open the dump file");
+    ASSERT_INTEQ(0, dump_expr(stream, source_code, source_size, parse_result.expr));
+    fclose(stream);
+
+    struct ParseResult load_result = load_expr_from_file(
+        gc, DUMP_SUITE_FILE, source_code, source_size);
+    ASSERT_FALSE(load_result.is_error, "Could not load the dump");
+    ASSERT_TRUE(equal(parse_result.expr, load_result.expr),
+                "Loaded forms are not equal to the dumped ones");
+
+    /* Same size, one byte off */
+    char stale_source_code[256];
+    ASSERT_TRUE(source_size < sizeof(stale_source_code), "Source is too big");
+    memcpy(stale_source_code, source_code, source_size);
+    stale_source_code[5] = 'g';
+    load_result = load_expr_from_file(gc, DUMP_SUITE_FILE, stale_source_code, source_size);
+    ASSERT_TRUE(load_result.is_error, "Dump with a different key was loaded");
+
+    load_result = load_expr_from_file(gc, DUMP_SUITE_FILE, source_code, source_size - 1);
+    ASSERT_TRUE(load_result.is_error, "Dump with a shorter key was loaded");
+
+    remove(DUMP_SUITE_FILE);
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(dump_rejects_closures_test)
+{
+    Gc *gc = create_gc();
+
+    FILE *stream = fopen(DUMP_SUITE_FILE, "wb");
+    ASSERT_TRUE(stream != NULL, "Could not open the dump file");
+    ASSERT_INTEQ(-1, dump_expr(stream, "", 0, CLOSURE(gc, NIL(gc), NIL(gc), NIL(gc))));
+    fclose(stream);
+
+    remove(DUMP_SUITE_FILE);
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST_SUITE(dump_suite)
+{
+    TEST_RUN(dump_load_roundtrip_test);
+    TEST_RUN(dump_rejects_closures_test);
+
+    return 0;
+}
+
+#endif  // DUMP_SUITE_H_
@@ -0,0 +1,131 @@
+#ifndef EXPR_SUITE_H_
+#define EXPR_SUITE_H_
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "ebisp/builtins.h"
+#include "ebisp/expr.h"
+#include "ebisp/gc.h"
+#include "ebisp/parser.h"
+
+TEST(expr_as_sexpr_test)
+{
+    Gc *gc = create_gc();
+
+    struct Expr expr = list(gc, 4,
+                            SYMBOL(gc, "foo"),
+                            STRING(gc, "bar"),
+                            CONS(gc, NUMBER(gc, 1), NUMBER(gc, 2)),
+                            NIL(gc));
+
+    char *text = expr_as_sexpr(expr);
+    ASSERT_TRUE(text != NULL, "Could not serialize expression");
+    ASSERT_STREQ("(foo \"bar\" (1 . 2) nil)", text);
+    free(text);
+
+    text = expr_as_sexpr(void_expr());
+    ASSERT_TRUE(text != NULL, "Could not serialize void");
+    ASSERT_STREQ("", text);
+    free(text);
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(expr_as_sexpr_long_list_test)
+{
+    Gc *gc = create_gc();
+
+    const size_t n = 10000;
+    struct Expr expr = NIL(gc);
+    for (size_t i = 0; i < n; ++i) {
+        expr = CONS(gc, SYMBOL(gc, "x"), expr);
+    }
+
+    char *text = expr_as_sexpr(expr);
+    ASSERT_TRUE(text != NULL, "Could not serialize expression");
+    ASSERT_TRUE(strlen(text) == 2 * n + 1, "Long list was truncated");
+    free(text);
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(expr_as_sexpr_limits_test)
+{
+    Gc *gc = create_gc();
+
+    struct Expr deep = NIL(gc);
+    for (size_t i = 0; i < EXPR_PRINT_MAX_DEPTH + 10; ++i) {
+        deep = list(gc, 1, deep);
+    }
+
+    char *text = expr_as_sexpr(deep);
+    ASSERT_TRUE(text != NULL, "Could not serialize deep expression");
+    ASSERT_TRUE(strstr(text, "(...)") != NULL, "Depth limit was not applied");
+    free(text);
+
+    struct Expr loop = list(gc, 2, SYMBOL(gc, "a"), SYMBOL(gc, "b"));
+    loop.cons->cdr.cons->cdr = loop;
+
+    text = expr_as_sexpr(loop);
+    ASSERT_TRUE(text != NULL, "Could not serialize circular list");
+    ASSERT_TRUE(strstr(text, "#cycle") != NULL, "Circular list was not detected");
+    free(text);
+
+    struct Expr self = list(gc, 2, SYMBOL(gc, "a"), NIL(gc));
+    self.cons->cdr.cons->car = self;
+
+    text = expr_as_sexpr(self);
+    ASSERT_TRUE(text != NULL, "Could not serialize self referencing list");
+    ASSERT_STREQ("(a #cycle)", text);
+    free(text);
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(expr_as_sexpr_real_round_trip_test)
+{
+    Gc *gc = create_gc();
+
+    const double reals[] = {0.1, 1.0 / 3.0, -2.5, 3.0, 1e-300, 1e300, 123456789012345678.0};
+    const size_t n = sizeof(reals) / sizeof(reals[0]);
+
+    for (size_t i = 0; i < n; ++i) {
+        char *text = expr_as_sexpr(REAL(gc, reals[i]));
+        ASSERT_TRUE(text != NULL, "Could not serialize real");
+
+        struct ParseResult result = read_expr_from_string(gc, text);
+        ASSERT_FALSE(result.is_error, "Could not read the real back");
+        ASSERT_INTEQ(EXPR_REAL, result.expr.type);
+        ASSERT_TRUE(result.expr.real == reals[i], "Real did not survive the round trip");
+        free(text);
+    }
+
+    char *text = expr_as_sexpr(REAL(gc, 3.0));
+    ASSERT_TRUE(text != NULL, "Could not serialize real");
+    ASSERT_STREQ("3.0", text);
+    free(text);
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST_SUITE(expr_suite)
+{
+    TEST_RUN(expr_as_sexpr_test);
+    TEST_RUN(expr_as_sexpr_long_list_test);
+    TEST_RUN(expr_as_sexpr_limits_test);
+    TEST_RUN(expr_as_sexpr_real_round_trip_test);
+
+    return 0;
+}
+
+#endif  // EXPR_SUITE_H_
@@ -0,0 +1,64 @@
+#ifndef GC_BENCH_H_
+#define GC_BENCH_H_
+
+#include "bench.h"
+#include "ebisp/builtins.h"
+#include "ebisp/gc.h"
+
+/* Builds a heap of `live` reachable conses and as many unreachable
+ * ones, then measures a full collection */
+static int gc_collect_bench(struct BenchResult *result, size_t live)
+{
+    Gc *gc = create_gc();
+    if (gc == NULL) {
+        return -1;
+    }
+
+    struct Expr root = NIL(gc);
+    if (gc_add_root(gc, &root) < 0) {
+        destroy_gc(gc);
+        return -1;
+    }
+
+    for (size_t i = 0; i < live; ++i) {
+        root = CONS(gc, NUMBER(gc, (long int) i), root);
+        CONS(gc, NUMBER(gc, (long int) i), NIL(gc));
+    }
+
+    const int64_t begin = clock_now_ns();
+    gc_collect(gc);
+    result->ns = (long int) (clock_now_ns() - begin);
+
+    struct GcStats stats;
+    gc_stats(gc, &stats);
+    result->ops = 2 * live;
+
+    destroy_gc(gc);
+
+    return stats.conses == live ? 0 : -1;
+}
+
+BENCH(gc_collect_1k_bench)
+{
+    return gc_collect_bench(result, 1000);
+}
+
+BENCH(gc_collect_10k_bench)
+{
+    return gc_collect_bench(result, 10000);
+}
+
+BENCH(gc_collect_100k_bench)
+{
+    return gc_collect_bench(result, 100000);
+}
+
+BENCH_SUITE(gc_bench)
+{
+    BENCH_RUN(gc_collect_1k_bench);
+    BENCH_RUN(gc_collect_10k_bench);
+    BENCH_RUN(gc_collect_100k_bench);
+    return 0;
+}
+
+#endif  // GC_BENCH_H_
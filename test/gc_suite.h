@@ -0,0 +1,142 @@
+#ifndef GC_SUITE_H_
+#define GC_SUITE_H_
+
+#include "test.h"
+#include "ebisp/builtins.h"
+#include "ebisp/gc.h"
+#include "ebisp/interpreter.h"
+#include "ebisp/parser.h"
+#include "ebisp/scope.h"
+
+TEST(gc_step_interleaved_with_eval_test)
+{
+    Gc *gc = create_gc();
+    struct Scope scope = create_scope(gc);
+    ASSERT_TRUE(gc_add_root(gc, &scope.expr) == 0, "Could not add the root");
+
+    struct EvalResult result = eval(
+        gc, &scope,
+        read_expr_from_string(
+            gc,
+            "(set count (lambda (n acc)"
+            "             (if (= n 0) acc"
+            "               (count (- n 1) (cons n acc)))))").expr);
+    ASSERT_FALSE(result.is_error, "Could not define count");
+
+    int cycles = 0;
+    for (long int i = 1; i <= 200; ++i) {
+        struct ParseResult parse_result = read_expr_from_string(gc, "(set xs (count 50 nil))");
+        ASSERT_FALSE(parse_result.is_error, "Could not parse the script");
+
+        result = eval(gc, &scope, parse_result.expr);
+        ASSERT_FALSE(result.is_error, "Could not evaluate the script");
+
+        /* Zero budget does the smallest amount of work possible, so
+         * the cycles span many evaluations */
+        const int step = gc_step(gc, 0);
+        ASSERT_TRUE(step >= 0, "GC cycle was aborted");
+        cycles += step;
+    }
+
+    ASSERT_TRUE(cycles > 0, "No GC cycle was completed");
+
+    result = eval(gc, &scope, read_expr_from_string(gc, "xs").expr);
+    ASSERT_FALSE(result.is_error, "xs was collected");
+    ASSERT_LONGINTEQ(50L, length_of_list(result.expr));
+    ASSERT_LONGINTEQ(1L, result.expr.cons->car.integer);
+
+    gc_collect(gc);
+
+    result = eval(gc, &scope, read_expr_from_string(gc, "(count 3 nil)").expr);
+    ASSERT_FALSE(result.is_error, "count was collected");
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(gc_roots_test)
+{
+    Gc *gc = create_gc();
+
+    struct Expr persistent = list(gc, 2, SYMBOL(gc, "a"), STRING(gc, "b"));
+    ASSERT_TRUE(gc_add_root(gc, &persistent) == 0, "Could not add the root");
+
+    const size_t handles = gc_handle_scope(gc);
+    struct Expr temporary = list(gc, 2, NUMBER(gc, 1), SYMBOL(gc, "c"));
+    ASSERT_TRUE(gc_push_handle(gc, temporary) == 0, "Could not push the handle");
+
+    list(gc, 3, SYMBOL(gc, "garbage"), SYMBOL(gc, "garbage"), SYMBOL(gc, "garbage"));
+
+    gc_collect(gc);
+
+    /* ASan reports use after free if any of these were collected */
+    ASSERT_TRUE(equal(persistent, list(gc, 2, SYMBOL(gc, "a"), STRING(gc, "b"))),
+                "Persistent root was collected");
+    ASSERT_TRUE(equal(temporary, list(gc, 2, NUMBER(gc, 1), SYMBOL(gc, "c"))),
+                "Handle was collected");
+
+    /* The root is a location, so its new value is protected as well */
+    persistent = list(gc, 1, temporary);
+    gc_pop_handle_scope(gc, handles);
+    gc_collect(gc);
+    ASSERT_TRUE(equal(CAR(persistent), list(gc, 2, NUMBER(gc, 1), SYMBOL(gc, "c"))),
+                "New value of the root was collected");
+
+    gc_remove_root(gc, &persistent);
+    gc_collect(gc);
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(gc_stats_test)
+{
+    Gc *gc = create_gc();
+    struct GcStats stats;
+
+    struct Expr root = list(gc, 2, SYMBOL(gc, "a"), STRING(gc, "b"));
+    ASSERT_TRUE(gc_add_root(gc, &root) == 0, "Could not add the root");
+    list(gc, 2, SYMBOL(gc, "garbage"), SYMBOL(gc, "garbage"));
+
+    /* nil and t of the Gc are counted as well */
+    gc_stats(gc, &stats);
+    ASSERT_TRUE(stats.conses == 4, "Unexpected amount of conses");
+    ASSERT_TRUE(stats.symbols == 5, "Unexpected amount of symbols");
+    ASSERT_TRUE(stats.strings == 1, "Unexpected amount of strings");
+    ASSERT_TRUE(stats.bytes_live == stats.bytes_allocated, "Nothing was collected yet");
+    const size_t bytes_allocated = stats.bytes_allocated;
+
+    gc_collect(gc);
+
+    gc_stats(gc, &stats);
+    ASSERT_TRUE(stats.conses == 2, "Unexpected amount of conses after collection");
+    ASSERT_TRUE(stats.symbols == 3, "Unexpected amount of symbols after collection");
+    ASSERT_TRUE(stats.strings == 1, "Unexpected amount of strings after collection");
+    ASSERT_TRUE(stats.bytes_live < bytes_allocated, "Live bytes did not decrease");
+    ASSERT_TRUE(stats.bytes_allocated == bytes_allocated, "Allocated bytes changed");
+    ASSERT_TRUE(stats.collections == 1, "Unexpected amount of collections");
+    ASSERT_TRUE(stats.slots == 6, "Unexpected amount of slots");
+
+    size_t pauses = 0;
+    for (size_t i = 0; i < GC_PAUSE_BUCKETS; ++i) {
+        pauses += stats.pauses[i];
+    }
+    ASSERT_TRUE(pauses == stats.steps, "Every pause should be in the histogram");
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST_SUITE(gc_suite)
+{
+    TEST_RUN(gc_step_interleaved_with_eval_test);
+    TEST_RUN(gc_roots_test);
+    TEST_RUN(gc_stats_test);
+
+    return 0;
+}
+
+#endif  // GC_SUITE_H_
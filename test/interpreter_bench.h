@@ -0,0 +1,140 @@
+#ifndef INTERPRETER_BENCH_H_
+#define INTERPRETER_BENCH_H_
+
+#include "bench.h"
+#include "ebisp/builtins.h"
+#include "ebisp/gc.h"
+#include "ebisp/interpreter.h"
+#include "ebisp/parser.h"
+#include "ebisp/scope.h"
+
+#define ASSOC_BENCH_SIZE 10000
+#define ASSOC_BENCH_LOOKUPS 1000
+
+BENCH(assoc_deep_lookup_bench)
+{
+    Gc *gc = create_gc();
+    if (gc == NULL) {
+        return -1;
+    }
+
+    /* The only match is at the very end of the alist */
+    struct Expr key = SYMBOL(gc, "needle");
+    struct Expr alist = list(gc, 1, CONS(gc, key, NIL(gc)));
+    for (long int i = 0; i < ASSOC_BENCH_SIZE; ++i) {
+        alist = CONS(gc, CONS(gc, SYMBOL(gc, "key"), NUMBER(gc, i)), alist);
+    }
+
+    size_t found = 0;
+    const int64_t begin = clock_now_ns();
+
+    for (size_t i = 0; i < ASSOC_BENCH_LOOKUPS; ++i) {
+        found += !nil_p(assoc(key, alist));
+    }
+
+    result->ns = (long int) (clock_now_ns() - begin);
+    result->ops = ASSOC_BENCH_LOOKUPS;
+
+    destroy_gc(gc);
+
+    return found == ASSOC_BENCH_LOOKUPS ? 0 : -1;
+}
+
+static struct EvalResult bench_eval_string(Gc *gc, struct Scope *scope, const char *str)
+{
+    struct ParseResult parse_result = read_expr_from_string(gc, str);
+    if (parse_result.is_error) {
+        return eval_failure(SYMBOL(gc, "parse-error"));
+    }
+
+    return eval(gc, scope, parse_result.expr);
+}
+
+BENCH(recursive_lambda_bench)
+{
+    Gc *gc = create_gc();
+    if (gc == NULL) {
+        return -1;
+    }
+
+    struct Scope scope = create_scope(gc);
+
+    struct EvalResult eval_result = bench_eval_string(
+        gc, &scope,
+        "(set fib (lambda (n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2))))))");
+    if (eval_result.is_error) {
+        destroy_gc(gc);
+        return -1;
+    }
+
+    const int64_t begin = clock_now_ns();
+    eval_result = bench_eval_string(gc, &scope, "(fib 20)");
+    result->ns = (long int) (clock_now_ns() - begin);
+    /* Amount of calls of fib */
+    result->ops = 21891;
+
+    const bool ok = !eval_result.is_error && eval_result.expr.integer == 6765;
+
+    destroy_gc(gc);
+
+    return ok ? 0 : -1;
+}
+
+#define LIST_BENCH_ITERATIONS 1000
+#define LIST_BENCH_LENGTH 100
+#define LIST_BENCH_GC_BUDGET_US 100
+
+BENCH(list_construction_under_gc_bench)
+{
+    Gc *gc = create_gc();
+    if (gc == NULL) {
+        return -1;
+    }
+
+    struct Scope scope = create_scope(gc);
+    if (gc_add_root(gc, &scope.expr) < 0) {
+        destroy_gc(gc);
+        return -1;
+    }
+
+    struct EvalResult eval_result = bench_eval_string(
+        gc, &scope,
+        "(set build (lambda (n acc) (if (= n 0) acc (build (- n 1) (cons n acc)))))");
+    if (eval_result.is_error) {
+        destroy_gc(gc);
+        return -1;
+    }
+
+    struct ParseResult parse_result = read_expr_from_string(gc, "(set xs (build 100 nil))");
+    if (parse_result.is_error || gc_push_handle(gc, parse_result.expr) < 0) {
+        destroy_gc(gc);
+        return -1;
+    }
+
+    const int64_t begin = clock_now_ns();
+
+    for (size_t i = 0; i < LIST_BENCH_ITERATIONS; ++i) {
+        eval_result = eval(gc, &scope, parse_result.expr);
+        if (eval_result.is_error || gc_step(gc, LIST_BENCH_GC_BUDGET_US) < 0) {
+            destroy_gc(gc);
+            return -1;
+        }
+    }
+
+    result->ns = (long int) (clock_now_ns() - begin);
+    result->ops = LIST_BENCH_ITERATIONS * LIST_BENCH_LENGTH;
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+BENCH_SUITE(interpreter_bench)
+{
+    BENCH_RUN(assoc_deep_lookup_bench);
+    BENCH_RUN(recursive_lambda_bench);
+    BENCH_RUN(list_construction_under_gc_bench);
+    return 0;
+}
+
+#endif  // INTERPRETER_BENCH_H_
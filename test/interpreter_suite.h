@@ -3,6 +3,10 @@
 
 #include "test.h"
 #include "ebisp/builtins.h"
+#include "ebisp/gc.h"
+#include "ebisp/interpreter.h"
+#include "ebisp/parser.h"
+#include "ebisp/scope.h"
 
 TEST(equal_test)
 {
@@ -55,10 +59,245 @@ TEST(assoc_test)
     return 0;
 }
 
+TEST(eval_deeply_nested_expr_test)
+{
+    Gc *gc = create_gc();
+    struct Scope scope = create_scope(gc);
+
+    const long int depth = 100000;
+
+    struct Expr expr = NUMBER(gc, 0);
+    for (long int i = 0; i < depth; ++i) {
+        expr = list(gc, 3, SYMBOL(gc, "+"), NUMBER(gc, 1), expr);
+    }
+
+    struct EvalResult result = eval(gc, &scope, expr);
+    ASSERT_FALSE(result.is_error, "Could not evaluate deeply nested expression");
+    ASSERT_LONGINTEQ(depth, result.expr.integer);
+
+    gc_push_handle(gc, expr);
+    gc_collect(gc);
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(eval_lambda_error_pops_scope_frame_test)
+{
+    Gc *gc = create_gc();
+    struct Scope scope = create_scope(gc);
+
+    struct Expr x = SYMBOL(gc, "x");
+    struct Expr lambda = list(gc, 3,
+                              SYMBOL(gc, "lambda"),
+                              list(gc, 1, x),
+                              list(gc, 1, SYMBOL(gc, "undefined")));
+
+    struct EvalResult result = eval(gc, &scope, list(gc, 2, lambda, NUMBER(gc, 42)));
+    ASSERT_TRUE(result.is_error, "Calling an undefined function should fail");
+    ASSERT_TRUE(nil_p(get_scope_value(&scope, x)),
+                "Frame of the lambda leaked into the scope");
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(plus_mixed_numbers_test)
+{
+    Gc *gc = create_gc();
+    struct Scope scope = create_scope(gc);
+
+    struct EvalResult result = eval(gc, &scope,
+                                    list(gc, 3,
+                                         SYMBOL(gc, "+"),
+                                         NUMBER(gc, 1),
+                                         NUMBER(gc, 2)));
+    ASSERT_FALSE(result.is_error, "Could not sum integers");
+    ASSERT_TRUE(integer_p(result.expr), "Sum of integers is not an integer");
+    ASSERT_LONGINTEQ(3L, result.expr.integer);
+
+    result = eval(gc, &scope,
+                  list(gc, 3,
+                       SYMBOL(gc, "+"),
+                       NUMBER(gc, 1),
+                       REAL(gc, 2.5)));
+    ASSERT_FALSE(result.is_error, "Could not sum integer and real");
+    ASSERT_TRUE(real_p(result.expr), "Sum of integer and real is not a real");
+    ASSERT_FLOATEQ(3.5f, (float) result.expr.real, 1e-6f);
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+static struct EvalResult eval_string(Gc *gc, struct Scope *scope, const char *str)
+{
+    struct ParseResult parse_result = read_expr_from_string(gc, str);
+    if (parse_result.is_error) {
+        return eval_failure(SYMBOL(gc, "parse-error"));
+    }
+
+    return eval(gc, scope, parse_result.expr);
+}
+
+TEST(builtins_test)
+{
+    Gc *gc = create_gc();
+    struct Scope scope = create_scope(gc);
+
+    struct EvalResult result = eval_string(gc, &scope, "(- (* 2 3 4) (/ 10 2) 1)");
+    ASSERT_FALSE(result.is_error, "Could not evaluate arithmetic");
+    ASSERT_LONGINTEQ(18L, result.expr.integer);
+
+    result = eval_string(gc, &scope, "(if (< 1 2 3) (car (list 1 2)) 0)");
+    ASSERT_FALSE(result.is_error, "Could not evaluate if");
+    ASSERT_LONGINTEQ(1L, result.expr.integer);
+
+    result = eval_string(gc, &scope, "(if (> 1 2) 0)");
+    ASSERT_FALSE(result.is_error, "Could not evaluate if without else");
+    ASSERT_TRUE(nil_p(result.expr), "If without else should return nil");
+
+    result = eval_string(gc, &scope, "(let ((x 1) (y 2) z) (set x (+ x y)) x)");
+    ASSERT_FALSE(result.is_error, "Could not evaluate let");
+    ASSERT_LONGINTEQ(3L, result.expr.integer);
+    ASSERT_TRUE(nil_p(get_scope_value(&scope, SYMBOL(gc, "x"))),
+                "Frame of the let leaked into the scope");
+
+    result = eval_string(gc, &scope, "(progn)");
+    ASSERT_FALSE(result.is_error, "Could not evaluate empty progn");
+    ASSERT_TRUE(nil_p(result.expr), "Empty progn should return nil");
+
+    result = eval_string(gc, &scope, "(car 1 2)");
+    ASSERT_TRUE(result.is_error, "Wrong number of arguments was not reported");
+
+    result = eval_string(gc, &scope, "(/ 1 0)");
+    ASSERT_TRUE(result.is_error, "Division by zero was not reported");
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(tail_call_loop_test)
+{
+    Gc *gc = create_gc();
+    struct Scope scope = create_scope(gc);
+
+    struct EvalResult result = eval_string(
+        gc, &scope,
+        "(set loop (lambda (n acc)"
+        "            (if (= n 0) acc"
+        "              (let ((m (- n 1)))"
+        "                (loop m (+ acc 1))))))");
+    ASSERT_FALSE(result.is_error, "Could not define loop");
+
+    result = eval_string(gc, &scope, "(loop 100000 0)");
+    ASSERT_FALSE(result.is_error, "Could not evaluate tail recursive loop");
+    ASSERT_LONGINTEQ(100000L, result.expr.integer);
+    ASSERT_TRUE(cons_p(scope.expr) && nil_p(scope.expr.cons->cdr),
+                "Frames of the loop leaked into the scope");
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(closure_captures_scope_test)
+{
+    Gc *gc = create_gc();
+    struct Scope scope = create_scope(gc);
+
+    struct EvalResult result = eval_string(
+        gc, &scope,
+        "(set make-adder (lambda (x) (lambda (y) (+ x y))))");
+    ASSERT_FALSE(result.is_error, "Could not define make-adder");
+
+    result = eval_string(gc, &scope, "(set add10 (make-adder 10))");
+    ASSERT_FALSE(result.is_error, "Could not create a closure");
+
+    result = eval_string(gc, &scope, "(let ((x 1)) (add10 5))");
+    ASSERT_FALSE(result.is_error, "Could not call the closure");
+    ASSERT_LONGINTEQ(15L, result.expr.integer);
+
+    /* Variables of the caller are not visible to the callee */
+    result = eval_string(
+        gc, &scope,
+        "(set get-z (lambda () z))");
+    ASSERT_FALSE(result.is_error, "Could not define get-z");
+    result = eval_string(gc, &scope, "(let ((z 1)) (get-z))");
+    ASSERT_TRUE(result.is_error, "z should not be visible to get-z");
+
+    /* The closure sees the bindings updated after it was created */
+    result = eval_string(
+        gc, &scope,
+        "(let ((n 0))"
+        "  (set counter (lambda () (set n (+ n 1)))))");
+    ASSERT_FALSE(result.is_error, "Could not define counter");
+    eval_string(gc, &scope, "(counter)");
+    result = eval_string(gc, &scope, "(counter)");
+    ASSERT_FALSE(result.is_error, "Could not call counter");
+    ASSERT_LONGINTEQ(2L, result.expr.integer);
+
+    result = eval_string(gc, &scope, "(add10 1 2)");
+    ASSERT_TRUE(result.is_error, "Wrong amount of arguments was accepted");
+    ASSERT_TRUE(cons_p(scope.expr) && nil_p(scope.expr.cons->cdr),
+                "Frames of the closures leaked into the scope");
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(eval_budget_test)
+{
+    Gc *gc = create_gc();
+    struct Scope scope = create_scope(gc);
+
+    struct EvalResult result = eval_string(
+        gc, &scope,
+        "(set forever (lambda (acc) (forever (cons 1 acc))))");
+    ASSERT_FALSE(result.is_error, "Could not define forever");
+
+    struct ParseResult parse_result = read_expr_from_string(gc, "(forever nil)");
+    ASSERT_FALSE(parse_result.is_error, "Could not parse the call");
+
+    const struct EvalBudget steps_budget = { .max_steps = 1000 };
+    struct EvalUsage usage;
+    result = eval_with_budget(gc, &scope, parse_result.expr, &steps_budget, &usage);
+    ASSERT_TRUE(result.is_error, "Infinite loop did not exceed the budget");
+    ASSERT_TRUE(equal(result.expr.cons->cdr.cons->car, SYMBOL(gc, "steps")),
+                "Wrong budget was exceeded");
+    ASSERT_LONGINTEQ(1001L, usage.steps);
+
+    const struct EvalBudget allocations_budget = { .max_allocations = 1000 };
+    result = eval_with_budget(gc, &scope, parse_result.expr, &allocations_budget, &usage);
+    ASSERT_TRUE(result.is_error, "Infinite consing did not exceed the budget");
+    ASSERT_TRUE(equal(result.expr.cons->cdr.cons->car, SYMBOL(gc, "allocations")),
+                "Wrong budget was exceeded");
+    ASSERT_TRUE(cons_p(scope.expr) && nil_p(scope.expr.cons->cdr),
+                "Frames of the loop leaked into the scope");
+
+    result = eval_string(gc, &scope, "(+ 1 2)");
+    ASSERT_FALSE(result.is_error, "Unlimited evaluation failed");
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
 TEST_SUITE(interpreter_suite)
 {
     TEST_RUN(equal_test);
     TEST_RUN(assoc_test);
+    TEST_RUN(eval_deeply_nested_expr_test);
+    TEST_RUN(eval_lambda_error_pops_scope_frame_test);
+    TEST_RUN(plus_mixed_numbers_test);
+    TEST_RUN(builtins_test);
+    TEST_RUN(tail_call_loop_test);
+    TEST_RUN(closure_captures_scope_test);
+    TEST_RUN(eval_budget_test);
 
     return 0;
 }
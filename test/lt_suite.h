@@ -0,0 +1,118 @@
+#ifndef LT_SUITE_H_
+#define LT_SUITE_H_
+
+#include "test.h"
+#include "system/lt.h"
+
+#define LT_TEST_RESOURCES 100
+
+static int lt_test_destroyed[LT_TEST_RESOURCES * 2];
+static size_t lt_test_destroyed_count = 0;
+
+static void lt_test_destroy(void *resource)
+{
+    lt_test_destroyed[lt_test_destroyed_count++] = *(int*) resource;
+}
+
+TEST(lt_destroys_in_reverse_order_test)
+{
+    int resources[LT_TEST_RESOURCES];
+    lt_test_destroyed_count = 0;
+
+    Lt *lt = create_lt();
+    for (int i = 0; i < LT_TEST_RESOURCES; ++i) {
+        resources[i] = i;
+        ASSERT_TRUE(PUSH_LT(lt, &resources[i], lt_test_destroy) == &resources[i],
+                    "Push did not return the resource");
+    }
+    destroy_lt(lt);
+
+    ASSERT_INTEQ(LT_TEST_RESOURCES, (int) lt_test_destroyed_count);
+    for (int i = 0; i < LT_TEST_RESOURCES; ++i) {
+        ASSERT_INTEQ(LT_TEST_RESOURCES - 1 - i, lt_test_destroyed[i]);
+    }
+
+    return 0;
+}
+
+TEST(lt_release_replace_reset_test)
+{
+    int resources[LT_TEST_RESOURCES];
+    int replacements[LT_TEST_RESOURCES];
+    lt_test_destroyed_count = 0;
+
+    Lt *lt = create_lt();
+    for (int i = 0; i < LT_TEST_RESOURCES; ++i) {
+        resources[i] = i;
+        replacements[i] = LT_TEST_RESOURCES + i;
+        PUSH_LT(lt, &resources[i], lt_test_destroy);
+    }
+
+    /* Goes through the index since the LT is big enough */
+    for (int i = 0; i < LT_TEST_RESOURCES; i += 3) {
+        ASSERT_TRUE(RELEASE_LT(lt, &resources[i]) == &resources[i],
+                    "Release did not return the resource");
+    }
+    for (int i = 1; i < LT_TEST_RESOURCES; i += 3) {
+        REPLACE_LT(lt, &resources[i], &replacements[i]);
+    }
+    for (int i = 2; i < LT_TEST_RESOURCES; i += 3) {
+        RESET_LT(lt, &resources[i], &replacements[i]);
+    }
+
+    /* Replacing what was released is a no-op */
+    ASSERT_TRUE(REPLACE_LT(lt, &resources[0], &replacements[0]) == &resources[0],
+                "Released resource was found");
+
+    ASSERT_INTEQ(LT_TEST_RESOURCES / 3, (int) lt_test_destroyed_count);
+    for (size_t i = 0; i < lt_test_destroyed_count; ++i) {
+        ASSERT_INTEQ(2 + 3 * (int) i, lt_test_destroyed[i]);
+    }
+
+    lt_test_destroyed_count = 0;
+    destroy_lt(lt);
+
+    int expected = LT_TEST_RESOURCES - 1;
+    for (size_t i = 0; i < lt_test_destroyed_count; ++i, --expected) {
+        if (expected % 3 == 0) {
+            --expected;
+        }
+        ASSERT_INTEQ(LT_TEST_RESOURCES + expected, lt_test_destroyed[i]);
+    }
+
+    return 0;
+}
+
+TEST(lt_frame_test)
+{
+    int a = 1, b = 2, c = 3;
+    Lt_frame frame;
+    lt_test_destroyed_count = 0;
+
+    Lt *lt = create_lt();
+    PUSH_LT_FRAME(lt, &a, lt_test_destroy, &frame);
+    ASSERT_TRUE(RESET_LT_FRAME(lt, frame, &b) == &b, "Reset did not return the new resource");
+    ASSERT_INTEQ(1, (int) lt_test_destroyed_count);
+    ASSERT_INTEQ(1, lt_test_destroyed[0]);
+
+    REPLACE_LT_FRAME(lt, frame, &c);
+    ASSERT_INTEQ(1, (int) lt_test_destroyed_count);
+
+    /* The frame handle and the lookup agree */
+    ASSERT_TRUE(RELEASE_LT(lt, &c) == &c, "Release did not return the resource");
+    destroy_lt(lt);
+    ASSERT_INTEQ(1, (int) lt_test_destroyed_count);
+
+    return 0;
+}
+
+TEST_SUITE(lt_suite)
+{
+    TEST_RUN(lt_destroys_in_reverse_order_test);
+    TEST_RUN(lt_release_replace_reset_test);
+    TEST_RUN(lt_frame_test);
+
+    return 0;
+}
+
+#endif  // LT_SUITE_H_
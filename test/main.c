@@ -1,17 +1,25 @@
 #include "test.h"
 #include "tokenizer_suite.h"
 #include "parser_suite.h"
+#include "expr_suite.h"
 #include "interpreter_suite.h"
+#include "gc_suite.h"
 #include "scope_suite.h"
 #include "builtins_suite.h"
+#include "dump_suite.h"
+#include "lt_suite.h"
 
 TEST_MAIN()
 {
     TEST_RUN(tokenizer_suite);
     TEST_RUN(parser_suite);
+    TEST_RUN(expr_suite);
     TEST_RUN(interpreter_suite);
+    TEST_RUN(gc_suite);
     TEST_RUN(scope_suite);
     TEST_RUN(builtins_suite);
+    TEST_RUN(dump_suite);
+    TEST_RUN(lt_suite);
 
     return 0;
 }
@@ -0,0 +1,56 @@
+#ifndef PARSER_BENCH_H_
+#define PARSER_BENCH_H_
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tokenizer_bench.h"
+#include "ebisp/gc.h"
+#include "ebisp/parser.h"
+
+BENCH(parser_throughput_bench)
+{
+    size_t n = 0;
+    char *source = script_bench_source(&n);
+    if (source == NULL) {
+        return -1;
+    }
+
+    Gc *gc = create_gc();
+    if (gc == NULL) {
+        free(source);
+        return -1;
+    }
+
+    size_t forms = 0;
+    const char *cursor = source;
+    const int64_t begin = clock_now_ns();
+
+    while (*next_token(cursor).begin != 0) {
+        struct ParseResult parse_result = read_expr_from_string(gc, cursor);
+        if (parse_result.is_error) {
+            break;
+        }
+
+        forms++;
+        cursor = parse_result.end;
+    }
+
+    result->ns = (long int) (clock_now_ns() - begin);
+    result->ops = forms;
+    result->bytes = strlen(source);
+
+    destroy_gc(gc);
+    free(source);
+
+    return forms == n * 2 ? 0 : -1;
+}
+
+BENCH_SUITE(parser_bench)
+{
+    BENCH_RUN(parser_throughput_bench);
+    return 0;
+}
+
+#endif  // PARSER_BENCH_H_
@@ -1,7 +1,11 @@
 #ifndef PARSER_SUITE_H_
 #define PARSER_SUITE_H_
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "test.h"
+#include "ebisp/builtins.h"
 #include "ebisp/parser.h"
 #include "ebisp/gc.h"
 
@@ -19,30 +23,53 @@ TEST(read_expr_from_file_test)
     ASSERT_INTEQ(EXPR_CONS, expr.type);
     ASSERT_INTEQ(EXPR_ATOM, expr.cons->car.type);
     ASSERT_INTEQ(ATOM_SYMBOL, expr.cons->car.atom->type);
-    ASSERT_STREQ("+", expr.cons->car.atom->sym);
+    ASSERT_TRUE(atom_text_equal(expr.cons->car.atom, "+"), "Expected + symbol");
 
     expr = expr.cons->cdr;
     ASSERT_INTEQ(EXPR_CONS, expr.type);
-    ASSERT_INTEQ(EXPR_ATOM, expr.cons->car.type);
-    ASSERT_INTEQ(ATOM_NUMBER, expr.cons->car.atom->type);
-    ASSERT_LONGINTEQ(1L, expr.cons->car.atom->num);
+    ASSERT_INTEQ(EXPR_INTEGER, expr.cons->car.type);
+    ASSERT_LONGINTEQ(1L, expr.cons->car.integer);
 
     expr = expr.cons->cdr;
     ASSERT_INTEQ(EXPR_CONS, expr.type);
-    ASSERT_INTEQ(EXPR_ATOM, expr.cons->car.type);
-    ASSERT_INTEQ(ATOM_NUMBER, expr.cons->car.atom->type);
-    ASSERT_LONGINTEQ(2L, expr.cons->car.atom->num);
+    ASSERT_INTEQ(EXPR_INTEGER, expr.cons->car.type);
+    ASSERT_LONGINTEQ(2L, expr.cons->car.integer);
 
     expr = expr.cons->cdr;
     ASSERT_INTEQ(EXPR_CONS, expr.type);
-    ASSERT_INTEQ(EXPR_ATOM, expr.cons->car.type);
-    ASSERT_INTEQ(ATOM_NUMBER, expr.cons->car.atom->type);
-    ASSERT_LONGINTEQ(3L, expr.cons->car.atom->num);
+    ASSERT_INTEQ(EXPR_INTEGER, expr.cons->car.type);
+    ASSERT_LONGINTEQ(3L, expr.cons->car.integer);
 
     expr = expr.cons->cdr;
     ASSERT_INTEQ(EXPR_ATOM, expr.type);
     ASSERT_INTEQ(ATOM_SYMBOL, expr.atom->type);
-    ASSERT_STREQ("nil", expr.atom->sym);
+    ASSERT_TRUE(atom_text_equal(expr.atom, "nil"), "Expected nil symbol");
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(read_all_exprs_from_file_test)
+{
+    Gc *gc = create_gc();
+
+    struct ParseResult result = read_all_exprs_from_file(gc, "test-data/multiple-forms.lisp");
+    ASSERT_TRUE(!result.is_error, result.error_message);
+    ASSERT_LONGINTEQ(3L, length_of_list(result.expr));
+
+    struct Expr set_form = result.expr.cons->car;
+    ASSERT_INTEQ(EXPR_CONS, set_form.type);
+    struct Expr hello = set_form.cons->cdr.cons->cdr.cons->car;
+    ASSERT_INTEQ(EXPR_ATOM, hello.type);
+    ASSERT_INTEQ(ATOM_STRING, hello.atom->type);
+    ASSERT_TRUE(atom_text_equal(hello.atom, "hello"), "Expected \"hello\" string");
+    ASSERT_TRUE(hello.atom->owned == NULL, "String was copied out of the source");
+
+    struct Expr foo = result.expr.cons->cdr.cons->cdr.cons->car;
+    ASSERT_INTEQ(EXPR_ATOM, foo.type);
+    ASSERT_TRUE(atom_text_equal(foo.atom, "foo"), "Expected foo symbol");
+    ASSERT_TRUE(equal(foo, SYMBOL(gc, "foo")), "Slice symbol is not equal to copied one");
 
     destroy_gc(gc);
 
@@ -55,9 +82,72 @@ TEST(parse_negative_numbers_test)
     struct ParseResult result = read_expr_from_string(gc, "-12345");
 
     ASSERT_FALSE(result.is_error, "Parsing failed");
-    ASSERT_TRUE(result.expr.type == EXPR_ATOM, "Parsed expression is not an atom");
-    ASSERT_TRUE(result.expr.atom->type == ATOM_NUMBER, "Parsed expression is not a number");
-    ASSERT_LONGINTEQ(-12345L, result.expr.atom->num);
+    ASSERT_TRUE(result.expr.type == EXPR_INTEGER, "Parsed expression is not an integer");
+    ASSERT_LONGINTEQ(-12345L, result.expr.integer);
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+TEST(parse_real_numbers_test)
+{
+    Gc *gc = create_gc();
+    struct ParseResult result = read_expr_from_string(gc, "(-1.5 2.25)");
+
+    ASSERT_FALSE(result.is_error, "Parsing failed");
+    ASSERT_TRUE(result.expr.type == EXPR_CONS, "Parsed expression is not a list");
+
+    struct Expr x = result.expr.cons->car;
+    ASSERT_TRUE(x.type == EXPR_REAL, "Parsed expression is not a real");
+    ASSERT_FLOATEQ(-1.5f, (float) x.real, 1e-6f);
+
+    struct Expr y = result.expr.cons->cdr.cons->car;
+    ASSERT_TRUE(y.type == EXPR_REAL, "Parsed expression is not a real");
+    ASSERT_FLOATEQ(2.25f, (float) y.real, 1e-6f);
+
+    destroy_gc(gc);
+
+    return 0;
+}
+
+static char *nested_source(size_t depth, char open, const char *atom, char close)
+{
+    const size_t atom_len = strlen(atom);
+    char *source = malloc(depth * 2 + atom_len + 1);
+    if (source == NULL) {
+        return NULL;
+    }
+
+    memset(source, open, depth);
+    memcpy(source + depth, atom, atom_len);
+    memset(source + depth + atom_len, close, close ? depth : 0);
+    source[depth + atom_len + (close ? depth : 0)] = '\0';
+
+    return source;
+}
+
+TEST(parse_deeply_nested_test)
+{
+    Gc *gc = create_gc();
+
+    char *source = nested_source(1000, '(', "x", ')');
+    ASSERT_TRUE(source != NULL, "Could not allocate the source");
+    struct ParseResult result = read_expr_from_string(gc, source);
+    ASSERT_FALSE(result.is_error, "Parsing of a reasonably nested list failed");
+    free(source);
+
+    source = nested_source(300000, '(', "x", ')');
+    ASSERT_TRUE(source != NULL, "Could not allocate the source");
+    result = read_all_exprs_from_string(gc, source);
+    ASSERT_TRUE(result.is_error, "Too deeply nested list was parsed");
+    free(source);
+
+    source = nested_source(300000, '\'', "x", 0);
+    ASSERT_TRUE(source != NULL, "Could not allocate the source");
+    result = read_expr_from_string(gc, source);
+    ASSERT_TRUE(result.is_error, "Too deeply nested quote was parsed");
+    free(source);
 
     destroy_gc(gc);
 
@@ -67,7 +157,10 @@ TEST(parse_negative_numbers_test)
 TEST_SUITE(parser_suite)
 {
     TEST_RUN(read_expr_from_file_test);
+    TEST_RUN(read_all_exprs_from_file_test);
     TEST_RUN(parse_negative_numbers_test);
+    TEST_RUN(parse_real_numbers_test);
+    TEST_RUN(parse_deeply_nested_test);
 
     return 0;
 }
@@ -0,0 +1,73 @@
+#ifndef TOKENIZER_BENCH_H_
+#define TOKENIZER_BENCH_H_
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "ebisp/tokenizer.h"
+
+#define SCRIPT_BENCH_SIZE (8 * 1024 * 1024)
+
+static const char script_bench_chunk[] =
+    ";; Moves the platform back and forth\n"
+    "(set move-platform\n"
+    "  (lambda (id dx)\n"
+    "    (rect-apply-force id (cons (* dx 1000.5) -42))))\n"
+    "(move-platform \"platform-1\" 10)   ; call it\n";
+
+#define SCRIPT_BENCH_CHUNK_TOKENS 29
+
+/* Returns a malloc'd script of about SCRIPT_BENCH_SIZE bytes made of
+ * script_bench_chunk repeated n times */
+static char *script_bench_source(size_t *n)
+{
+    const size_t chunk_size = sizeof(script_bench_chunk) - 1;
+    *n = SCRIPT_BENCH_SIZE / chunk_size;
+
+    char *source = malloc(*n * chunk_size + 1);
+    if (source == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < *n; ++i) {
+        memcpy(source + i * chunk_size, script_bench_chunk, chunk_size);
+    }
+    source[*n * chunk_size] = 0;
+
+    return source;
+}
+
+BENCH(tokenizer_throughput_bench)
+{
+    size_t n = 0;
+    char *source = script_bench_source(&n);
+    if (source == NULL) {
+        return -1;
+    }
+
+    size_t tokens = 0;
+    const int64_t begin = clock_now_ns();
+
+    for (struct Token token = next_token(source);
+         *token.begin != 0;
+         token = next_token(token.end)) {
+        tokens++;
+    }
+
+    result->ns = (long int) (clock_now_ns() - begin);
+    result->ops = tokens;
+    result->bytes = strlen(source);
+
+    free(source);
+
+    return tokens == n * SCRIPT_BENCH_CHUNK_TOKENS ? 0 : -1;
+}
+
+BENCH_SUITE(tokenizer_bench)
+{
+    BENCH_RUN(tokenizer_throughput_bench);
+    return 0;
+}
+
+#endif  // TOKENIZER_BENCH_H_
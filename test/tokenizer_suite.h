@@ -48,10 +48,32 @@ TEST(tokenizer_string_list_test)
     return 0;
 }
 
+TEST(tokenizer_comments_test)
+{
+    struct Token token = next_token("; comment\n  foo.bar-1 ;; trailing comment");
+    ASSERT_STREQN("foo", token.begin, (size_t) (token.end - token.begin));
+
+    token = next_token(token.end);
+    ASSERT_STREQN(".", token.begin, (size_t) (token.end - token.begin));
+
+    token = next_token(token.end);
+    ASSERT_STREQN("bar-1", token.begin, (size_t) (token.end - token.begin));
+
+    token = next_token(token.end);
+    ASSERT_TRUE(*token.begin == 0 && token.begin == token.end,
+                "Expected the end of the input after the trailing comment");
+
+    token = next_token("-12.5e3)");
+    ASSERT_STREQN("-12.5e3", token.begin, (size_t) (token.end - token.begin));
+
+    return 0;
+}
+
 TEST_SUITE(tokenizer_suite)
 {
     TEST_RUN(tokenizer_number_list_test);
     TEST_RUN(tokenizer_string_list_test);
+    TEST_RUN(tokenizer_comments_test);
     return 0;
 }
 